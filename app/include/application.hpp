@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include "../../include/structs/default.h"
+#include "../../include/structs/progress.h"
 #include "legacy.h"
 
 class Application {
@@ -54,6 +55,8 @@ private:
 
 	const std::string back = "Back";
 
+	const std::string pathPrompt = "Enter a path, or nothing to keep ";
+
 
 	enum class MainMenuOption {
 		Start,
@@ -92,7 +95,9 @@ private:
 	bool   	  mappingStrategy = MAPPING_STRATEGY == 1 ? true : false;
 	bool 	  tracefile       = false;
 	bool	  debugMode = false;
-	const char* tracefileName = "tracefile"; 
+	std::string inputFile = "../../requests.csv";
+	std::string tracefileName = "tracefile";
+	const std::string simulatorPath = "../../project";
 
 	MainMenuOption currentMOption;
 	ConfigOption currentCOption;
@@ -104,6 +109,8 @@ private:
 	void incrementConfigOptionValue(ConfigOption option);
 	void decrementConfigOptionValue(ConfigOption option);
 	void runCacheSimulation();
+	void printDashboard(const ProgressRecord& record);
+	std::string readPath(const std::string& label, const std::string& current);
 
 
 	template <typename OptionEnum>
@@ -3,6 +3,8 @@
 #include <termios.h>
 #include <unistd.h>
 #include <cstdio>
+#include <cerrno>
+#include <cstdlib>
 #include <sys/wait.h>
 #include "application.hpp"
 
@@ -38,8 +40,8 @@ void Application::printMenu()
 	}
 	else // Configure 
 	{
-		std::cout << "\t\t\t" << (currentCOption == ConfigOption::Input ? cursor : " ") << inputConf << "requests.csv" << "\n";
-		std::cout << "\t\t\t" << (currentCOption == ConfigOption::Tracefile ? cursor : " ") << tracefileConf << (tracefile ? "tracefile.tf" : " ") << "\n";
+		std::cout << "\t\t\t" << (currentCOption == ConfigOption::Input ? cursor : " ") << inputConf << inputFile << "\n";
+		std::cout << "\t\t\t" << (currentCOption == ConfigOption::Tracefile ? cursor : " ") << tracefileConf << (tracefile ? tracefileName : " ") << "\n";
 		std::cout << "\t\t\t" << (currentCOption == ConfigOption::Cycles ? cursor : " ") << cyclesConf << cycles << "\n";
 		std::cout << "\t\t\t" << (currentCOption == ConfigOption::NumberCacheLevels ? cursor : " ") << numCacheLevelsConf << static_cast<uint32_t>(numCacheLevels) << "\n";
 		std::cout << "\t\t\t" << (currentCOption == ConfigOption::CacheLineSize ? cursor : " ") << cacheLineSizeConf << cachelineSize << "\n";
@@ -74,9 +76,18 @@ void Application::enterOption()
 	}
 	else {
 		switch(currentCOption){
+			case ConfigOption::Input:
+				inputFile = readPath(inputConf, inputFile);
+				break;
+			case ConfigOption::Tracefile:
+				tracefileName = readPath(tracefileConf, tracefileName);
+				tracefile = true;
+				break;
 			case ConfigOption::Back:
 				isMainMenu = true;
 				break;
+			default:
+				break;
 		}
 	}
 }
@@ -119,12 +130,106 @@ void Application::decrementConfigOptionValue(ConfigOption option)
     }
 }
 
+// Reads one whole record from the progress pipe. Returns false once the simulator closed it
+static bool readProgressRecord(int fd, ProgressRecord& record)
+{
+	char* bytes = reinterpret_cast<char*>(&record);
+	size_t done = 0;
+	while (done < sizeof(record)) {
+		ssize_t n = read(fd, bytes + done, sizeof(record) - done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		done += n;
+	}
+	return true;
+}
+
+std::string Application::readPath(const std::string& label, const std::string& current)
+{
+	std::cout << "\t\t\t" << label << current << "\n\t\t\t" << pathPrompt << current << ": ";
+	std::string path;
+	std::getline(std::cin, path);
+	return path.empty() ? current : path;
+}
+
+void Application::printDashboard(const ProgressRecord& record)
+{
+	const double seconds = record.elapsedSeconds > 0 ? record.elapsedSeconds : 1e-9;
+	const double requestsPerSecond = record.requests / seconds;
+	const double cyclesPerSecond = record.cycles / seconds;
+
+	// The run ends with the last request or at the cycle limit, whichever comes first.
+	// Streamed inputs don't know their last request, then only the cycle limit bounds the run
+	double eta = -1.0;
+	if (record.total > record.requests && requestsPerSecond > 0)
+		eta = (record.total - record.requests) / requestsPerSecond;
+	if (record.cycleLimit > record.cycles && cyclesPerSecond > 0) {
+		const double cycleEta = (record.cycleLimit - record.cycles) / cyclesPerSecond;
+		if (eta < 0 || cycleEta < eta)
+			eta = cycleEta;
+	}
+
+	// Move to the top left and clear, a full "clear" per refresh flickers
+	printf("\033[H\033[J");
+	std::cout << title << "\n";
+	printf("\t\t\tSimulation %s: %s\n\n", record.finished ? "finished" : "running", inputFile.c_str());
+
+	if (record.total > 0)
+		printf("\t\t\tRequests:      %llu / %llu (%.1f%%)\n", (unsigned long long) record.requests,
+			(unsigned long long) record.total, 100.0 * record.requests / record.total);
+	else
+		printf("\t\t\tRequests:      %llu\n", (unsigned long long) record.requests);
+	printf("\t\t\tRequests/s:    %.0f\n", requestsPerSecond);
+	printf("\t\t\tCycles:        %llu / %llu\n", (unsigned long long) record.cycles, (unsigned long long) record.cycleLimit);
+	printf("\t\t\tElapsed:       %.1f s\n", record.elapsedSeconds);
+	if (record.finished)
+		printf("\t\t\tETA:           done\n");
+	else if (eta >= 0)
+		printf("\t\t\tETA:           %.1f s%s\n", eta, record.total == 0 ? " (cycle limit)" : "");
+	else
+		printf("\t\t\tETA:           unknown\n");
+	printf("\n");
+
+	// A level sees the requests that all levels above it missed
+	uint64_t reaching = record.requests;
+	for (uint32_t level = 1; level <= record.numLevels; level++) {
+		printf("\t\t\tL%u hit rate:   %6.2f%% of %llu\n", level, reaching ? 100.0 * record.served[level] / reaching : 0.0,
+			(unsigned long long) reaching);
+		reaching -= record.served[level];
+	}
+	printf("\t\t\tMain memory:   %llu requests\n", (unsigned long long) record.served[0]);
+	fflush(stdout);
+}
+
 void Application::runCacheSimulation()
 {
+	// The simulator reports its progress through a pipe, its report goes to a log that is shown after the run
+	int progressPipe[2];
+	if (pipe(progressPipe) == -1) {
+		perror("pipe failed");
+		return;
+	}
+
+	char logName[] = "/tmp/cache_simulation_XXXXXX";
+	int logFd = mkstemp(logName);
+	if (logFd == -1) {
+		perror("mkstemp failed");
+		close(progressPipe[0]);
+		close(progressPipe[1]);
+		return;
+	}
+
 	pid_t pid = fork();
 
     if (pid == 0) {
         // Child process
+		close(progressPipe[0]);
+		dup2(logFd, STDOUT_FILENO);
+		dup2(logFd, STDERR_FILENO);
+		close(logFd);
+
 		// Allocate all strings first
 		char* cycles_str = uint32_to_string(cycles);
 		char* cachelineSize_str = uint32_to_string(cachelineSize);
@@ -136,9 +241,10 @@ void Application::runCacheSimulation()
 		char* latencyCacheL3_str = uint32_to_string(latencyCacheL3);
 		char* numCacheLevels_str = uint8_to_string(numCacheLevels);
 		char* mappingStrategy_str = uint8_to_string(mappingStrategy);
+		char* progressFd_str = uint32_to_string(progressPipe[1]);
 
         std::vector<char*> args;
-		args.push_back((char*)"../../project");
+		args.push_back((char*)simulatorPath.c_str());
 
 		if (debugMode)
 		    args.push_back((char*)"-d");
@@ -148,7 +254,7 @@ void Application::runCacheSimulation()
 
 		if (tracefile){
 			args.push_back((char*)"-f");
-			args.push_back((char*)(tracefileName));
+			args.push_back((char*)tracefileName.c_str());
 		}
 
 		args.push_back((char*)"-C");
@@ -178,7 +284,10 @@ void Application::runCacheSimulation()
 		args.push_back((char*)"-S");
 		args.push_back(mappingStrategy_str);
 
-		args.push_back((char*)"../../requests.csv");
+		args.push_back((char*)"--progress-fd");
+		args.push_back(progressFd_str);
+
+		args.push_back((char*)inputFile.c_str());
 
 		args.push_back(NULL);
 
@@ -195,20 +304,41 @@ void Application::runCacheSimulation()
 		free(latencyCacheL3_str);
 		free(numCacheLevels_str);
 		free(mappingStrategy_str);
+		free(progressFd_str);
 
         exit(1);
     } else if (pid > 0) {
-        // Parent process
+        // Parent process. The pipe ends when the simulator exits
+		close(progressPipe[1]);
+		ProgressRecord record;
+		while (readProgressRecord(progressPipe[0], record))
+			printDashboard(record);
+		close(progressPipe[0]);
+
         int status;
 		waitpid(pid, &status, 0);
+
+		// The report of the simulator, or why it didn't start
+		std::cout << "\n";
+		char buffer[4096];
+		ssize_t n;
+		lseek(logFd, 0, SEEK_SET);
+		while ((n = read(logFd, buffer, sizeof(buffer))) > 0)
+			fwrite(buffer, 1, n, stdout);
+		fflush(stdout);
+
         std::cout << "\nSimulation finished. Press ENTER to return to the menu...";
         std::cin.ignore(); // Wait for ENTER
         std::cin.get();   
         system("clear");  
     } else {
         perror("fork failed");
+		close(progressPipe[0]);
+		close(progressPipe[1]);
     }
 
+	close(logFd);
+	unlink(logName);
 }
 
 template <typename OptionEnum>
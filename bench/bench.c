@@ -0,0 +1,418 @@
+#include <getopt.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <sysexits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/structs/debug.h"
+#include "../include/structs/test.h"
+#include "../include/simulation.hpp"
+#include "../include/parsers/csv_parser.h"
+#include "../include/parsers/numeric_parser.h"
+#include "../util/helper_functions.h"
+
+/* Flags expected by the simulation. Benchmarks always run without debug output and without checking read data */
+bool debug = false;
+bool test  = false;
+
+#define DEFAULT_BASELINE      "bench/baseline.txt"
+#define DEFAULT_THRESHOLD     15
+#define DEFAULT_RSS_THRESHOLD 25
+#define DEFAULT_REPEAT        3
+#define GENERATED_REQUESTS    100000
+#define MAX_WORKLOADS         32
+
+/* A canonical workload: either a CSV trace or a generated trace, simulated with a fixed configuration */
+typedef struct {
+    const char*          name;
+    const char*          file;        /* CSV trace, NULL if the trace is generated */
+    const char*      workload;        /* Synthetic workload of workload.hpp, NULL if the trace is read from file */
+    uint32_t             size;        /* Workload size, see WorkloadOptions */
+    uint8_t   mappingStrategy;        /* The rest of the configuration are the defaults of default.h */
+} Workload;
+
+/* Measurement of one workload. Sent from the child process to the parent through a pipe */
+typedef struct {
+    int                    ok;
+    uint32_t         requests;
+    uint64_t           cycles;
+    double            seconds;        /* Host time spent in run_simulation */
+    long           maxRssKiB;         /* Peak resident set size of the whole child process */
+} Sample;
+
+/* Metrics derived from the best sample, the same format is stored in the baseline */
+typedef struct {
+    char             name[64];
+    double  requestsPerSecond;
+    double     nsPerCycle;
+    long        maxRssKiB;
+} Metrics;
+
+/* Generated workloads issue GENERATED_REQUESTS requests with the default seed */
+static const Workload workloads[] = {
+    { "matmul-dm",         "requests.csv",             NULL,            0,       0 },
+    { "matmul-fa",         "requests.csv",             NULL,            0,       1 },
+    { "memory-requests",   "test/memory_requests.csv", NULL,            0,       0 },
+    { "stream-dm",         NULL,                       "copy",          1 << 20, 0 },
+    { "strided-dm",        NULL,                       "strided",       1 << 24, 0 },
+    { "random-dm",         NULL,                       "random",        1 << 22, 0 },
+    { "random-fa",         NULL,                       "random",        1 << 22, 1 },
+    { "zipf-fa",           NULL,                       "zipf",          1 << 22, 1 },
+};
+
+#define NUM_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+/*
+   * @brief         Loads the requests of a workload from its CSV file
+   *
+   * @param w       Workload to load
+   * @param size    Pointer, where the number of requests should be saved
+   *
+   * @return        - Allocated requests, which have to be freed by the caller
+   *                - NULL if the trace could not be read or parsed
+*/
+static Request* load_trace(const Workload* w, uint32_t* size) {
+
+    char* content = read_file_to_buffer(w->file);
+    if (!content) return NULL;
+
+    /* The parser rejects empty lines, so a trailing newline at the end of the trace is dropped */
+    size_t len = strlen(content);
+    while (len > 0 && (content[len - 1] == '\n' || content[len - 1] == '\r')) {
+        content[--len] = '\0';
+    }
+
+    *size = count_requests(content);
+    Request* requests = (Request*) calloc(*size, sizeof(Request));
+    if (!requests || form_requests(content, requests) != 0) {
+        free(requests);
+        free(content);
+        return NULL;
+    }
+
+    free(content);
+    return requests;
+}
+
+/*
+   * @brief         Runs a single workload in a child process.
+   *                SystemC can elaborate a design only once per process, so every run needs a fresh process.
+   *                The simulation report is discarded, only the measurement is sent back to the parent.
+   *
+   * @param w       Workload to run
+   *
+   * @return        Sample with ok = 0 if the child failed
+*/
+static Sample run_workload(const Workload* w) {
+
+    Sample sample = {0};
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return sample;
+    }
+
+    /* Otherwise the child would print the buffered output of the parent a second time */
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return sample;
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+
+        SimulationOptions options;
+        init_simulation_options(&options);
+
+        uint32_t size = 0;
+        Request* requests = NULL;
+        if (w->workload) {
+            /* Requests are generated inside of run_simulation */
+            options.workload.name     = w->workload;
+            options.workload.size     = w->size;
+            options.workload.requests = GENERATED_REQUESTS;
+            size = GENERATED_REQUESTS;
+        }
+        else {
+            requests = load_trace(w, &size);
+        }
+
+        if (requests || w->workload) {
+            /* Silence the simulation report */
+            freopen("/dev/null", "w", stdout);
+
+            double start = monotonic_seconds();
+            Result result = run_simulation(CYCLES, NULL, NUM_CACHE_LEVELS, CACHE_LINE_SIZE,
+                                           NUM_LINES_L1, NUM_LINES_L2, NUM_LINES_L3,
+                                           LATENCY_CACHE_L1, LATENCY_CACHE_L2, LATENCY_CACHE_L3,
+                                           w->mappingStrategy, size, requests, &options);
+            sample.seconds  = monotonic_seconds() - start;
+            sample.cycles   = result.cycles;
+            /* A run stopped by the cycle limit completed fewer requests than it was given */
+            sample.requests = result.hits + result.misses;
+
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            sample.maxRssKiB = usage.ru_maxrss;
+            sample.ok = result.cycles > 0 && sample.requests > 0;
+
+            free(requests);
+        }
+
+        ssize_t written = write(fds[1], &sample, sizeof(sample));
+        close(fds[1]);
+        _exit(written == sizeof(sample) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    if (read(fds[0], &sample, sizeof(sample)) != sizeof(sample)) {
+        sample.ok = 0;
+    }
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        sample.ok = 0;
+    }
+    return sample;
+}
+
+/* Reads the baseline file. Returns the number of entries, 0 if there is no baseline */
+static size_t read_baseline(const char* filename, Metrics* baseline, size_t max) {
+
+    FILE* file = fopen(filename, "r");
+    if (!file) return 0;
+
+    size_t n = 0;
+    char line[256];
+    while (n < max && fgets(line, sizeof(line), file)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        Metrics* m = &baseline[n];
+        if (sscanf(line, "%63s %lf %lf %ld", m->name, &m->requestsPerSecond, &m->nsPerCycle, &m->maxRssKiB) == 4) {
+            n++;
+        }
+    }
+
+    fclose(file);
+    return n;
+}
+
+static bool write_baseline(const char* filename, const Metrics* metrics, size_t count) {
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Could not write baseline: %s\n", filename);
+        return false;
+    }
+
+    fprintf(file, "# workload requests_per_second ns_per_cycle max_rss_kib\n");
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%s %.1f %.2f %ld\n", metrics[i].name, metrics[i].requestsPerSecond, metrics[i].nsPerCycle, metrics[i].maxRssKiB);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static const Metrics* find_metrics(const Metrics* metrics, size_t count, const char* name) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(metrics[i].name, name) == 0) return &metrics[i];
+    }
+    return NULL;
+}
+
+/* Relative change from base to value in percent */
+static double change_percent(double value, double base) {
+    return base > 0 ? (value - base) * 100.0 / base : 0.0;
+}
+
+static void print_bench_help(void) {
+    printf(
+        "Usage: bench [options] [workload...]\n"
+        "Runs the canonical workloads through run_simulation and compares them against a baseline.\n\n"
+        "  --baseline FILE          |  Baseline file (default: %s)\n"
+        "  --update-baseline        |  Write the measured values as the new baseline\n"
+        "  --threshold PCT          |  Allowed slowdown in requests/s and ns/cycle in percent (default: %u)\n"
+        "  --rss-threshold PCT      |  Allowed growth of the peak RSS in percent (default: %u)\n"
+        "  --repeat N               |  Runs per workload, the fastest run counts (default: %u)\n"
+        "  --list                   |  List the workloads\n"
+        "  -h, --help               |  Print this help\n",
+        DEFAULT_BASELINE, DEFAULT_THRESHOLD, DEFAULT_RSS_THRESHOLD, DEFAULT_REPEAT
+    );
+}
+
+enum BenchOptions {
+    OPT_BASELINE = 256,
+    OPT_UPDATE_BASELINE,
+    OPT_THRESHOLD,
+    OPT_RSS_THRESHOLD,
+    OPT_REPEAT,
+    OPT_LIST,
+};
+
+int main(int argc, char** argv)
+{
+    static struct option long_options[] = {
+        {"baseline"       , required_argument, 0, OPT_BASELINE       },
+        {"update-baseline", no_argument      , 0, OPT_UPDATE_BASELINE},
+        {"threshold"      , required_argument, 0, OPT_THRESHOLD      },
+        {"rss-threshold"  , required_argument, 0, OPT_RSS_THRESHOLD  },
+        {"repeat"         , required_argument, 0, OPT_REPEAT         },
+        {"list"           , no_argument      , 0, OPT_LIST           },
+        {"help"           , no_argument      , 0, 'h'                },
+        {0                , 0                , 0,  0                 }
+    };
+
+    const char* baselineFile   = DEFAULT_BASELINE;
+    bool        updateBaseline = false;
+    uint32_t    threshold      = DEFAULT_THRESHOLD;
+    uint32_t    rssThreshold   = DEFAULT_RSS_THRESHOLD;
+    uint32_t    repeat         = DEFAULT_REPEAT;
+
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long(argc, argv, "h", long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case OPT_BASELINE:
+                baselineFile = optarg;
+                break;
+
+            case OPT_UPDATE_BASELINE:
+                updateBaseline = true;
+                break;
+
+            case OPT_THRESHOLD:
+                if (!parse_unsigned_int32(optarg, &threshold, "threshold")) return EINVAL;
+                break;
+
+            case OPT_RSS_THRESHOLD:
+                if (!parse_unsigned_int32(optarg, &rssThreshold, "RSS threshold")) return EINVAL;
+                break;
+
+            case OPT_REPEAT:
+                if (!parse_unsigned_int32(optarg, &repeat, "repeat")) return EINVAL;
+                break;
+
+            case OPT_LIST:
+                for (size_t i = 0; i < NUM_WORKLOADS; i++) {
+                    printf("%s\n", workloads[i].name);
+                }
+                return EXIT_SUCCESS;
+
+            case 'h':
+                print_bench_help();
+                return EXIT_SUCCESS;
+
+            default:
+                fprintf(stderr, "Invalid command argument. Please use --help or -h to see valid options.\n");
+                return EX_USAGE;
+        }
+    }
+
+    /* Remaining arguments select workloads by name, all workloads run if none is given */
+    bool selected[NUM_WORKLOADS];
+    for (size_t i = 0; i < NUM_WORKLOADS; i++) {
+        selected[i] = optind >= argc;
+    }
+    for (int a = optind; a < argc; a++) {
+        bool found = false;
+        for (size_t i = 0; i < NUM_WORKLOADS; i++) {
+            if (strcmp(argv[a], workloads[i].name) == 0) {
+                selected[i] = found = true;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "Unknown workload: %s. Please use --list to see valid workloads.\n", argv[a]);
+            return EX_USAGE;
+        }
+    }
+
+    Metrics baseline[MAX_WORKLOADS];
+    size_t baselineCount = read_baseline(baselineFile, baseline, MAX_WORKLOADS);
+    if (baselineCount == 0 && !updateBaseline) {
+        printf("No baseline in %s, nothing to compare against. Run with --update-baseline to create one.\n", baselineFile);
+    }
+
+    Metrics measured[MAX_WORKLOADS];
+    size_t measuredCount = 0;
+    int regressions = 0;
+    int failures = 0;
+
+    printf("%-18s %12s %14s %12s %12s\n", "workload", "requests", "requests/s", "ns/cycle", "max RSS KiB");
+
+    for (size_t i = 0; i < NUM_WORKLOADS; i++) {
+        if (!selected[i]) continue;
+
+        /* The fastest run is the least disturbed by the host */
+        Sample best = {0};
+        for (uint32_t r = 0; r < repeat; r++) {
+            Sample sample = run_workload(&workloads[i]);
+            if (!sample.ok) {
+                best.ok = 0;
+                break;
+            }
+            if (!best.ok || sample.seconds < best.seconds) best = sample;
+        }
+
+        if (!best.ok) {
+            fprintf(stderr, "%-18s failed\n", workloads[i].name);
+            failures++;
+            continue;
+        }
+
+        Metrics* m = &measured[measuredCount++];
+        snprintf(m->name, sizeof(m->name), "%s", workloads[i].name);
+        m->requestsPerSecond = best.requests / best.seconds;
+        m->nsPerCycle        = best.seconds * 1e9 / (double) best.cycles;
+        m->maxRssKiB         = best.maxRssKiB;
+
+        printf("%-18s %12u %14.1f %12.2f %12ld", m->name, best.requests, m->requestsPerSecond, m->nsPerCycle, m->maxRssKiB);
+
+        const Metrics* base = find_metrics(baseline, baselineCount, m->name);
+        if (base) {
+            double speed = change_percent(m->requestsPerSecond, base->requestsPerSecond);
+            double cycle = change_percent(m->nsPerCycle, base->nsPerCycle);
+            double rss   = change_percent((double) m->maxRssKiB, (double) base->maxRssKiB);
+            bool regressed = speed < -(double) threshold || cycle > (double) threshold || rss > (double) rssThreshold;
+            printf("   %+6.1f%% req/s %+6.1f%% ns/cycle %+6.1f%% RSS%s", speed, cycle, rss, regressed ? "   REGRESSION" : "");
+            if (regressed) regressions++;
+        }
+        printf("\n");
+    }
+
+    if (updateBaseline) {
+        if (failures > 0) {
+            fprintf(stderr, "Baseline not updated, %d workload(s) failed\n", failures);
+            return EXIT_FAILURE;
+        }
+        /* Keep the entries of workloads that were not run this time */
+        for (size_t i = 0; i < baselineCount && measuredCount < MAX_WORKLOADS; i++) {
+            if (!find_metrics(measured, measuredCount, baseline[i].name)) measured[measuredCount++] = baseline[i];
+        }
+        if (!write_baseline(baselineFile, measured, measuredCount)) return EXIT_FAILURE;
+        printf("Baseline written to %s\n", baselineFile);
+        return EXIT_SUCCESS;
+    }
+
+    if (regressions > 0) {
+        fprintf(stderr, "%d workload(s) regressed beyond the threshold\n", regressions);
+    }
+    return (regressions > 0 || failures > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* Linker satisfier */
+int sc_main(int argc, char* argv[])
+{
+    return 0;
+}
@@ -0,0 +1,185 @@
+#ifndef AUTO_TUNER_HPP
+#define AUTO_TUNER_HPP
+
+#include "functional_model.hpp"
+#include "simulator_config.hpp"
+#include "thread_pool.hpp"
+#include "structs/options.h"
+#include "structs/request.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// A hierarchy considered by AutoTuner and its result on the longest prefix it was evaluated on
+struct TuneCandidate
+{
+  SimulatorConfig config;
+  uint64_t capacity = 0;   // Bytes of all levels
+  double amat = 0.0;       // Average cycles per request
+  double hit_rate = 0.0;
+  uint32_t rank = 0;       // Pareto layer of the last evaluation, 0 is the front
+};
+
+/*
+ * @brief Searches the hierarchies that fit a capacity budget for the best AMAT per capacity.
+ *
+ * Candidates have 1 to 3 levels of power-of-two line counts from MIN_LINES, growing from level to level,
+ * with line sizes from MIN_LINE_SIZE to MAX_LINE_SIZE and either mapping strategy. A level's latency
+ * follows the cost model latency_base + latency_per_doubling * log2(bytes / 1 KiB), at least one cycle.
+ *
+ * The search is successive halving: all candidates run on a short prefix of the requests, the best
+ * third by Pareto layer of AMAT against capacity, then by AMAT, moves on to a prefix three times as
+ * long, until the survivors run on all requests. Every round runs on a work-stealing pool with the
+ * functional model, so AMAT includes the DRAM and link timing of the base configuration.
+ */
+class AutoTuner
+{
+public:
+  static constexpr uint32_t MIN_LINES = 16;
+  static constexpr uint32_t MIN_LINE_SIZE = 32;
+  static constexpr uint32_t MAX_LINE_SIZE = 128;
+  static constexpr uint32_t ETA = 3;              // One in ETA candidates survives a round
+  static constexpr size_t FINAL_CANDIDATES = 48;  // Rounds stop once this few candidates are left
+  static constexpr uint64_t MIN_PREFIX = 1024;    // Shortest prefix of the first round
+
+  struct Round
+  {
+    uint64_t prefix;   // Requests every candidate ran
+    size_t candidates; // Candidates evaluated in the round
+  };
+
+  AutoTuner(const SimulatorConfig &base, const TuneOptions &options) : options(options)
+  {
+    if (options.budget < MIN_LINES * MIN_LINE_SIZE)
+      throw std::runtime_error("InvalidArgumentException: The budget is smaller than the smallest cache");
+
+    for (uint32_t line_size = MIN_LINE_SIZE; line_size <= MAX_LINE_SIZE; line_size *= 2)
+      for (uint8_t mapping : {DIRECT_MAPPED, FULLY_ASSOCIATIVE})
+      {
+        SimulatorConfig config = base;
+        config.cacheline_size = line_size;
+        config.mapping_strategy = mapping;
+        enumerate(config, 0, 0, 0);
+      }
+  }
+
+  // Runs the search on count requests, which have to stay unchanged until it returns
+  void run(const Request *requests, size_t count, WorkStealingPool &pool)
+  {
+    rounds.clear();
+    std::vector<size_t> alive(candidates.size());
+    for (size_t i = 0; i < alive.size(); i++)
+      alive[i] = i;
+
+    // prefix lengths grow by ETA per round and end at the whole trace
+    size_t num_rounds = 1;
+    for (size_t left = alive.size(); left > FINAL_CANDIDATES; left = (left + ETA - 1) / ETA)
+      num_rounds++;
+    std::vector<uint64_t> prefixes(1, count);
+    while (prefixes.size() < num_rounds && prefixes.back() / ETA >= MIN_PREFIX)
+      prefixes.push_back(prefixes.back() / ETA);
+    std::reverse(prefixes.begin(), prefixes.end());
+
+    for (size_t round = 0; round < prefixes.size(); round++)
+    {
+      evaluate(alive, requests, prefixes[round], pool);
+      rank(alive);
+      if (round + 1 == prefixes.size())
+        break;
+
+      std::sort(alive.begin(), alive.end(), [&](size_t a, size_t b) {
+        return candidates[a].rank != candidates[b].rank ? candidates[a].rank < candidates[b].rank : candidates[a].amat < candidates[b].amat;
+      });
+      alive.resize(std::max(std::min(alive.size(), size_t(FINAL_CANDIDATES)), (alive.size() + ETA - 1) / ETA));
+    }
+    survivors = alive;
+  }
+
+  // Candidates of the last round that no other candidate beats in both AMAT and capacity, by capacity
+  std::vector<TuneCandidate> pareto_front() const
+  {
+    std::vector<TuneCandidate> front;
+    for (size_t i : survivors)
+      if (candidates[i].rank == 0) front.push_back(candidates[i]);
+    std::sort(front.begin(), front.end(), [](const TuneCandidate &a, const TuneCandidate &b) {
+      return a.capacity != b.capacity ? a.capacity < b.capacity : a.amat < b.amat;
+    });
+    return front;
+  }
+
+  uint32_t latency(uint64_t bytes) const
+  {
+    const double doublings = std::log2(static_cast<double>(bytes) / 1024.0);
+    const double cycles = options.latencyBase + options.latencyPerDoubling * doublings;
+    return cycles < 1.0 ? 1 : static_cast<uint32_t>(std::lround(cycles));
+  }
+
+  std::vector<TuneCandidate> candidates;
+  std::vector<Round> rounds;
+
+private:
+  // Adds every hierarchy that extends config, whose levels [0; level) are set and use used bytes
+  void enumerate(SimulatorConfig &config, uint8_t level, uint64_t used, uint64_t previous)
+  {
+    if (level > 0)
+    {
+      config.num_cache_levels = level;
+      TuneCandidate candidate;
+      candidate.config = config;
+      candidate.capacity = used;
+      candidates.push_back(candidate);
+    }
+    if (level == 3)
+      return;
+
+    const uint64_t line_size = config.cacheline_size;
+    for (uint64_t lines = MIN_LINES; used + lines * line_size <= options.budget; lines *= 2)
+    {
+      const uint64_t bytes = lines * line_size;
+      if (bytes <= previous || lines > UINT32_MAX)
+        continue;
+      config.num_lines[level] = static_cast<uint32_t>(lines);
+      config.latency[level] = latency(bytes);
+      enumerate(config, level + 1, used + bytes, bytes);
+    }
+  }
+
+  void evaluate(const std::vector<size_t> &alive, const Request *requests, uint64_t prefix, WorkStealingPool &pool)
+  {
+    pool.run(alive.size(), [&](size_t i) {
+      TuneCandidate &candidate = candidates[alive[i]];
+      const FunctionalRun run = FunctionalHierarchy(candidate.config).run(requests, prefix, UINT32_MAX);
+      candidate.amat = run.requests ? static_cast<double>(run.result.cycles) / run.requests : 0.0;
+      candidate.hit_rate = run.requests ? static_cast<double>(run.result.hits) / run.requests : 0.0;
+    });
+    rounds.push_back({prefix, alive.size()});
+  }
+
+  // Non-dominated sorting in two dimensions: in order of capacity, a candidate joins the first layer
+  // whose best AMAT so far is worse than its own
+  void rank(const std::vector<size_t> &alive)
+  {
+    std::vector<size_t> order(alive);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return candidates[a].capacity != candidates[b].capacity ? candidates[a].capacity < candidates[b].capacity
+                                                              : candidates[a].amat < candidates[b].amat;
+    });
+
+    std::vector<double> best; // best AMAT per layer, increasing
+    for (size_t i : order)
+    {
+      TuneCandidate &candidate = candidates[i];
+      const size_t layer = std::upper_bound(best.begin(), best.end(), candidate.amat) - best.begin();
+      if (layer == best.size()) best.push_back(candidate.amat);
+      else best[layer] = candidate.amat;
+      candidate.rank = static_cast<uint32_t>(layer);
+    }
+  }
+
+  const TuneOptions options;
+  std::vector<size_t> survivors;
+};
+
+#endif // AUTO_TUNER_HPP
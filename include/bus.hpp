@@ -0,0 +1,165 @@
+#ifndef BUS_HPP
+#define BUS_HPP
+
+#include "structs/default.h"
+#include "structs/options.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * @brief Timing model of a single half-duplex link between two neighbouring levels.
+ *
+ * A transfer of n bytes takes ceil(n / width) bus beats. One beat takes CORE_FREQUENCY / frequency
+ * core cycles, so a 64 byte line over a 32 byte bus at the core clock takes 2 cycles.
+ * Only one transfer can use the link at a time: a transfer that is booked while the link is still busy
+ * starts when the previous one has finished. The delay is counted as contention.
+ */
+class Link
+{
+public:
+  enum TransferKind
+  {
+    FILL,      // Cacheline moving from main memory towards L1
+    WRITEBACK, // Written data moving towards main memory
+    WORD,      // Requested word of a hit in a lower level moving towards L1
+    NUM_TRANSFER_KINDS
+  };
+
+  Link(uint32_t width, uint32_t frequency) : width(width), frequency(frequency)
+  {
+    if (width == 0 || frequency == 0)
+      throw std::runtime_error("InvalidArgumentException: Bus width and frequency must be positive");
+  }
+
+  // Core cycles needed to move bytes over the link
+  uint64_t duration(uint32_t bytes) const
+  {
+    const uint64_t beats = (bytes + width - 1) / width;
+    return (beats * CORE_FREQUENCY + frequency - 1) / frequency;
+  }
+
+  // Books a transfer that is ready to start at cycle now and returns the cycle it finishes
+  uint64_t transfer(uint64_t now, uint32_t bytes, TransferKind kind)
+  {
+    const uint64_t start = std::max(now, busy_until);
+    const uint64_t cycles = duration(bytes);
+
+    contention_cycles += start - now;
+    busy_cycles += cycles;
+    transfers[kind]++;
+    transferred_bytes[kind] += bytes;
+
+    busy_until = start + cycles;
+    return busy_until;
+  }
+
+  void reset()
+  {
+    busy_until = busy_cycles = contention_cycles = 0;
+    std::fill(transfers, transfers + NUM_TRANSFER_KINDS, 0);
+    std::fill(transferred_bytes, transferred_bytes + NUM_TRANSFER_KINDS, 0);
+  }
+
+  double utilization(uint64_t total_cycles) const
+  {
+    return total_cycles ? static_cast<double>(std::min(busy_cycles, total_cycles)) / static_cast<double>(total_cycles) : 0.0;
+  }
+
+  uint32_t width, frequency;
+
+  uint64_t busy_until = 0;        // Cycle at which the link becomes free
+  uint64_t busy_cycles = 0;       // Cycles the link was transferring data
+  uint64_t contention_cycles = 0; // Cycles transfers waited for the link to become free
+  uint64_t transfers[NUM_TRANSFER_KINDS] = {0};
+  uint64_t transferred_bytes[NUM_TRANSFER_KINDS] = {0};
+};
+
+/*
+ * @brief All links of a cache hierarchy with num_levels levels.
+ *
+ * Link i connects level i + 1 with level i + 2, the last link connects the last level with main memory.
+ * A transfer across several links is store-and-forward: it is booked on one link after the other.
+ */
+class Bus
+{
+public:
+  Bus(uint8_t num_levels, const BusOptions &options)
+  {
+    if (options.numWidths == 0 || options.numFrequencies == 0)
+      throw std::runtime_error("InvalidArgumentException: At least one bus width and frequency must be given");
+
+    for (uint32_t i = 0; i < num_levels; i++)
+      links.emplace_back(options.width[std::min(i, options.numWidths - 1)],
+                         options.frequency[std::min(i, options.numFrequencies - 1)]);
+  }
+
+  static BusOptions default_options()
+  {
+    BusOptions options;
+    options.numWidths = 1;
+    options.width[0] = BUS_WIDTH;
+    options.numFrequencies = 1;
+    options.frequency[0] = BUS_FREQUENCY;
+    return options;
+  }
+
+  // Books a transfer over the links [first; last] starting at cycle now.
+  // Towards main memory if first <= last, towards L1 otherwise. Returns the cycle the last link finishes
+  uint64_t transfer(uint64_t now, uint32_t first, uint32_t last, uint32_t bytes, Link::TransferKind kind)
+  {
+    if (first <= last)
+      for (uint32_t i = first; i <= last; i++)
+        now = links[i].transfer(now, bytes, kind);
+    else
+      for (uint32_t i = first + 1; i-- > last;)
+        now = links[i].transfer(now, bytes, kind);
+    return now;
+  }
+
+  // Books the fill of a line from main memory up to level to (0 = L1), where line_sizes[i] is the line size of level i.
+  // Every link carries the longest line of the levels it fills: a level with shorter lines takes a part of the
+  // transfer and a level with longer lines than the one below it is filled with several of the lower lines
+  uint64_t fill(uint64_t now, uint32_t to, const uint32_t *line_sizes)
+  {
+    for (uint32_t i = links.size(); i-- > to;)
+    {
+      const uint32_t bytes = *std::max_element(line_sizes + to, line_sizes + i + 1);
+      now = links[i].transfer(now, bytes, Link::FILL);
+    }
+    return now;
+  }
+
+  void reset()
+  {
+    for (Link &link : links)
+      link.reset();
+  }
+
+  // names are the names of the levels, L1, L2, ... if empty
+  void print_statistics(uint64_t total_cycles, const std::vector<std::string> &names = {}) const
+  {
+    auto name = [&](size_t level) { return level < names.size() ? names[level] : "L" + std::to_string(level + 1); };
+
+    std::cout << "\t\t======LINKS======\n";
+    for (size_t i = 0; i < links.size(); i++)
+    {
+      const Link &link = links[i];
+      const std::string lower = i + 1 == links.size() ? "main memory" : name(i + 1);
+      std::cout << "\t\t" << name(i) << " <-> " << lower << " (" << link.width << " B @ " << link.frequency << " MHz)\n"
+                << "\t\t  Link utilization: " << link.utilization(total_cycles) * 100.0 << "%\n"
+                << "\t\t  Busy cycles: " << link.busy_cycles << ", contention cycles: " << link.contention_cycles << "\n"
+                << "\t\t  Fills: " << link.transfers[Link::FILL] << " (" << link.transferred_bytes[Link::FILL] << " B)"
+                << ", writebacks: " << link.transfers[Link::WRITEBACK] << " (" << link.transferred_bytes[Link::WRITEBACK] << " B)"
+                << ", words: " << link.transfers[Link::WORD] << " (" << link.transferred_bytes[Link::WORD] << " B)\n";
+    }
+    std::cout << "\n";
+  }
+
+  std::vector<Link> links;
+};
+
+#endif // BUS_HPP
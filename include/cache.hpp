@@ -1,16 +1,21 @@
 #ifndef CACHE_HPP
 #define CACHE_HPP
 
+#include "bus.hpp"
 #include "cache_layer.hpp"
+#include "clock.hpp"
 #include "multiplexer.hpp"
 #include "main_memory.hpp"
+#include "profiler.hpp"
 #include "structs/debug.h"
 #include <systemc>
+#include <algorithm>
 #include <map>
+#include <string>
 #include <vector>
 #include <memory>
 
-// Define the zero time for cache operations, needed for waiting in cache operations
+// Time for the multiplexers to settle after their select signals changed
 #define CACHE_ZERO_TIME 1, SC_NS
 
 using namespace sc_core;
@@ -20,8 +25,10 @@ SC_MODULE(CACHE)
   // inputs
   sc_in<bool> clk;
 
-  sc_in<uint32_t> addr, wdata;
+  sc_in<uint64_t> addr;
+  sc_in<uint32_t> wdata;
   sc_in<bool> r, w;
+  sc_in<bool> fetch; // The read is an instruction fetch, served by L1I instead of L1 if the L1 is split
 
   sc_in<bool> mem_ready;
   std::vector<sc_in<uint8_t>> mem_cacheline;
@@ -30,65 +37,130 @@ SC_MODULE(CACHE)
   sc_out<uint32_t> rdata;
   sc_out<bool> ready, miss;
 
-  sc_out<uint32_t> mem_addr, mem_wdata;
+  sc_out<uint64_t> mem_addr;
+  sc_out<uint32_t> mem_wdata;
   sc_out<bool> mem_r, mem_w, mem_stop;
 
   // modules
   std::vector<std::unique_ptr<CACHE_LAYER>> L;
+  std::unique_ptr<CACHE_LAYER> L1I; // Instruction cache beside L[0], null if the L1 is unified
   MULTIPLEXER_BOOLEAN cache_miss_mux, cache_ready, r_mux, w_mux;
-  MULTIPLEXER_I32 cache_data, addr_mux, wdata_mux;
+  MULTIPLEXER_I32 cache_data, wdata_mux;
+  MULTIPLEXER_I64 addr_mux;
+
+  // links between the levels and to main memory
+  Bus bus;
 
   // parameters
   uint8_t num_cache_levels;
-  uint32_t cacheline_size, num_lines_L1, num_lines_L2, num_lines_L3;
-  uint32_t latency_cache_L1, latency_cache_L2, latency_cache_L3;
-  uint8_t mapping_strategy;
+  uint32_t cacheline_size;                              // Line of main memory, the longest line of all levels
+  std::vector<uint32_t> line_sizes, num_lines, latency; // Per level, L1 first
+  std::vector<uint8_t> mappings;                        // Per level, L1 first
 
-  // signals
-  sc_signal<uint32_t> addr_mux_in, addr_mux_out[3], wdata_mux_in, wdata_mux_out[3];
-  sc_signal<bool> r_mux_in, r_mux_out[3], w_mux_in, w_mux_out[3];
+  // Cache level that served the last request (1 = L1, ...), 0 if it was served by main memory
+  uint8_t served_level = 0;
+  bool fetching = false; // The current request is an instruction fetch of a split L1
 
-  sc_signal<uint32_t> mem_addr_sig, mem_wdata_sig;
+  // Steps of a request. Every state is entered by the trigger of the step before
+  enum State
+  {
+    IDLE,           // Waits for the edge that starts a request
+    DISPATCH,       // Inputs are forwarded to the levels and main memory
+    READ_ISSUE,     // Levels and main memory sample the read on this edge
+    READ_LEVELS,    // Waits for the levels to become ready, in order
+    READ_HIT,       // Multiplexers are switched to the hit level
+    READ_MEMORY,    // Waits for main memory after a miss in all levels
+    READ_WORD,      // Waits for the transfer of the hit word to L1
+    READ_FILL,      // Waits for the transfer of the line from main memory to L1
+    WRITE_ISSUE,    // Levels and main memory sample the write on this edge
+    WRITE_LEVELS,   // Waits for the levels to become ready, in order
+    WRITE_HIT,      // Multiplexers are switched to a hit level
+    WRITE_MEMORY,   // Waits for main memory
+    WRITE_FILL,     // Waits for the transfer of the line to the highest missing level
+    OUTPUT          // Ready is raised, rdata follows
+  };
+  State state = IDLE;
+  uint32_t level = 0;            // Level, whose ready signal is awaited
+  std::vector<bool> write_hit;   // write_hit[i] = true if cache level i was hit by the current write
+  std::vector<uint8_t> fill_line; // Line from main memory, every level that missed takes its line out of it
+  uint64_t transfer_finish = 0;  // Cycle, at which the current transfer over the links ends
+  bool sleeping = false;         // Sleeps towards the end of the current transfer
+
+  // signals, the ones per level are indexed by level
+  sc_signal<uint64_t> addr_mux_in;
+  std::vector<sc_signal<uint64_t>> addr_mux_out;
+  sc_signal<uint32_t> wdata_mux_in;
+  std::vector<sc_signal<uint32_t>> wdata_mux_out;
+  sc_signal<bool> r_mux_in, w_mux_in;
+  std::vector<sc_signal<bool>> r_mux_out, w_mux_out;
+
+  sc_signal<uint64_t> mem_addr_sig;
+  sc_signal<uint32_t> mem_wdata_sig;
   std::vector<sc_signal<uint8_t>> mem_cacheline_sig;
   sc_signal<bool> mem_r_sig, mem_w_sig, mem_ready_sig;
   // multiplexer signals
   sc_signal<uint8_t> data_mux_select, miss_mux_select, ready_mux_select, select_zero;
-  sc_signal<uint32_t> cache_data_in[3], cache_data_out;
-  sc_signal<bool> cache_miss_in[3], cache_miss_out, cache_ready_in[3], cache_ready_out;
+  std::vector<sc_signal<uint32_t>> cache_data_in;
+  sc_signal<uint32_t> cache_data_out;
+  std::vector<sc_signal<bool>> cache_miss_in, cache_ready_in;
+  sc_signal<bool> cache_miss_out, cache_ready_out;
+  // signals of a split L1, the multiplexers above take L1I as their last input
+  sc_signal<bool> l1d_r, l1i_r, l1i_w;
+  sc_signal<uint32_t> l1i_data;
+  sc_signal<bool> l1i_miss, l1i_ready;
 
   SC_CTOR(CACHE);
 
-  CACHE(sc_module_name name, uint8_t num_cache_levels, uint32_t cacheline_size, uint32_t num_lines_L1, uint32_t num_lines_L2,
-        uint32_t num_lines_L3, uint32_t latency_cache_L1, uint32_t latency_cache_L2, uint32_t latency_cache_L3, uint8_t mapping_strategy)
+  /*
+   * @brief Builds a hierarchy of num_cache_levels levels, any number of them.
+   *
+   * Levels may differ in line size and mapping. Main memory has to deliver lines of the longest line size,
+   * every level that misses takes the part of such a line that makes up its own line.
+   *
+   * @param line_sizes    Line size of every level in bytes, L1 first
+   * @param num_lines     Lines of every level, L1 first
+   * @param latency       Latency of every level in cycles, L1 first
+   * @param mappings      Mapping strategy of every level, L1 first
+   * @param names         Module names of the levels, L1, L2, ... if empty
+   * @param l1i_lines     Lines of an instruction cache beside L1, 0 keeps the L1 unified. L1I has the line size
+   *                      and mapping of L1, serves the fetches instead of L1 and shares the levels below it
+   * @param l1i_latency   Latency of L1I in cycles
+   */
+  CACHE(sc_module_name name, uint8_t num_cache_levels, const uint32_t *line_sizes, const uint32_t *num_lines, const uint32_t *latency,
+        const uint8_t *mappings, const BusOptions &bus_options = Bus::default_options(), const std::vector<std::string> &names = {},
+        uint32_t l1i_lines = 0, uint32_t l1i_latency = 0)
       : sc_module(name),
+        mem_cacheline(longest_line(line_sizes, num_cache_levels)),
         L(num_cache_levels),
-        num_cache_levels(num_cache_levels),
-        cacheline_size(cacheline_size),
-        num_lines_L1(num_lines_L1), num_lines_L2(num_lines_L2), num_lines_L3(num_lines_L3),
-        latency_cache_L1(latency_cache_L1), latency_cache_L2(latency_cache_L2), latency_cache_L3(latency_cache_L3),
-        mapping_strategy(mapping_strategy),
-        cache_data("cacheData", num_cache_levels, 1),
-        cache_miss_mux("cacheMiss", num_cache_levels, 1),
-        cache_ready("cacheReady", num_cache_levels, 1),
+        cache_miss_mux("cacheMiss", num_cache_levels + (l1i_lines > 0), 1),
+        cache_ready("cacheReady", num_cache_levels + (l1i_lines > 0), 1),
         r_mux("rMil", 1, num_cache_levels),
         w_mux("wMul", 1, num_cache_levels),
-        addr_mux("addrMul", 1, num_cache_levels),
+        cache_data("cacheData", num_cache_levels + (l1i_lines > 0), 1),
         wdata_mux("wdataMul", 1, num_cache_levels),
-        mem_cacheline_sig(cacheline_size),
-        mem_cacheline(cacheline_size)
+        addr_mux("addrMul", 1, num_cache_levels),
+        bus(num_cache_levels, bus_options),
+        num_cache_levels(num_cache_levels),
+        cacheline_size(longest_line(line_sizes, num_cache_levels)),
+        line_sizes(line_sizes, line_sizes + num_cache_levels),
+        num_lines(num_lines, num_lines + num_cache_levels),
+        latency(latency, latency + num_cache_levels),
+        mappings(mappings, mappings + num_cache_levels),
+        write_hit(num_cache_levels),
+        addr_mux_out(num_cache_levels), wdata_mux_out(num_cache_levels),
+        r_mux_out(num_cache_levels), w_mux_out(num_cache_levels),
+        mem_cacheline_sig(longest_line(line_sizes, num_cache_levels)),
+        cache_data_in(num_cache_levels), cache_miss_in(num_cache_levels), cache_ready_in(num_cache_levels)
   {
-    switch (num_cache_levels) {
-    case 3:
-      L[2] = (std::make_unique<CACHE_LAYER>("L3", latency_cache_L3, num_lines_L3, cacheline_size, mapping_strategy, 3));
-    case 2:
-      L[1] = (std::make_unique<CACHE_LAYER>("L2", latency_cache_L2, num_lines_L2, cacheline_size, mapping_strategy, 2));
-    case 1:
-      L[0] = (std::make_unique<CACHE_LAYER>("L1", latency_cache_L1, num_lines_L1, cacheline_size, mapping_strategy, 1));
-      break;
-    default:
-      throw std::runtime_error("Number of Cache Levels must be in range [1;3].\n");
-      break;
+    if (num_cache_levels < 1)
+      throw std::runtime_error("Number of Cache Levels must be at least 1.\n");
+    for (uint32_t i = 0; i < num_cache_levels; i++)
+    {
+      const std::string level_name = i < names.size() && !names[i].empty() ? names[i] : "L" + std::to_string(i + 1);
+      L[i] = std::make_unique<CACHE_LAYER>(level_name.c_str(), latency[i], num_lines[i], line_sizes[i], mappings[i], i + 1);
     }
+    if (l1i_lines > 0)
+      L1I = std::make_unique<CACHE_LAYER>("L1I", l1i_latency, l1i_lines, line_sizes[0], mappings[0], 1);
     // set up mux for input data. 1 input, numCacheLevels output. each output for each cache level. select-bit everywhere = 0
     // input data will be writen to mux in behavior()
     select_zero.write(0);
@@ -110,7 +182,9 @@ SC_MODULE(CACHE)
       addr_mux.out[i](addr_mux_out[i]);
       L[i]->wdata(wdata_mux_out[i]);
       wdata_mux.out[i](wdata_mux_out[i]);
-      L[i]->r(r_mux_out[i]);
+      // L1 of a split L1 only sees the reads that aren't fetches
+      if (i == 0 && L1I) L[i]->r(l1d_r);
+      else L[i]->r(r_mux_out[i]);
       r_mux.out[i](r_mux_out[i]);
       L[i]->w(w_mux_out[i]);
       w_mux.out[i](w_mux_out[i]);
@@ -123,6 +197,22 @@ SC_MODULE(CACHE)
       cache_ready.in[i](cache_ready_in[i]);
     }
 
+    // L1I takes the fetches and is never written, its line comes from the levels below on a miss
+    if (L1I)
+    {
+      L1I->clk(clk);
+      L1I->addr(addr_mux_in);
+      L1I->wdata(wdata_mux_in);
+      L1I->r(l1i_r);
+      L1I->w(l1i_w);
+      L1I->data(l1i_data);
+      cache_data.in[num_cache_levels](l1i_data);
+      L1I->miss(l1i_miss);
+      cache_miss_mux.in[num_cache_levels](l1i_miss);
+      L1I->ready(l1i_ready);
+      cache_ready.in[num_cache_levels](l1i_ready);
+    }
+
     // connect output from mux, to get data from one of the cache levels
     cache_data.out[0](cache_data_out);
     cache_data.select(data_mux_select);
@@ -131,10 +221,22 @@ SC_MODULE(CACHE)
     cache_ready.out[0](cache_ready_out);
     cache_ready.select(ready_mux_select);
 
-    SC_THREAD(behaviour);
+    SC_METHOD(behaviour);
     sensitive << clk.pos();
+    dont_initialize();
+  }
+
+  static uint32_t longest_line(const uint32_t *line_sizes, uint8_t num_cache_levels)
+  {
+    return num_cache_levels > 0 ? *std::max_element(line_sizes, line_sizes + num_cache_levels) : 0;
   }
 
+  // Level i of the current request, L1I instead of L1 for a fetch
+  CACHE_LAYER &layer(uint32_t i) { return i == 0 && fetching ? *L1I : *L[i]; }
+
+  // Input of the output multiplexers that level i of the current request is connected to
+  uint8_t mux_input(uint32_t i) const { return i == 0 && fetching ? num_cache_levels : i; }
+
   /* * @brief Prints the internal memory of each cache level.
    * This function iterates through each cache level and prints its internal memory contents.
    * Used for debugging and verifying the state of the cache hierarchy.
@@ -147,6 +249,7 @@ SC_MODULE(CACHE)
     {
       L[i]->print_internal_memory(i + 1);
     }
+    if (L1I) L1I->print_internal_memory(1);
     std::cout << "\n";
   }
 
@@ -155,6 +258,16 @@ SC_MODULE(CACHE)
     // set input signals in multiplexers, which forward them to each cache level
     w_mux_in.write(w.read());
     r_mux_in.write(r.read());
+    if (L1I)
+    {
+      fetching = fetch.read();
+      l1d_r.write(r.read() && !fetching);
+      l1i_r.write(r.read() && fetching);
+      // L1 and L1I don't keep their outputs alike, so the multiplexers start at the L1 of this request
+      miss_mux_select.write(mux_input(0));
+      ready_mux_select.write(mux_input(0));
+      data_mux_select.write(mux_input(0));
+    }
     wdata_mux_in.write(wdata.read());
     addr_mux_in.write(addr.read());
     mem_addr.write(addr.read());
@@ -170,30 +283,173 @@ SC_MODULE(CACHE)
     mem_stop.write(false);
   }
 
+  /*
+   * @brief Handles a request as a state machine, one state per step between two waits.
+   *
+   * A request starts on a clock edge with r or w set. It is forwarded to the levels and main memory on the
+   * next edge, then the levels are awaited in order and the result is put on rdata, miss and ready. Every
+   * step is triggered exactly when the same step of a process waiting in between would resume.
+   */
   void behaviour()
   {
-    while (true)
+    process_counters().activations[PROFILE_CACHE]++;
+
+    switch (state)
     {
-      wait();
-      DEBUG_PRINT("MAIN: Cache behaviour thread running...\n");
+    case IDLE:
+      LOG_TRACE("MAIN: Cache behaviour running...\n");
       reset_signals();
       set_mux_signals();
-      wait(SC_ZERO_TIME);
-      DEBUG_PRINT("MAIN: Input signals set in multiplexers.\n");
+      state = DISPATCH;
+      next_trigger(SC_ZERO_TIME);
+      break;
 
-      if (r.read()) doRead();
-      if (w.read()) doWrite();
+    case DISPATCH:
+      LOG_TRACE("MAIN: Input signals set in multiplexers.\n");
+      if (r.read()) start_read();
+      else if (w.read()) start_write();
+      else finish_request();
+      break;
+
+    case READ_ISSUE:
+      mem_r.write(false); // setting read signal to false, so that MM will not read data after this request if not needed
+      r_mux_in.write(false);
+      l1d_r.write(false);
+      l1i_r.write(false);
+      start_waiting_for_level(0, READ_LEVELS);
+      next_trigger(SC_ZERO_TIME);
+      break;
+
+    case READ_LEVELS:
+      read_levels();
+      break;
+
+    case READ_HIT:
+      read_hit();
+      break;
+
+    case READ_MEMORY:
+      read_memory();
+      break;
 
-      ready.write(true);
-      miss.write(cache_miss_out.read());
-      wait_zero_cachetime();
+    case WRITE_ISSUE:
+      mem_w.write(false); // setting write signal to false, so that MM will not write data after this request if not needed
+      w_mux_in.write(false);
+      start_waiting_for_level(0, WRITE_LEVELS);
+      next_trigger(SC_ZERO_TIME);
+      break;
+
+    case WRITE_LEVELS:
+      write_levels();
+      break;
+
+    case WRITE_HIT:
+      record_write_level();
+      write_levels();
+      break;
+
+    case WRITE_MEMORY:
+      write_memory();
+      break;
+
+    case READ_WORD:
+    case READ_FILL:
+    case WRITE_FILL:
+      continue_transfer();
+      break;
+
+    case OUTPUT:
       if (!miss.read()) rdata.write(cache_data_out.read());
-      DEBUG_PRINT("MAIN: Output signals set: ready=%s, miss=%s, rdata=%u\n", ready.read() ? "true" : "false", miss.read() ? "true" : "false", rdata.read());
+      LOG_TRACE("MAIN: Output signals set: ready=%s, miss=%s, rdata=%u\n", ready.read() ? "true" : "false", miss.read() ? "true" : "false", rdata.read());
+      state = IDLE;
+      break;
     }
   }
 
-  void wait_zero_cachetime() {
-    wait(CACHE_ZERO_TIME);
+  // Raises ready and puts out miss. rdata of a hit follows after the multiplexers have settled
+  void finish_request()
+  {
+    ready.write(true);
+    miss.write(cache_miss_out.read());
+    state = OUTPUT;
+    next_trigger(CACHE_ZERO_TIME);
+  }
+
+  // Books a transfer over the links [first; last] and continues in next_state once it has finished
+  void start_transfer(uint32_t first, uint32_t last, uint32_t bytes, Link::TransferKind kind, State next_state)
+  {
+    transfer_finish = bus.transfer(current_cycle(), first, last, bytes, kind);
+    LOG_TRACE("MAIN: Waiting for transfer of %u bytes over links %u..%u until cycle %" PRIu64 "\n", bytes, first, last, transfer_finish);
+    state = next_state;
+    continue_transfer();
+  }
+
+  // Books the fill of a line from main memory up to level to and continues in next_state once it has arrived
+  void start_fill(uint32_t to, State next_state)
+  {
+    transfer_finish = bus.fill(current_cycle(), to, line_sizes.data());
+    LOG_TRACE("MAIN: Waiting for fill of levels %u..%u until cycle %" PRIu64 "\n", to + 1, num_cache_levels, transfer_finish);
+    state = next_state;
+    continue_transfer();
+  }
+
+  // First byte of the line of level i within the line from main memory
+  const uint8_t *level_line(uint32_t i) const
+  {
+    return fill_line.data() + (addr.read() & (cacheline_size - 1) & ~static_cast<uint64_t>(line_sizes[i] - 1));
+  }
+
+  // Checked on every edge until the transfer has finished. Long transfers sleep until shortly before their last edge
+  void continue_transfer()
+  {
+    if (sleeping)
+    {
+      sleeping = false;
+      next_trigger();
+      return;
+    }
+    if (current_cycle() < transfer_finish)
+    {
+      const sc_time delay = delay_before_cycle(transfer_finish);
+      if (delay == SC_ZERO_TIME) next_trigger();
+      else
+      {
+        next_trigger(delay);
+        sleeping = true;
+      }
+      return;
+    }
+
+    if (state == READ_WORD)
+    {
+      read_done();
+    }
+    else if (state == READ_FILL)
+    {
+      // write cacheline to each cache level
+      for (int i = 0; i < num_cache_levels; i++)
+        layer(i).write_cacheline(addr.read(), level_line(i));
+
+      // set output data
+      rdata.write(layer(0).extract_word(level_line(0), addr.read() & (line_sizes[0] - 1)));
+      read_done();
+    }
+    else
+    {
+      // write data to each cache level, where it was miss
+      for (int i = 0; i < num_cache_levels; i++)
+        if (!write_hit[i]) L[i]->write_cacheline(addr.read(), level_line(i));
+
+      LOG_TRACE("MAIN: Data written to cache levels.\n");
+      finish_request();
+    }
+  }
+
+  void start_waiting_for_level(uint32_t i, State waiting_state)
+  {
+    level = i;
+    state = waiting_state;
+    LOG_TRACE("MAIN: Waiting for cache level %d to be ready...\n", i + 1);
   }
 
   /**
@@ -206,62 +462,93 @@ SC_MODULE(CACHE)
    * If all cache levels miss, it waits for the main memory to become ready, retrieves the cacheline from
    * memory, writes it to all cache levels, and outputs the requested word from the newly filled cacheline.
    */
-  void doRead()
+  void start_read()
   {
-    bool hit = false;
+    served_level = 0;
 
-    // mem_r.write(true); // setting read signal to true, so that MM will start reading data
-    wait(); // wait for the next clock cycle so that memory and cache levels start processing the request
-    mem_r.write(false); // setting read signal to false, so that MM will not read data after this request if not needed
-    r_mux_in.write(false);
-    wait(SC_ZERO_TIME);
+    // wait for the next clock cycle so that memory and cache levels start processing the request
+    state = READ_ISSUE;
+    next_trigger();
+  }
 
-    for (uint32_t i = 0; i < num_cache_levels; i++)
+  // Awaits the levels in order until one of them hits or all of them missed
+  void read_levels()
+  {
+    while (level < num_cache_levels)
     {
       // wait till cache level will be ready
-      wait_for_cache_level_ready(i);
+      CACHE_LAYER &current = layer(level);
+      if (!current.ready.read())
+      {
+        next_trigger(current.done_event);
+        return;
+      }
+
+      // the levels above missed, so the request reached this one
+      current.record_lookup(addr.read(), !current.miss.read());
 
       // if data was found in cache level, set select bits for multiplexers
-      if (!hit && !L[i]->miss.read())
+      if (!current.miss.read())
       {
-        DEBUG_PRINT("MAIN: Hit in L[%d]: %s\n", i + 1, !L[i]->miss.read() ? "true" : "false");
-        DEBUG_PRINT("MAIN: Read data in CACHE_LAYER[%d]: %u\n", i + 1, L[i]->data.read());
-
-        hit = true;
-        DEBUG_PRINT("MAIN: Miss before multiplexer select: %s, ready: %s, rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
-        miss_mux_select.write(i);
-        ready_mux_select.write(i);
-        data_mux_select.write(i);
-        wait_zero_cachetime();
-        DEBUG_PRINT("MAIN: Miss after multiplexer select: %s, ready: %s, rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
-
-        for (uint32_t j = 0; j < num_cache_levels; j++)
-        {
-          DEBUG_PRINT("MAIN: Setting stop signal for CACHE_LAYER[%d] to %s\n", j + 1, j == i ? "false" : "true");
-          if (j != i) L[j]->stop = true; // stop waiting the latency in other cache levels
-        }
-        mem_stop.write(true); // stop waiting the latency in main memory
-        
-        break;
+        LOG_TRACE("MAIN: Hit in L[%d]: %s\n", level + 1, !current.miss.read() ? "true" : "false");
+        LOG_TRACE("MAIN: Read data in CACHE_LAYER[%d]: %u\n", level + 1, current.data.read());
+
+        served_level = level + 1;
+        LOG_TRACE("MAIN: Miss before multiplexer select: %s, ready: %s, rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
+        miss_mux_select.write(mux_input(level));
+        ready_mux_select.write(mux_input(level));
+        data_mux_select.write(mux_input(level));
+        state = READ_HIT;
+        next_trigger(CACHE_ZERO_TIME);
+        return;
       }
+
+      if (level + 1 < num_cache_levels) start_waiting_for_level(level + 1, READ_LEVELS);
+      else level++;
     }
 
     // if miss in all cache levels
-    if (!hit)
-    {
-      DEBUG_PRINT("MAIN: Miss in all cache levels.\n");
-      wait_for_main_memory_ready();
+    LOG_TRACE("MAIN: Miss in all cache levels.\n");
+    LOG_TRACE("MAIN: Waiting for main memory to be ready...\n");
+    state = READ_MEMORY;
+    read_memory();
+  }
 
-      std::vector<uint8_t> cacheline = get_cacheline_from_memory();
+  void read_hit()
+  {
+    LOG_TRACE("MAIN: Miss after multiplexer select: %s, ready: %s, rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
 
-      // write cacheline to each cache level
-      for (int i = 0; i < num_cache_levels; i++)
-        L[i]->write_cacheline(addr.read(), cacheline);
+    for (uint32_t j = 0; j < num_cache_levels; j++)
+    {
+      LOG_TRACE("MAIN: Setting stop signal for CACHE_LAYER[%d] to %s\n", j + 1, j == level ? "false" : "true");
+      if (j != level) layer(j).request_stop(); // stop waiting the latency in other cache levels
+    }
+    mem_stop.write(true); // stop waiting the latency in main memory
 
-      // set output data
-      rdata.write(L[0]->extract_word(cacheline, addr.read() & (cacheline_size - 1)));
+    // the requested word moves up to L1 over the links above the hit level
+    if (level > 0) start_transfer(level - 1, 0, sizeof(uint32_t), Link::WORD, READ_WORD);
+    else read_done();
+  }
+
+  void read_memory()
+  {
+    if (!mem_ready.read())
+    {
+      next_trigger(mem_ready.posedge_event());
+      return;
     }
-    DEBUG_PRINT("MAIN: Read operation completed. Miss: %s, Ready: %s, Rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
+
+    fill_line = get_cacheline_from_memory();
+
+    // the line moves from main memory through every level up to L1
+    start_fill(0, READ_FILL);
+  }
+
+  void read_done()
+  {
+    LOG_TRACE("MAIN: Read operation completed. Miss: %s, Ready: %s, Rdata: %u\n", miss.read() ? "true" : "false", ready.read() ? "true" : "false", rdata.read());
+    if (w.read()) start_write();
+    else finish_request();
   }
 
   // Helper function to get cacheline from main memory for read/write operations
@@ -282,22 +569,6 @@ SC_MODULE(CACHE)
     mem_w.write(w.read());
   }
 
-  void wait_for_main_memory_ready() {
-    DEBUG_PRINT("MAIN: Waiting for main memory to be ready...\n");
-    while (!mem_ready.read())
-    {
-      wait_zero_cachetime();
-    }
-  }
-
-  void wait_for_cache_level_ready(const int i) {
-    DEBUG_PRINT("MAIN: Waiting for cache level %d to be ready...\n", i + 1);
-    while (!L[i]->ready.read())
-    {
-      wait_zero_cachetime();
-    }
-  }
-
   /**
  * @brief Handles a write request in the cache hierarchy.
  *
@@ -307,53 +578,122 @@ SC_MODULE(CACHE)
  * The function ensures that the written data is reflected in both the cache hierarchy and main memory,
  * and updates multiplexer select signals to route the correct outputs after the operation.
  */
-  void doWrite()
+  void start_write()
   {
-    bool hit[num_cache_levels]; // hit[i] = true if cache level i was hit
-    uint8_t indexL[num_cache_levels];
+    served_level = 0;
 
-    // w_mux_in.write(true); // setting write signal to true, so that MM will start writing data
-    wait(); // wait for the next clock cycle so that memory and cache levels start processing the request
-    mem_w.write(false); // setting write signal to false, so that MM will not write data after this request if not needed
-    w_mux_in.write(false);
-    wait(SC_ZERO_TIME);
+    // wait for the next clock cycle so that memory and cache levels start processing the request
+    state = WRITE_ISSUE;
+    next_trigger();
+  }
 
-    for (int i = 0; i < num_cache_levels; i++)
+  // Awaits the levels in order and records which of them were hit
+  void write_levels()
+  {
+    while (level < num_cache_levels)
     {
-      wait_for_cache_level_ready(i);
+      if (!L[level]->ready.read())
+      {
+        next_trigger(L[level]->done_event);
+        return;
+      }
 
-      if (!L[i]->miss.read())
+      if (!L[level]->miss.read())
       {
-        miss_mux_select.write(i); // TODO: fix
-        ready_mux_select.write(i);
-        data_mux_select.write(i);
-        wait_zero_cachetime();
+        miss_mux_select.write(level); // TODO: fix
+        ready_mux_select.write(level);
+        data_mux_select.write(level);
+        state = WRITE_HIT;
+        next_trigger(CACHE_ZERO_TIME);
+        return;
       }
-      
-      hit[i] = !L[i]->miss.read();
+
+      record_write_level();
     }
-    DEBUG_PRINT("MAIN: Hit caches in write -> L[1]: %s, L[2]: %s, L[3]: %s\n", hit[0] ? "true" : "false", hit[1] ? "true" : "false", hit[2] ? "true" : "false");
 
-    DEBUG_PRINT("MAIN: Waiting for main memory to be ready...\n");
-    wait_for_main_memory_ready();
+    // write-through: the word is posted towards main memory, the cache doesn't wait for the links,
+    // but the links stay busy for later transfers
+    bus.transfer(current_cycle(), 0, num_cache_levels - 1, sizeof(uint32_t), Link::WRITEBACK);
 
-    DEBUG_PRINT("MAIN: Main memory is ready, writing data to cache levels...\n");
+    LOG_TRACE("MAIN: Waiting for main memory to be ready...\n");
+    state = WRITE_MEMORY;
+    write_memory();
+  }
 
-    std::vector<uint8_t> cacheline = get_cacheline_from_memory();
+  // Records the hit of the awaited level and moves on to the next one
+  void record_write_level()
+  {
+    write_hit[level] = !L[level]->miss.read();
+    L[level]->record_lookup(addr.read(), write_hit[level]); // a write goes through every level
+    LOG_TRACE("MAIN: Hit in write L[%d]: %s\n", level + 1, write_hit[level] ? "true" : "false");
+    if (write_hit[level] && served_level == 0) served_level = level + 1;
+
+    if (level + 1 < num_cache_levels) start_waiting_for_level(level + 1, WRITE_LEVELS);
+    else
+    {
+      level++;
+      state = WRITE_LEVELS;
+    }
+  }
+
+  void write_memory()
+  {
+    if (!mem_ready.read())
+    {
+      next_trigger(mem_ready.posedge_event());
+      return;
+    }
+
+    LOG_TRACE("MAIN: Main memory is ready, writing data to cache levels...\n");
+
+    fill_line = get_cacheline_from_memory();
+
+    // the line moves from main memory up to the highest level that missed
+    int highest_miss = -1;
+    for (int i = num_cache_levels - 1; i >= 0; i--)
+      if (!write_hit[i]) highest_miss = i;
+    if (highest_miss >= 0)
+      start_fill(highest_miss, WRITE_FILL);
+    else
+    {
+      transfer_finish = 0;
+      state = WRITE_FILL;
+      continue_transfer();
+    }
+  }
+
+  // Changes the parameters of all levels and the links and empties all levels. The number of levels, the line
+  // sizes and whether the L1 is split are fixed by the elaborated ports and can't be changed
+  void configure(const uint32_t *num_lines, const uint32_t *latency, const uint8_t *mappings, const BusOptions &bus_options,
+                 uint32_t l1i_lines = 0, uint32_t l1i_latency = 0)
+  {
+    this->num_lines.assign(num_lines, num_lines + num_cache_levels);
+    this->latency.assign(latency, latency + num_cache_levels);
+    this->mappings.assign(mappings, mappings + num_cache_levels);
 
-    // write data to each cache level, where it was miss
     for (int i = 0; i < num_cache_levels; i++)
-      if (!hit[i]) L[i]->write_cacheline(addr.read(), cacheline);
+      L[i]->configure(latency[i], num_lines[i], mappings[i]);
+    if (L1I) L1I->configure(l1i_latency, l1i_lines, mappings[0]);
+    bus = Bus(num_cache_levels, bus_options);
+    served_level = 0;
+  }
 
-    DEBUG_PRINT("MAIN: Data written to cache levels.\n");
+  // Sum of valid cache lines replaced in all cache levels
+  uint32_t total_evictions()
+  {
+    uint32_t evictions = 0;
+    for (int i = 0; i < num_cache_levels; i++)
+      evictions += L[i]->evictions;
+    if (L1I) evictions += L1I->evictions;
+    return evictions;
   }
 
   // Returns byte in cache-level: level, cache line: line_index, at position: index
-  // Assumes that level is in range [0;2], where 0 represents L1, 1 represents L2, and 2 represents L3.
+  // level is in range [0;num_cache_levels), where 0 represents L1
   uint8_t get_cache_line_content(uint32_t level, uint32_t line_index, uint32_t index)
   {
-    if (level < 0 || level >= num_cache_levels)
-      throw std::runtime_error("Number of cache levels must be in range [1;3] in method get_cacheline_content.\n");
+    if (level >= num_cache_levels)
+      throw std::runtime_error("Cache level must be below the number of cache levels in method get_cacheline_content.\n");
     return L[level]->get_cacheline_content(line_index, index);
   }
 };
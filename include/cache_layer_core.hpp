@@ -0,0 +1,350 @@
+#ifndef CACHE_LAYER_CORE_HPP
+#define CACHE_LAYER_CORE_HPP
+
+#include "conflict_profile.hpp"
+#include "miss_classifier.hpp"
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+struct CacheLine
+{
+  uint64_t tag;
+  bool valid;
+  std::vector<uint8_t> data;
+};
+
+constexpr uint8_t DIRECT_MAPPED = 0;
+constexpr uint8_t FULLY_ASSOCIATIVE = 1;
+
+/*
+ * @brief Contents, lookup and replacement of a single cache level, without any SystemC dependency.
+ *
+ * CACHE_LAYER adds the ports and the clocked behaviour on top of it. The functional model of the
+ * batch mode uses it directly, so that many hierarchies can be simulated on different threads,
+ * which the process-global SystemC kernel doesn't allow.
+ */
+class CacheLayerCore
+{
+public:
+  uint32_t latency, num_lines, cacheline_size;
+  uint8_t mapping_strategy, layer_index;
+
+  bool test_mode = false; // If true, the cache is in test mode and does not throw exceptions
+  bool error = false;     // If true, the cache has encountered an error
+
+  // Number of actually occupied cache lines.
+  // Used only with fully-associative mapping strategy to pick an index for new cacheline or determining if the memory is full
+  uint32_t size = 0;
+
+  // Number of valid cache lines replaced by write_cacheline since the start of the simulation
+  uint32_t evictions = 0;
+
+  std::vector<CacheLine> cache_memory;
+  std::list<uint32_t> lru_list;                                        // Indexes of cache_memory in LRU order (head: MRU, tail: LRU)
+  std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map; // Maps tag to lru_list node
+
+  // Sorts the misses of the level by cause, only if enabled
+  MissClassifier miss_classifier;
+
+  // Counts misses and evictions per set, line and region, only if enabled
+  ConflictProfile conflict_profile;
+
+  CacheLayerCore(const uint32_t latency, const uint32_t num_lines, uint32_t cacheline_size, uint8_t mapping_strategy, uint8_t layer_index)
+      : latency(latency), num_lines(num_lines), cacheline_size(cacheline_size), mapping_strategy(mapping_strategy), layer_index(layer_index)
+  {
+    if (__builtin_popcount(cacheline_size) != 1 || __builtin_popcount(num_lines) != 1)
+      throw std::runtime_error("InvalidArgumentException: cacheline_size and num_lines must be powers of 2");
+
+    cache_memory.resize(num_lines, {0, false, std::vector<uint8_t>(cacheline_size)});
+    miss_classifier.configure(num_lines);
+    conflict_profile.configure(num_sets());
+  }
+
+  // Changes the parameters and empties the layer, so that the layer can be reused for another run
+  void configure(const uint32_t latency, const uint32_t num_lines, uint8_t mapping_strategy)
+  {
+    if (__builtin_popcount(num_lines) != 1)
+      throw std::runtime_error("InvalidArgumentException: num_lines must be a power of 2");
+    if (mapping_strategy != DIRECT_MAPPED && mapping_strategy != FULLY_ASSOCIATIVE)
+      throw std::runtime_error("Invalid mapping_strategy");
+
+    this->latency = latency;
+    this->num_lines = num_lines;
+    this->mapping_strategy = mapping_strategy;
+    miss_classifier.configure(num_lines);
+    conflict_profile.configure(num_sets());
+    reset();
+  }
+
+  // Invalidates all lines and clears the statistics
+  void reset()
+  {
+    cache_memory.assign(num_lines, {0, false, std::vector<uint8_t>(cacheline_size)});
+    lru_list.clear();
+    lru_map.clear();
+    size = 0;
+    evictions = 0;
+    error = false;
+    miss_classifier.reset();
+    conflict_profile.reset();
+  }
+
+  // Sets of the level: every line of a direct-mapped level, a single one of a fully associative level
+  uint32_t num_sets() const { return mapping_strategy == DIRECT_MAPPED ? num_lines : 1; }
+
+  uint32_t set_index(uint64_t address) const
+  {
+    return mapping_strategy == DIRECT_MAPPED ? (address >> __builtin_ctz(cacheline_size)) & (num_lines - 1) : 0;
+  }
+
+  /**
+   * @brief Looks up address and marks the line as most recently used on a hit.
+   *
+   * Every level looks up every request, so the lookup is only counted in the miss classifier and the
+   * conflict profile by record_lookup, once the hierarchy knows that the request reached the level.
+   *
+   * @param address  Address of the accessed word
+   * @param index    Set to the index of the line in cache_memory on a hit
+   * @param offset   Set to the offset of the word within the line
+   * @return         True on a hit. An invalid offset sets error and counts as a miss
+   */
+  bool lookup(const uint64_t address, uint32_t &index, uint32_t &offset)
+  {
+    uint64_t tag;
+
+    if (miss_classifier.enabled)
+      miss_classifier.touch(address >> __builtin_ctz(cacheline_size));
+
+    if (mapping_strategy == DIRECT_MAPPED)
+    {
+      set_offset_index_tag(address, &offset, &index, tag);
+      return !error && cache_memory[index].valid && cache_memory[index].tag == tag;
+    }
+
+    set_offset_index_tag(address, &offset, nullptr, tag);
+    auto it = lru_map.find(tag);
+    if (error || it == lru_map.end())
+      return false;
+
+    // Move the according node in lru_list to the beginning and update the map value
+    index = *it->second;             // this extracts the index of the needed cacheline from the map
+    lru_list.erase(it->second);      // erasing the node associated with the tag from lru_list
+    lru_list.push_front(index);      // pushing it to the beginning
+    lru_map[tag] = lru_list.begin(); // updating the map
+    return true;
+  }
+
+  // Records a lookup of a request that reached the level, i.e. missed all levels above, with its outcome
+  void record_lookup(const uint64_t address, bool hit)
+  {
+    if (miss_classifier.enabled)
+      miss_classifier.lookup(address >> __builtin_ctz(cacheline_size), hit);
+    if (!hit && conflict_profile.enabled)
+      conflict_profile.miss(set_index(address), address >> __builtin_ctz(cacheline_size), address);
+  }
+
+  // Prints the content of the cache memory for debugging purposes
+  void print_internal_memory(int l)
+  {
+    // Print the linked list of cache lines in LRU order
+    std::cout << "CACHE_LAYER " << l << ": LRU List (most recently used to least recently used): ";
+    for (const auto &index : lru_list)
+    {
+      std::cout << index << " ";
+    }
+    std::cout << "\n";
+    std::cout << "CACHE_LAYER " << l << ": Cache Memory Content:\n";
+    std::cout << "Index\tTag\tValid\tData\n";
+    uint32_t invalid_cachelines = 0;
+    for (size_t i = 0; i < cache_memory.size(); ++i)
+    {
+      const auto &line = cache_memory[i];
+      if (!line.valid) {
+        invalid_cachelines++;
+        continue; // Skip invalid lines
+      }
+      std::cout << i << "\t" << line.tag << "\t" << (line.valid ? "true" : "false") << "\t";
+      for (const auto &byte : line.data)
+      {
+        std::cout << std::hex << static_cast<int>(byte) << " ";
+      }
+      std::cout << std::dec << "\n";
+    }
+    if (invalid_cachelines > 0)
+      std::cout << "..." << "and " << invalid_cachelines << " invalid (empty) cachelines." << "\n";
+    else
+      std::cout << "CACHE_LAYER " << l << ": All cache lines are valid.\n";
+  }
+
+  // Helper function to set offset, (index), and tag values
+  void set_offset_index_tag(const uint64_t address, uint32_t *offset, uint32_t *index, uint64_t &tag)
+  {
+    const uint32_t offset_bits = __builtin_ctz(cacheline_size);
+    const uint32_t index_bits = __builtin_ctz(num_lines);
+
+    if (offset)
+    {
+      *offset = address & (cacheline_size - 1);
+      check_offset(*offset);
+    }
+
+    if (index)
+      *index = (address >> offset_bits) & (num_lines - 1);
+
+    tag = (mapping_strategy == DIRECT_MAPPED) ? address >> (offset_bits + index_bits) : address >> (offset_bits);
+  }
+
+  // Helper function to extract a word from a cacheline with the offset
+  uint32_t extract_word(const std::vector<uint8_t> &cacheline, const uint32_t offset)
+  {
+    return extract_word(cacheline.data(), offset);
+  }
+
+  uint32_t extract_word(const uint8_t *cacheline, const uint32_t offset)
+  {
+    check_offset(offset);
+
+    return (cacheline[offset + 3] << 24) |
+           (cacheline[offset + 2] << 16) |
+           (cacheline[offset + 1] << 8) |
+           cacheline[offset];
+  }
+
+  void check_offset(const uint32_t offset)
+  {
+    if (offset + 3 >= cacheline_size)
+    {
+      error = true;
+      if (!test_mode)
+        throw std::runtime_error("InvalidAddressException: Invalid offset for 4-byte access in check_offset");
+      return;
+    }
+  }
+
+  // Helper function for main cache module
+  const uint8_t get_cacheline_content(const uint32_t line_index, const uint32_t index)
+  {
+    if (line_index >= cache_memory.size())
+    {
+      error = true;
+      if (!test_mode)
+        throw std::runtime_error("Line index out of bounds in get_cacheline_content method.\n");
+      return 0; // Return 0 or some default value to avoid undefined behavior
+    }
+    if (index >= cache_memory[line_index].data.size())
+    {
+      error = true;
+      if (!test_mode)
+        throw std::runtime_error("Data index out of bounds in get_cacheline_content method.\n");
+      return 0; // Return 0 or some default value to avoid undefined behavior
+    }
+    return cache_memory[line_index].data[index];
+  }
+
+  // Helper function to write data to a cacheline with the offset
+  void write_data(std::vector<uint8_t> & cacheline, const uint32_t wdata_val, const uint32_t offset)
+  {
+    check_offset(offset);
+
+    cacheline[offset] = wdata_val & 0xFF;
+    cacheline[offset + 1] = (wdata_val >> 8) & 0xFF;
+    cacheline[offset + 2] = (wdata_val >> 16) & 0xFF;
+    cacheline[offset + 3] = (wdata_val >> 24) & 0xFF;
+  }
+
+  /**
+   * @brief Places the line of addr in the cache, replacing a line if needed, without touching its data.
+   *
+   * @return Index of the line in cache_memory, or num_lines if the mapping strategy is invalid
+   */
+  uint32_t allocate_line(uint64_t addr)
+  {
+    uint64_t tag;
+    uint32_t index = num_lines;
+
+    if (mapping_strategy == DIRECT_MAPPED)
+    { // Direct-mapped
+      set_offset_index_tag(addr, nullptr, &index, tag);
+      if (cache_memory[index].valid && cache_memory[index].tag != tag)
+        count_eviction(index);
+    }
+    else if (mapping_strategy == FULLY_ASSOCIATIVE)
+    { // Fully-associative
+      set_offset_index_tag(addr, nullptr, nullptr, tag);
+      if (size < num_lines) // if there is space in the cache
+      {
+        index = size++;
+      }
+      else // lru replacement
+      {
+        index = lru_list.back();
+        lru_list.pop_back();
+        lru_map.erase(cache_memory[index].tag);
+        count_eviction(0);
+      }
+      lru_list.push_front(index);
+      lru_map[tag] = lru_list.begin();
+    }
+    else
+    {
+      error = true;
+      if (!test_mode)
+        throw std::runtime_error("Invalid mapping_strategy in write_data_from_main_memory");
+      return index;
+    }
+
+    cache_memory[index].tag = tag;
+    cache_memory[index].valid = true;
+    if (miss_classifier.enabled)
+      miss_classifier.fill(addr >> __builtin_ctz(cacheline_size));
+    return index;
+  }
+
+  void count_eviction(uint32_t set)
+  {
+    evictions++;
+    if (conflict_profile.enabled)
+      conflict_profile.eviction(set);
+  }
+
+  // This function should be called from the main cache module to write retrieved data from main memory after miss
+  void write_cacheline(uint64_t addr, const std::vector<uint8_t> &mem_data)
+  {
+    write_cacheline(addr, mem_data.data());
+  }
+
+  // Same as above, line points to cacheline_size bytes, e.g. a part of a longer line of main memory
+  void write_cacheline(uint64_t addr, const uint8_t *line)
+  {
+    const uint32_t index = allocate_line(addr);
+    if (index < num_lines)
+      cache_memory[index].data.assign(line, line + cacheline_size);
+  }
+
+  // Approximate memory held by the layer in bytes: lines, their data and the LRU bookkeeping
+  size_t memory_bytes() const
+  {
+    size_t bytes = sizeof(*this) + cache_memory.capacity() * sizeof(CacheLine);
+    for (const CacheLine &line : cache_memory)
+      bytes += line.data.capacity();
+    bytes += lru_list.size() * (sizeof(uint32_t) + 2 * sizeof(void *));
+    bytes += lru_map.bucket_count() * sizeof(void *) +
+             lru_map.size() * (sizeof(uint64_t) + sizeof(std::list<uint32_t>::iterator) + sizeof(void *));
+    bytes += miss_classifier.memory_bytes() + conflict_profile.memory_bytes();
+    return bytes;
+  }
+
+  // For test purposes
+  void set_memory(const std::vector<CacheLine> &cache_memory, const std::list<uint32_t> &lru_list, std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map)
+  {
+    this->cache_memory = cache_memory;
+    this->lru_list = lru_list;
+    this->lru_map = lru_map;
+  }
+};
+
+#endif // CACHE_LAYER_CORE_HPP
@@ -0,0 +1,38 @@
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <systemc>
+#include <stdint.h>
+using namespace sc_core;
+
+// Period of the simulation clock, one cycle at CORE_FREQUENCY
+#define CLOCK_PERIOD 10, SC_NS
+
+// Cycle of the current simulation time. The clock rises at every multiple of CLOCK_PERIOD, starting at 0
+inline uint64_t current_cycle()
+{
+  return static_cast<uint64_t>(sc_time_stamp() / sc_time(CLOCK_PERIOD));
+}
+
+/*
+ * @brief Delay of a timed wakeup half a period before the rising edge of cycle.
+ *
+ * SC_METHODs that wait many cycles sleep with this delay instead of running on every edge, and then
+ * wait for the edge itself on their static clk.pos() sensitivity. A timed wakeup exactly on the edge
+ * would run one delta cycle earlier than the clk.pos() processes around it.
+ *
+ * @param cycle  Cycle, whose edge ends the wait
+ * @return       SC_ZERO_TIME if the edge is the next one, so the static sensitivity can be used directly
+ */
+inline sc_time delay_before_cycle(uint64_t cycle)
+{
+  const sc_time period(CLOCK_PERIOD);
+  const sc_time edge = period * static_cast<double>(cycle);
+  const sc_time now = sc_time_stamp();
+
+  if (edge <= now + period)
+    return SC_ZERO_TIME;
+  return edge - now - period / 2;
+}
+
+#endif // CLOCK_HPP
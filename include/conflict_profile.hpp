@@ -0,0 +1,144 @@
+#ifndef CONFLICT_PROFILE_HPP
+#define CONFLICT_PROFILE_HPP
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/*
+ * @brief Misses and evictions of a cache level per set, per line and per 4 KiB region.
+ *
+ * Shows where a level thrashes: a few sets with most of the misses point to an unlucky index function
+ * or to strides that are multiples of the level size, which padding the data or another mapping fixes.
+ * A fully associative level has a single set.
+ */
+class ConflictProfile
+{
+public:
+  static constexpr unsigned REGION_BITS = 12;
+
+  bool enabled = false;
+
+  void configure(uint32_t num_sets)
+  {
+    set_misses.assign(num_sets, 0);
+    set_evictions.assign(num_sets, 0);
+    reset();
+  }
+
+  void reset()
+  {
+    std::fill(set_misses.begin(), set_misses.end(), 0);
+    std::fill(set_evictions.begin(), set_evictions.end(), 0);
+    line_misses.clear();
+    region_misses.clear();
+  }
+
+  void miss(uint32_t set, uint64_t line_addr, uint64_t addr)
+  {
+    set_misses[set]++;
+    line_misses[line_addr]++;
+    region_misses[addr >> REGION_BITS]++;
+  }
+
+  void eviction(uint32_t set) { set_evictions[set]++; }
+
+  /*
+   * @brief Prints the set pressure histogram and the top sets, lines and regions by misses.
+   *
+   * @param name        Name of the level in the header, e.g. L1
+   * @param line_size   Size of a line, line addresses are printed as byte addresses
+   * @param top         Number of entries of every top list
+   */
+  void print(const char *name, uint32_t line_size, size_t top) const
+  {
+    uint64_t misses = 0, evictions = 0, max_misses = 0;
+    for (size_t i = 0; i < set_misses.size(); i++)
+    {
+      misses += set_misses[i];
+      evictions += set_evictions[i];
+      max_misses = std::max(max_misses, set_misses[i]);
+    }
+    const double mean = set_misses.empty() ? 0.0 : static_cast<double>(misses) / set_misses.size();
+
+    printf("\n\t\t======CONFLICT HOT SPOTS %s======\n\
+            \tSets: %zu\n\
+            \tMisses: %" PRIu64 "\n\
+            \tEvictions: %" PRIu64 "\n\
+            \tMisses of the worst set: %" PRIu64 " (%.1fx the mean)\n\n",
+           name, set_misses.size(), misses, evictions, max_misses, mean > 0 ? max_misses / mean : 0.0);
+
+    // sets by misses: 0, then [2^(b-1); 2^b) for bin b
+    std::vector<uint64_t> pressure(65, 0);
+    for (uint64_t set : set_misses)
+      pressure[set == 0 ? 0 : 64 - __builtin_clzll(set)]++;
+    unsigned last = pressure.size();
+    while (last > 0 && pressure[last - 1] == 0) last--;
+    printf("Set pressure:\n%22s %10s\n", "Misses", "Sets");
+    for (unsigned b = 0; b < last; b++)
+    {
+      char range[48];
+      if (b <= 1) snprintf(range, sizeof(range), "%u", b);
+      else snprintf(range, sizeof(range), "%" PRIu64 "-%" PRIu64, uint64_t(1) << (b - 1), (uint64_t(1) << b) - 1);
+      printf("%22s %10" PRIu64 "\n", range, pressure[b]);
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> sets;
+    for (size_t i = 0; i < set_misses.size(); i++)
+      if (set_misses[i]) sets.emplace_back(i, set_misses[i]);
+    sort_top(sets, top);
+    printf("\nTop sets:\n%10s %12s %12s\n", "Set", "Misses", "Evictions");
+    for (const auto &set : sets)
+      printf("%10" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n", set.first, set.second, set_evictions[set.first]);
+
+    std::vector<std::pair<uint64_t, uint64_t>> lines(line_misses.begin(), line_misses.end());
+    sort_top(lines, top);
+    printf("\nTop lines:\n%18s %12s\n", "Address", "Misses");
+    for (const auto &line : lines)
+      print_address(line.first * line_size, line.second);
+
+    std::vector<std::pair<uint64_t, uint64_t>> regions(region_misses.begin(), region_misses.end());
+    sort_top(regions, top);
+    printf("\nTop 4 KiB regions:\n%18s %12s\n", "Address", "Misses");
+    for (const auto &region : regions)
+      print_address(region.first << REGION_BITS, region.second);
+    printf("\n");
+  }
+
+  size_t memory_bytes() const
+  {
+    return (set_misses.capacity() + set_evictions.capacity()) * sizeof(uint64_t) +
+           (line_misses.bucket_count() + region_misses.bucket_count()) * sizeof(void *) +
+           (line_misses.size() + region_misses.size()) * (2 * sizeof(uint64_t) + sizeof(void *));
+  }
+
+  std::vector<uint64_t> set_misses, set_evictions;
+  std::unordered_map<uint64_t, uint64_t> line_misses;   // Misses per line address (address / line size)
+  std::unordered_map<uint64_t, uint64_t> region_misses; // Misses per 4 KiB region (address >> REGION_BITS)
+
+private:
+  static void print_address(uint64_t address, uint64_t misses)
+  {
+    char hex[24];
+    snprintf(hex, sizeof(hex), "0x%" PRIx64, address);
+    printf("%18s %12" PRIu64 "\n", hex, misses);
+  }
+
+  // Keeps the top entries by count, ties by key, in descending order
+  static void sort_top(std::vector<std::pair<uint64_t, uint64_t>> &entries, size_t top)
+  {
+    const size_t n = std::min(top, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                      [](const std::pair<uint64_t, uint64_t> &a, const std::pair<uint64_t, uint64_t> &b) {
+                        return a.second != b.second ? a.second > b.second : a.first < b.first;
+                      });
+    entries.resize(n);
+  }
+};
+
+#endif // CONFLICT_PROFILE_HPP
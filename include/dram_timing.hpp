@@ -0,0 +1,149 @@
+#ifndef DRAM_TIMING_HPP
+#define DRAM_TIMING_HPP
+
+#include "structs/default.h"
+#include "structs/options.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr uint8_t OPEN_PAGE = 0;
+constexpr uint8_t CLOSED_PAGE = 1;
+
+constexpr uint64_t NO_OPEN_ROW = UINT64_MAX;
+
+/*
+ * @brief Timing model of a banked DRAM with a row buffer per bank.
+ *
+ * Addresses are mapped as | row | rank | bank | channel | column |, so consecutive rows of a stream
+ * are spread over channels and banks, while accesses within one row hit the open row buffer.
+ *
+ * Open page policy keeps the row open after an access:
+ *   row hit      -> tCAS
+ *   bank closed  -> tRCD + tCAS
+ *   row conflict -> tRP + tRCD + tCAS
+ * Closed page policy precharges after every access, so every access costs tRCD + tCAS.
+ */
+class DramTiming
+{
+public:
+  enum AccessKind
+  {
+    ROW_HIT,
+    ROW_EMPTY,
+    ROW_CONFLICT
+  };
+
+  DramTiming() : DramTiming(default_options()) {}
+
+  explicit DramTiming(const DramOptions &options) : options(options)
+  {
+    if (options.channels == 0 || options.ranks == 0 || options.banks == 0 || options.rowSize == 0)
+      throw std::runtime_error("InvalidArgumentException: DRAM channels, ranks, banks and row size must be positive");
+    if (options.pagePolicy != OPEN_PAGE && options.pagePolicy != CLOSED_PAGE)
+      throw std::runtime_error("InvalidArgumentException: DRAM page policy must be 0 (open) or 1 (closed)");
+
+    // 64 bits, the product of the 32-bit options overflows
+    const uint64_t num_banks = static_cast<uint64_t>(options.channels) * options.ranks * options.banks;
+    if (num_banks > MAX_DRAM_BANKS)
+      throw std::runtime_error("InvalidArgumentException: DRAM has more than " + std::to_string(MAX_DRAM_BANKS) + " banks");
+    open_rows.assign(num_banks, NO_OPEN_ROW);
+  }
+
+  static DramOptions default_options()
+  {
+    DramOptions options;
+    options.channels = DRAM_CHANNELS;
+    options.ranks = DRAM_RANKS;
+    options.banks = DRAM_BANKS;
+    options.rowSize = DRAM_ROW_SIZE;
+    options.tRCD = DRAM_T_RCD;
+    options.tCAS = DRAM_T_CAS;
+    options.tRP = DRAM_T_RP;
+    options.pagePolicy = DRAM_PAGE_POLICY;
+    return options;
+  }
+
+  // Latency of an access to address in the current bank state. Doesn't change the state
+  uint32_t latency(uint64_t address) const
+  {
+    switch (classify(address))
+    {
+    case ROW_HIT:
+      return options.tCAS;
+    case ROW_EMPTY:
+      return options.tRCD + options.tCAS;
+    default:
+      return options.tRP + options.tRCD + options.tCAS;
+    }
+  }
+
+  // Performs the access: updates the row buffer of the bank and the statistics
+  void access(uint64_t address)
+  {
+    AccessKind kind = classify(address);
+    if (kind == ROW_HIT) row_hits++;
+    else if (kind == ROW_EMPTY) row_empty++;
+    else row_conflicts++;
+
+    uint64_t row;
+    uint32_t bank = locate(address, row);
+    open_rows[bank] = options.pagePolicy == OPEN_PAGE ? row : NO_OPEN_ROW;
+  }
+
+  // Closes all rows and clears the statistics
+  void reset()
+  {
+    std::fill(open_rows.begin(), open_rows.end(), NO_OPEN_ROW);
+    row_hits = row_empty = row_conflicts = 0;
+  }
+
+  uint64_t accesses() const { return row_hits + row_empty + row_conflicts; }
+
+  double row_hit_rate() const
+  {
+    return accesses() ? static_cast<double>(row_hits) / static_cast<double>(accesses()) : 0.0;
+  }
+
+  void print_statistics() const
+  {
+    std::cout << "\t\t======MAIN MEMORY (DRAM)======\n"
+              << "\t\tAccesses: " << accesses() << "\n"
+              << "\t\tRow hits: " << row_hits << "\n"
+              << "\t\tRow empty (activate): " << row_empty << "\n"
+              << "\t\tRow conflicts (precharge + activate): " << row_conflicts << "\n"
+              << "\t\tRow buffer hit rate: " << row_hit_rate() * 100.0 << "%\n\n";
+  }
+
+  uint64_t row_hits = 0, row_empty = 0, row_conflicts = 0;
+
+private:
+  AccessKind classify(uint64_t address) const
+  {
+    uint64_t row;
+    uint32_t bank = locate(address, row);
+    if (open_rows[bank] == NO_OPEN_ROW) return ROW_EMPTY;
+    return open_rows[bank] == row ? ROW_HIT : ROW_CONFLICT;
+  }
+
+  // Returns the global bank index of the address and stores its row
+  uint32_t locate(uint64_t address, uint64_t &row) const
+  {
+    uint64_t rest = address / options.rowSize;
+    const uint32_t channel = rest % options.channels;
+    rest /= options.channels;
+    const uint32_t bank = rest % options.banks;
+    rest /= options.banks;
+    const uint32_t rank = rest % options.ranks;
+    row = rest / options.ranks;
+    return (channel * options.ranks + rank) * options.banks + bank;
+  }
+
+  DramOptions options;
+  std::vector<uint64_t> open_rows; // Open row of each bank or NO_OPEN_ROW
+};
+
+#endif // DRAM_TIMING_HPP
@@ -0,0 +1,146 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include "spsc_ring.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Binary per-request log.
+ *
+ * File layout (little-endian, as written by the host):
+ *   header:  char magic[4] = "CSEL", uint32_t version, uint32_t record_size
+ *   records: RequestRecord[], one per completed request in request order
+ */
+constexpr char EVENT_LOG_MAGIC[4] = {'C', 'S', 'E', 'L'};
+constexpr uint32_t EVENT_LOG_VERSION = 2;
+
+constexpr uint8_t RECORD_READ = 0;
+constexpr uint8_t RECORD_WRITE = 1;
+constexpr uint8_t RECORD_FETCH = 2;
+
+struct RequestRecord
+{
+  uint64_t addr;      // Requested address
+  uint32_t index;     // Index of the request in the trace
+  uint32_t latency;   // Cycles from issuing the request until the cache was ready
+  uint16_t evictions; // Valid lines replaced in all cache levels while serving the request
+  uint8_t type;       // RECORD_READ, RECORD_WRITE or RECORD_FETCH
+  uint8_t level;      // Cache level that served the request (1 = L1, ...), 0 = main memory
+  uint32_t reserved;  // Always 0, pads the record to a multiple of 8 bytes
+};
+
+static_assert(sizeof(RequestRecord) == 24, "RequestRecord layout is part of the file format");
+
+// Thrown if the log file can't be created or written, a fault of the output and not of the simulated trace
+struct EventLogError : std::runtime_error
+{
+  using std::runtime_error::runtime_error;
+};
+
+/*
+ * @brief Writes RequestRecords to a file from a background thread.
+ *
+ * The simulation thread only copies a record into a lock-free ring. The writer thread drains the ring
+ * in batches and writes them with a single fwrite. If the ring is full, the simulation thread yields
+ * until the writer catches up, so no record is lost. A failed write is reported by close().
+ */
+class EventLog
+{
+public:
+  static constexpr size_t RING_CAPACITY = 1 << 16;
+  static constexpr size_t BATCH_SIZE = 4096;
+
+  explicit EventLog(const char *filename) : ring(RING_CAPACITY), filename(filename)
+  {
+    file = fopen(filename, "wb");
+    if (!file)
+      throw EventLogError(std::string("Could not open event log file ") + filename + ": " + std::strerror(errno));
+
+    const uint32_t record_size = sizeof(RequestRecord);
+    if (fwrite(EVENT_LOG_MAGIC, sizeof(EVENT_LOG_MAGIC), 1, file) != 1 ||
+        fwrite(&EVENT_LOG_VERSION, sizeof(EVENT_LOG_VERSION), 1, file) != 1 ||
+        fwrite(&record_size, sizeof(record_size), 1, file) != 1)
+    {
+      const int error = errno;
+      fclose(file);
+      throw EventLogError("Could not write event log file " + this->filename + ": " + std::strerror(error));
+    }
+
+    writer = std::thread(&EventLog::write_records, this);
+  }
+
+  // Closes the log if close() wasn't called, e.g. while an exception unwinds, without reporting errors
+  ~EventLog()
+  {
+    if (file) stop();
+  }
+
+  // Writes the remaining records and closes the file, throws if any write or closing the file failed
+  void close()
+  {
+    if (!file) return;
+    const int error = stop();
+    if (error != 0)
+      throw EventLogError("Could not write event log file " + filename + ": " + std::strerror(error));
+  }
+
+  EventLog(const EventLog &) = delete;
+  EventLog &operator=(const EventLog &) = delete;
+
+  // Called from the simulation thread once per completed request
+  void append(const RequestRecord &record)
+  {
+    while (!ring.try_push(record))
+      std::this_thread::yield();
+  }
+
+private:
+  // Stops the writer thread and closes the file. Returns the errno of the first failed write or of fclose, or 0
+  int stop()
+  {
+    finished.store(true, std::memory_order_release);
+    writer.join();
+    int error = write_error;
+    if (fclose(file) != 0 && error == 0)
+      error = errno;
+    file = nullptr;
+    return error;
+  }
+
+  void write_records()
+  {
+    std::vector<RequestRecord> batch(BATCH_SIZE);
+    while (true)
+    {
+      // Read the flag before draining, so records appended before finishing are never skipped
+      const bool done = finished.load(std::memory_order_acquire);
+      size_t n = ring.try_pop(batch.data(), batch.size());
+      if (n > 0)
+      {
+        // After a failed write the records are only drained, so that the simulation doesn't wait for the writer
+        if (write_error == 0 && fwrite(batch.data(), sizeof(RequestRecord), n, file) != n)
+          write_error = errno ? errno : EIO;
+        continue;
+      }
+      if (done) break;
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  SpscRing<RequestRecord> ring;
+  std::string filename;
+  FILE *file;
+  int write_error = 0; // errno of the first failed write, only accessed by the writer thread until it is joined
+  std::atomic<bool> finished{false};
+  std::thread writer;
+};
+
+#endif // EVENT_LOG_HPP
@@ -0,0 +1,200 @@
+#ifndef FUNCTIONAL_MODEL_HPP
+#define FUNCTIONAL_MODEL_HPP
+
+#include "bus.hpp"
+#include "cache_layer_core.hpp"
+#include "dram_timing.hpp"
+#include "simulator_config.hpp"
+#include "structs/request.h"
+#include "structs/result.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Cycles CACHE needs to accept a request and to signal ready, on top of the latencies
+constexpr uint32_t REQUEST_OVERHEAD = 2;
+
+// Outcome of simulating a request array with FunctionalHierarchy
+struct FunctionalRun
+{
+  Result result;
+  uint64_t requests;         // Requests completed before the end or the cycle limit
+  bool cycle_limit_reached;
+  uint64_t evictions;        // Valid lines replaced in all levels
+  double row_hit_rate;       // Row buffer hit rate of main memory
+};
+
+/*
+ * @brief Kernel-free model of the cache hierarchy, used to simulate many configurations in parallel.
+ *
+ * Follows the rules of CACHE: every level looks the address up, a read is served by the first level
+ * that hits and fills all levels if none does, a write goes through to main memory and fills the levels
+ * that missed. A fetch of a split L1 looks L1I up instead of L1 and is filled into L1I only, writes never
+ * touch L1I. Hits, misses and evictions therefore match the SystemC model. Cycles are computed from
+ * the level latencies, the DRAM timing and the links instead of clocked processes and are an estimate.
+ * The model keeps no data, so read values can't be checked.
+ */
+class FunctionalHierarchy
+{
+public:
+  explicit FunctionalHierarchy(const SimulatorConfig &config)
+      : bus(config.num_cache_levels, config.bus), dram(config.dram)
+  {
+    if (config.num_cache_levels < 1 || config.num_cache_levels > MAX_CACHE_LEVELS)
+      throw std::runtime_error("InvalidArgumentException: Number of Cache Levels must be in range [1;" +
+                               std::to_string(MAX_CACHE_LEVELS) + "]");
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+      if (config.mapping(i) != DIRECT_MAPPED && config.mapping(i) != FULLY_ASSOCIATIVE)
+        throw std::runtime_error("InvalidArgumentException: Mapping strategy is either 0 (Direct-mapped) or 1 (Fully-associative)");
+
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+    {
+      levels.emplace_back(config.latency[i], config.num_lines[i], config.line_size(i), config.mapping(i), i + 1);
+      line_sizes[i] = config.line_size(i);
+    }
+    if (config.split_l1)
+      l1i.emplace_back(config.l1i_latency, config.l1i_lines, config.line_size(0), config.mapping(0), 1);
+  }
+
+  /*
+   * @brief Simulates requests one after another, starting with empty caches and closed DRAM rows.
+   *
+   * @param requests     Requests to simulate, only read
+   * @param count        Number of requests
+   * @param cycle_limit  The run stops once this many cycles have passed, like the SystemC simulation
+   */
+  FunctionalRun run(const Request *requests, size_t count, uint32_t cycle_limit)
+  {
+    FunctionalRun run = {};
+    uint64_t now = 0;
+
+    for (CacheLayerCore &level : levels)
+      level.reset();
+    for (CacheLayerCore &level : l1i)
+      level.reset();
+    bus.reset();
+    dram.reset();
+
+    for (size_t i = 0; i < count; i++)
+    {
+      bool miss;
+      const uint64_t done = requests[i].w ? write(now, requests[i].addr, miss) : read(now, requests[i].addr, requests[i].fetch, miss);
+      if (done > cycle_limit)
+      {
+        run.cycle_limit_reached = true;
+        now = cycle_limit;
+        break;
+      }
+
+      now = done;
+      if (miss) run.result.misses++;
+      else run.result.hits++;
+      run.requests++;
+    }
+
+    run.result.cycles = static_cast<uint32_t>(now);
+    for (const CacheLayerCore &level : levels)
+      run.evictions += level.evictions;
+    for (const CacheLayerCore &level : l1i)
+      run.evictions += level.evictions;
+    run.row_hit_rate = dram.row_hit_rate();
+    return run;
+  }
+
+private:
+  // Level i of a request, L1I instead of L1 for a fetch of a split L1
+  CacheLayerCore &level(size_t i, bool fetch) { return i == 0 && fetch && !l1i.empty() ? l1i[0] : levels[i]; }
+
+  // Looks the address up in every level. Returns the index of the first level that hit, or -1
+  int lookup(uint64_t addr, bool fetch, bool hit[MAX_CACHE_LEVELS], uint32_t &slowest, uint32_t &hit_latency)
+  {
+    int first_hit = -1;
+    slowest = 0;
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+      uint32_t index, offset;
+      hit[i] = level(i, fetch).lookup(addr, index, offset);
+      slowest = std::max(slowest, level(i, fetch).latency);
+      if (hit[i] && first_hit < 0)
+      {
+        first_hit = static_cast<int>(i);
+        hit_latency = slowest; // CACHE waits for the levels in order, so the levels above the hit are waited for too
+      }
+    }
+    return first_hit;
+  }
+
+  // Records the lookups of the levels [0; reached), which the request reached because the levels above missed
+  void record(uint64_t addr, bool fetch, const bool hit[MAX_CACHE_LEVELS], size_t reached)
+  {
+    for (size_t i = 0; i < reached; i++)
+      level(i, fetch).record_lookup(addr, hit[i]);
+  }
+
+  // Returns the cycle a read that arrives at cycle now completes
+  uint64_t read(uint64_t now, uint64_t addr, bool fetch, bool &miss)
+  {
+    bool hit[MAX_CACHE_LEVELS];
+    uint32_t slowest, hit_latency = 0;
+    const int served = lookup(addr, fetch, hit, slowest, hit_latency);
+    record(addr, fetch, hit, served < 0 ? levels.size() : served + 1);
+    const uint32_t memory_latency = dram.latency(addr);
+    const uint64_t start = now + REQUEST_OVERHEAD;
+
+    miss = served < 0;
+    if (!miss)
+    {
+      // Main memory is stopped by the hit, unless it has already finished
+      if (memory_latency <= hit_latency)
+        dram.access(addr);
+      uint64_t done = start + hit_latency;
+      if (served > 0)
+        done = bus.transfer(done, served - 1, 0, sizeof(uint32_t), Link::WORD);
+      return done;
+    }
+
+    dram.access(addr);
+    const uint64_t done = bus.fill(start + std::max(slowest, memory_latency), 0, line_sizes);
+    for (size_t i = 0; i < levels.size(); i++)
+      level(i, fetch).allocate_line(addr);
+    return done;
+  }
+
+  // Returns the cycle a write that arrives at cycle now completes
+  uint64_t write(uint64_t now, uint64_t addr, bool &miss)
+  {
+    bool hit[MAX_CACHE_LEVELS];
+    uint32_t slowest, hit_latency = 0;
+    miss = lookup(addr, false, hit, slowest, hit_latency) < 0;
+    record(addr, false, hit, levels.size()); // a write goes through every level
+    const uint64_t start = now + REQUEST_OVERHEAD;
+
+    // write-through: the word is posted towards main memory without waiting for the links
+    bus.transfer(start + slowest, 0, levels.size() - 1, sizeof(uint32_t), Link::WRITEBACK);
+
+    uint64_t done = start + std::max(slowest, dram.latency(addr));
+    dram.access(addr);
+
+    // the line moves from main memory up to the highest level that missed
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+      if (hit[i]) continue;
+      done = bus.fill(done, i, line_sizes);
+      break;
+    }
+
+    for (size_t i = 0; i < levels.size(); i++)
+      if (!hit[i]) levels[i].allocate_line(addr);
+    return done;
+  }
+
+  std::vector<CacheLayerCore> levels;
+  std::vector<CacheLayerCore> l1i; // L1I of a split L1, empty if the L1 is unified
+  Bus bus;
+  DramTiming dram;
+  uint32_t line_sizes[MAX_CACHE_LEVELS];
+};
+
+#endif // FUNCTIONAL_MODEL_HPP
@@ -1,16 +1,19 @@
 #ifndef MAIN_MEMORY_HPP
 #define MAIN_MEMORY_HPP
 
+#include "clock.hpp"
+#include "dram_timing.hpp"
+#include "structs/debug.h"
+#include "profiler.hpp"
 #include <systemc>
+#include <inttypes.h>
 #include <map>
 using namespace sc_core;
 
-#define LATENCY 100
-
 SC_MODULE(MAIN_MEMORY) {
   sc_in<bool> clk;
 
-  sc_in<uint32_t> addr;
+  sc_in<uint64_t> addr;
   sc_in<uint32_t> wdata;
   sc_in<bool> r;
   sc_in<bool> w;
@@ -20,69 +23,135 @@ SC_MODULE(MAIN_MEMORY) {
   sc_out<bool> ready;
   sc_out<uint32_t> rdata;
 
-  std::map<uint32_t, uint8_t> memory;
+  std::map<uint64_t, uint8_t> memory;
+
+  // Latency of every access is given by the row buffer state of the addressed bank
+  DramTiming dram;
+
+  enum State {
+    IDLE,           // Samples r and w on every edge
+    READ_LATENCY,   // Waits on the edges for the end of the read latency
+    WRITE_LATENCY,  // Waits on the edges for the end of the write latency
+  };
+  State state = IDLE;
+  bool sleeping = false;           // Sleeps towards the last edge of the latency
+  uint64_t deadline = 0;           // Cycle, whose edge ends the latency of the current access
+  bool dont_set_ready = false;     // A write follows the read, only the write sets ready
+  std::vector<uint8_t> read_line;  // Line of the current read, put on the ports after the latency
 
   SC_CTOR(MAIN_MEMORY);
-  MAIN_MEMORY(sc_module_name name, uint32_t cacheline_size):sc_module(name),cacheline(cacheline_size){
-    SC_THREAD(behaviour);
+  MAIN_MEMORY(sc_module_name name, uint32_t cacheline_size):MAIN_MEMORY(name, cacheline_size, DramTiming::default_options()){}
+
+  MAIN_MEMORY(sc_module_name name, uint32_t cacheline_size, const DramOptions &dram_options):sc_module(name),cacheline(cacheline_size),dram(dram_options){
+    SC_METHOD(behaviour);
     sensitive << clk.pos();
+    dont_initialize();
   } 
 
+  // Clocked behaviour as a state machine. The DRAM latency costs a timed wakeup and its last edge instead of an activation per cycle
   void behaviour() {
-    while(true) {
-      wait();
-      DEBUG_PRINT("MAIN_MEM: Memory behaviour thread running...\n");
-      ready.write(false);
-      if (r.read()) {
-        DEBUG_PRINT("MAIN_MEM: Read request received for address: %u\n", addr.read());
-        doRead(w.read());
-      }
-      if (w.read()) {
-        DEBUG_PRINT("MAIN_MEM: Write request received for address: %u with data: %u\n", addr.read(), wdata.read());
-        doWrite();
-      }
+    process_counters().activations[PROFILE_MAIN_MEMORY]++;
+
+    if (sleeping) {
+      // Woken shortly before the last edge or by a stop, the edge decides
+      sleeping = false;
+      next_trigger();
+      return;
+    }
+    if (state != IDLE) {
+      wait_latency();
+      return;
+    }
+
+    LOG_TRACE("MAIN_MEM: Memory behaviour running...\n");
+    ready.write(false);
+    if (r.read()) {
+      LOG_TRACE("MAIN_MEM: Read request received for address: %" PRIu64 "\n", addr.read());
+      doRead(w.read());
+    }
+    else if (w.read()) {
+      LOG_TRACE("MAIN_MEM: Write request received for address: %" PRIu64 " with data: %u\n", addr.read(), wdata.read());
+      doWrite();
     }
   }
 
   void doRead(bool dontSetReady) {
     ready.write(false);
-    std::vector<uint8_t> result = getCacheLine(addr.read());
+    read_line = getCacheLine(addr.read());
     rdata.write(get(addr.read()));
+    dont_set_ready = dontSetReady;
 
-    DEBUG_PRINT("MAIN_MEM: Waiting for main memory to be ready...\n");
-    for(int i = 0; i < LATENCY; i++) {
-      if (stop.read()) {
-        DEBUG_PRINT("MAIN_MEM: Stopping waiting the latency due to stop signal.\n");
-        break;
-      }
-      wait();
-    }
+    LOG_TRACE("MAIN_MEM: Waiting for main memory to be ready...\n");
+    start_latency(READ_LATENCY);
+  }
+
+  void readDone() {
     for(int i=0;i<cacheline.size();i++){
-      cacheline[i].write(result[i]);
+      cacheline[i].write(read_line[i]);
     }
-    if(!dontSetReady) {
+    if(!dont_set_ready) {
       ready.write(true);
     }
+    if (w.read()) {
+      LOG_TRACE("MAIN_MEM: Write request received for address: %" PRIu64 " with data: %u\n", addr.read(), wdata.read());
+      doWrite();
+    }
   }
 
   void doWrite() {
     ready.write(false);
     set(addr.read(), wdata.read());
 
-    DEBUG_PRINT("MAIN_MEM: Waiting for main memory to be ready...\n");
-    for(int i = 0; i < LATENCY; i++) {
-      if (stop.read()) {
-        DEBUG_PRINT("MAIN_MEM: Stopping waiting the latency due to stop signal.\n");
-        break;
+    LOG_TRACE("MAIN_MEM: Waiting for main memory to be ready...\n");
+    start_latency(WRITE_LATENCY);
+  }
+
+  void writeDone() {
+    LOG_TRACE("MAIN_MEM: Setting ready to true.\n");
+    ready.write(true);
+  }
+
+  // Forgets all written data and closes all DRAM rows, the timing can be changed at the same time
+  void reset(const DramOptions &dram_options) {
+    memory.clear();
+    dram = DramTiming(dram_options);
+  }
+
+  // Starts waiting the DRAM latency of the current address
+  void start_latency(State latency_state) {
+    state = latency_state;
+    deadline = current_cycle() + dram.latency(addr.read());
+    wait_latency();
+  }
+
+  // Runs on every edge of the latency that the memory is awake for. The stop is checked on every edge but the last one
+  void wait_latency() {
+    bool completed = current_cycle() >= deadline;
+
+    if (!completed && !stop.read()) {
+      const sc_time delay = delay_before_cycle(deadline);
+      if (delay != SC_ZERO_TIME) {
+        next_trigger(delay, stop->posedge_event());
+        sleeping = true;
       }
-      wait();
+      return;
     }
-    DEBUG_PRINT("MAIN_MEM: Setting ready to true.\n");
-    ready.write(true);
-    wait(SC_ZERO_TIME);
+
+    if (completed) {
+      // Reads served by a cache level are stopped and never reach the DRAM banks
+      dram.access(addr.read());
+    }
+    else {
+      LOG_TRACE("MAIN_MEM: Stopping waiting the latency due to stop signal.\n");
+    }
+
+    const State finished = state;
+    state = IDLE;
+    if (finished == READ_LATENCY) readDone();
+    else writeDone();
   }
 
-  uint32_t get(uint32_t address) {
+  uint32_t get(uint64_t address) {
     uint32_t result = 0;
 
     for (int i = 0; i < 4; i++) {
@@ -104,10 +173,10 @@ SC_MODULE(MAIN_MEMORY) {
     }
   }
 
-  void set(uint32_t address, uint32_t value) {
+  void set(uint64_t address, uint32_t value) {
     for (int i = 0; i < 4; i++) {
       memory[address + i] = (value >> (i * 8)) & 0xFF;
-      if(address + i == UINT32_MAX) {
+      if(address + i == UINT64_MAX) {
         break;
       }
     }
@@ -119,8 +188,8 @@ SC_MODULE(MAIN_MEMORY) {
   }
 
   //get whole cache line wenn cache miss
-  std::vector<uint8_t> getCacheLine(uint32_t address){
-    uint32_t start = address & ~(cacheline.size() - 1);
+  std::vector<uint8_t> getCacheLine(uint64_t address){
+    uint64_t start = address & ~(uint64_t)(cacheline.size() - 1);
     std::vector<uint8_t> result(cacheline.size());
     for(int i=0;i<cacheline.size();i++){
       uint8_t value = 0;
@@ -0,0 +1,108 @@
+#ifndef MISS_CLASSIFIER_HPP
+#define MISS_CLASSIFIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+// Misses of a cache level by cause
+struct MissClasses
+{
+  uint64_t compulsory = 0; // First reference to the line
+  uint64_t capacity = 0;   // Also missed by a fully-associative LRU cache of the same size
+  uint64_t conflict = 0;   // Hit in the fully-associative cache, missed because of the mapping
+
+  uint64_t total() const { return compulsory + capacity + conflict; }
+};
+
+/*
+ * @brief Shadow of a cache level that sorts its misses into compulsory, capacity and conflict misses.
+ *
+ * The shadow is a fully-associative LRU cache with the same number of lines. It sees the same lookups and
+ * fills as the level, so both hold the same lines if the level is fully associative and every miss
+ * of such a level is either compulsory or capacity. Only the lookups of requests that reached the level,
+ * because every level above missed, are counted. Lines are identified by address / cacheline size.
+ */
+class MissClassifier
+{
+public:
+  bool enabled = false;
+
+  void configure(uint32_t num_lines)
+  {
+    this->num_lines = num_lines;
+    reset();
+  }
+
+  // Forgets all referenced lines and clears the counters
+  void reset()
+  {
+    seen.clear();
+    lru_list.clear();
+    lru_map.clear();
+    counts = MissClasses();
+  }
+
+  // Marks line as most recently used, like every lookup of the level does, even of a request served above it
+  void touch(uint64_t line)
+  {
+    auto it = lru_map.find(line);
+    if (it != lru_map.end())
+      lru_list.splice(lru_list.begin(), lru_list, it->second);
+  }
+
+  // Records a lookup of line that reached the level, hit is the outcome of the level itself
+  void lookup(uint64_t line, bool hit)
+  {
+    const bool first = seen.insert(line).second;
+    const bool shadow_hit = lru_map.count(line) > 0;
+
+    if (hit)
+      return;
+    if (first) counts.compulsory++;
+    else if (!shadow_hit) counts.capacity++;
+    else counts.conflict++;
+  }
+
+  // Records that line was placed in the level
+  void fill(uint64_t line)
+  {
+    auto it = lru_map.find(line);
+    if (it != lru_map.end())
+    {
+      lru_list.splice(lru_list.begin(), lru_list, it->second);
+      return;
+    }
+
+    lru_list.push_front(line);
+    lru_map[line] = lru_list.begin();
+    if (lru_list.size() > num_lines)
+    {
+      lru_map.erase(lru_list.back());
+      lru_list.pop_back();
+    }
+  }
+
+  const MissClasses &classes() const { return counts; }
+
+  // Approximate memory held by the shadow in bytes
+  size_t memory_bytes() const
+  {
+    return seen.bucket_count() * sizeof(void *) + seen.size() * (sizeof(uint64_t) + sizeof(void *)) +
+           lru_list.size() * (sizeof(uint64_t) + 2 * sizeof(void *)) +
+           lru_map.bucket_count() * sizeof(void *) +
+           lru_map.size() * (sizeof(uint64_t) + sizeof(std::list<uint64_t>::iterator) + sizeof(void *));
+  }
+
+private:
+  uint32_t num_lines = 0;
+  MissClasses counts;
+
+  std::unordered_set<uint64_t> seen;                                   // Every line referenced so far
+  std::list<uint64_t> lru_list;                                        // Lines of the shadow in LRU order (head: MRU, tail: LRU)
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator> lru_map; // Maps line to lru_list node
+};
+
+#endif // MISS_CLASSIFIER_HPP
@@ -1,48 +1,26 @@
 #ifndef MULTIPLEXER_HPP
 #define MULTIPLEXER_HPP
 
+#include "profiler.hpp"
 #include <systemc>
 #include <vector>
 #include <stdint.h>
 using namespace sc_core;
 
-SC_MODULE(MULTIPLEXER_BOOLEAN) {
-  std::vector<sc_in<bool>> in;
-  sc_in<uint8_t> select;
-
-  std::vector<sc_out<bool>> out;
-
-  SC_CTOR(MULTIPLEXER_BOOLEAN);
-  MULTIPLEXER_BOOLEAN(sc_module_name name, uint8_t fanIn, uint8_t fanOut) : sc_module(name), in(fanIn), out(fanOut) {
-    SC_THREAD(behaviour);
-    sensitive << select;
-
-    for(int i = 0; i < fanIn; i++) {
-      sensitive << in[i];
-    }
-  }
-
-  void behaviour() {
-    while(true) {
-      uint8_t selectValue = select.read();
-      bool selected = selectValue < in.size() ? in[selectValue].read() : 0;
-      for (size_t i = 0; i < out.size(); i++) {
-        out[i].write(selected);
-      }
-      wait();
-    }
-  }
-};
+// The multiplexers are combinational, so they are SC_METHODs: the routing runs on the stack of the kernel
+// whenever select or an input changes, without a coroutine and a context switch per multiplexer
 
-SC_MODULE(MULTIPLEXER_I32) {
-  std::vector<sc_in<uint32_t>> in;
+// Routes the selected one of fanIn inputs of type T to all fanOut outputs, a select out of range routes T()
+template <typename T>
+struct MULTIPLEXER : public sc_module {
+  std::vector<sc_in<T>> in;
   sc_in<uint8_t> select;
 
-  std::vector<sc_out<uint32_t>> out;
+  std::vector<sc_out<T>> out;
 
-  SC_CTOR(MULTIPLEXER_I32);
-  MULTIPLEXER_I32(sc_module_name name, uint8_t fanIn, uint8_t fanOut) : sc_module(name), in(fanIn), out(fanOut) {
-    SC_THREAD(behaviour);
+  SC_CTOR(MULTIPLEXER);
+  MULTIPLEXER(sc_module_name name, uint8_t fanIn, uint8_t fanOut) : sc_module(name), in(fanIn), out(fanOut) {
+    SC_METHOD(behaviour);
     sensitive << select;
 
     for(int i = 0; i < fanIn; i++) {
@@ -51,15 +29,18 @@ SC_MODULE(MULTIPLEXER_I32) {
   }
 
   void behaviour() {
-    while(true) {
-      uint8_t selectValue = select.read();
-      int32_t selected = selectValue < in.size() ? in[selectValue].read() : 0;
-      for (size_t i = 0; i < out.size(); i++) {
-        out[i].write(selected);
-      }
-      wait();
+    process_counters().activations[PROFILE_MULTIPLEXER]++;
+
+    uint8_t selectValue = select.read();
+    T selected = selectValue < in.size() ? in[selectValue].read() : T();
+    for (size_t i = 0; i < out.size(); i++) {
+      out[i].write(selected);
     }
   }
 };
 
-#endif // MULTIPLEXER_HPP
\ No newline at end of file
+using MULTIPLEXER_BOOLEAN = MULTIPLEXER<bool>;
+using MULTIPLEXER_I32 = MULTIPLEXER<uint32_t>;
+using MULTIPLEXER_I64 = MULTIPLEXER<uint64_t>;
+
+#endif // MULTIPLEXER_HPP
@@ -0,0 +1,15 @@
+#ifndef BATCH_PARSER_H
+#define BATCH_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../structs/options.h"
+
+CacheConfig* parse_batch_configs(const char* content, const CacheConfig* base, uint32_t* count);
+bool set_config_value(CacheConfig* config, const char* key, const char* value);
+bool validate_config(const CacheConfig* config);
+
+#endif // BATCH_PARSER_H
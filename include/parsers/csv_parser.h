@@ -6,16 +6,33 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include "../structs/request.h"
 #include "../structs/test.h"
 
-#define PARSE_ERROR ((char*)-1)
-#define VALUE_ERROR (uint32_t)(-1)
+/* Trace file read one line at a time, for traces too large to be held in memory */
+typedef struct {
+    FILE*                  file;
+    char*                  line;
+    size_t             capacity;
+    unsigned long    lineNumber;
+    bool           lineExpected;  /* The file is empty or ends with '\n', so another (empty) line follows */
+} CsvStream;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-char* split_next_line(const char* content, char* type, char* address, char* data);
-Request form_single_request(char* type, char* address, char* data, bool* ok);
 unsigned long count_requests(char* content);
 int form_requests(char* content, Request* requests);
-uint32_t validate_value(char* value);
+bool validate_value(char* value, uint32_t* data);
+bool validate_address(char* value, uint64_t* address);
+bool csv_stream_open(CsvStream* stream, const char* filename);
+int csv_stream_next(CsvStream* stream, Request* request);
+void csv_stream_close(CsvStream* stream);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // CSV_PARSER_H
\ No newline at end of file
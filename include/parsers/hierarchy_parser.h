@@ -0,0 +1,13 @@
+#ifndef HIERARCHY_PARSER_H
+#define HIERARCHY_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../structs/options.h"
+
+bool parse_hierarchy(const char* content, HierarchyOptions* hierarchy, uint32_t* cachelineSize, uint8_t* mappingStrategy);
+
+#endif // HIERARCHY_PARSER_H
@@ -6,11 +6,15 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #define INVALID_VALUE ((unsigned long)-1)
 
 bool parse_unsigned_int8(const char* arg, uint8_t* out8, const char* name);
 bool parse_unsigned_int32(const char* arg, uint32_t* out32, const char* name);
+bool parse_unsigned_int64(const char* arg, uint64_t* out64, const char* name);
+bool parse_unsigned_list(const char* arg, uint32_t* out32, uint32_t max, uint32_t* count, const char* name);
+bool parse_range(const char* arg, uint32_t* first, uint32_t* last, const char* name);
 unsigned long validate_value_decimal(const char* arg, const char* name);
 
 #endif // NUMERIC_PARSER_H
\ No newline at end of file
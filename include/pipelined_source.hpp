@@ -0,0 +1,126 @@
+#ifndef PIPELINED_SOURCE_HPP
+#define PIPELINED_SOURCE_HPP
+
+#include "spsc_ring.hpp"
+#include "workload.hpp"
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * @brief Reads another RequestSource on a parser thread, ahead of the simulation.
+ *
+ * The parser thread pushes requests in batches into a lock-free ring and next() pops them in batches,
+ * so parsing a trace overlaps simulating it and at most RING_CAPACITY parsed requests wait at any time.
+ * If the ring is full the parser yields, if it is empty the simulation thread yields. An exception of
+ * the inner source is rethrown by next() once the requests before it were consumed.
+ */
+class PipelinedSource : public RequestSource
+{
+public:
+  static constexpr size_t RING_CAPACITY = 1 << 16;
+  static constexpr size_t BATCH_SIZE = 1024;
+
+  explicit PipelinedSource(std::unique_ptr<RequestSource> source)
+      : source(std::move(source)), ring(RING_CAPACITY), batch(BATCH_SIZE)
+  {
+    parser = std::thread(&PipelinedSource::parse, this);
+  }
+
+  // Stops the parser early if the simulation didn't consume all requests, e.g. at the cycle limit
+  ~PipelinedSource() override
+  {
+    stopped.store(true, std::memory_order_release);
+    parser.join();
+  }
+
+  PipelinedSource(const PipelinedSource &) = delete;
+  PipelinedSource &operator=(const PipelinedSource &) = delete;
+
+  bool next(Request &request) override
+  {
+    if (position == filled && !refill())
+      return false;
+    request = batch[position++];
+    count++;
+    return true;
+  }
+
+  // Requests passed to the simulation so far, the total is only known once the stream has ended
+  uint64_t size() const override { return count; }
+
+private:
+  // Pops the next batch, waiting for the parser if the ring is empty. Returns false at the end of the stream
+  bool refill()
+  {
+    while (true)
+    {
+      // Read the flag before popping, so requests pushed before finishing are never skipped
+      const bool done = finished.load(std::memory_order_acquire);
+      filled = ring.try_pop(batch.data(), batch.size());
+      position = 0;
+      if (filled > 0)
+        return true;
+      if (done)
+      {
+        if (!error.empty())
+          throw std::runtime_error(error);
+        return false;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  void parse()
+  {
+    std::vector<Request> requests(BATCH_SIZE);
+    size_t n = 0;
+    try
+    {
+      bool more = true;
+      while (more && !stopped.load(std::memory_order_acquire))
+      {
+        while (n < requests.size() && (more = source->next(requests[n])))
+          n++;
+        push(requests.data(), n);
+        n = 0;
+      }
+    }
+    catch (const std::runtime_error &exception)
+    {
+      // the requests before the invalid one are still simulated
+      push(requests.data(), n);
+      error = exception.what();
+    }
+    finished.store(true, std::memory_order_release);
+  }
+
+  void push(const Request *requests, size_t n)
+  {
+    while (n > 0 && !stopped.load(std::memory_order_acquire))
+    {
+      const size_t pushed = ring.try_push(requests, n);
+      requests += pushed;
+      n -= pushed;
+      if (n > 0) std::this_thread::yield();
+    }
+  }
+
+  std::unique_ptr<RequestSource> source; // Only used by the parser thread
+  SpscRing<Request> ring;
+  std::string error;                     // Written by the parser before finished is set
+  std::atomic<bool> finished{false};
+  std::atomic<bool> stopped{false};
+  std::thread parser;
+
+  // Consumer side
+  std::vector<Request> batch;
+  size_t position = 0;
+  size_t filled = 0;
+  uint64_t count = 0;
+};
+
+#endif // PIPELINED_SOURCE_HPP
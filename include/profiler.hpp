@@ -0,0 +1,122 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+// Module types whose process activations are counted
+enum ProfiledModule
+{
+  PROFILE_CACHE,
+  PROFILE_CACHE_LAYER,
+  PROFILE_MAIN_MEMORY,
+  PROFILE_MULTIPLEXER,
+  NUM_PROFILED_MODULES
+};
+
+// Process activations since the start of the program, counted at the entry of every SC_METHOD. Always counted: an increment is negligible next to the activation it counts
+struct ProcessCounters
+{
+  uint64_t activations[NUM_PROFILED_MODULES];
+};
+
+inline ProcessCounters &process_counters()
+{
+  static ProcessCounters counters = {};
+  return counters;
+}
+
+enum ProfilePhase
+{
+  PHASE_PARSE,
+  PHASE_ELABORATE,
+  PHASE_SIMULATE,
+  PHASE_REPORT,
+  NUM_PROFILE_PHASES
+};
+
+/*
+ * @brief Collects host-side measurements of a single simulation and prints them as a summary table.
+ *
+ * Phases are timed with PhaseTimer, the kernel and process counters are filled in by the caller
+ * from the RunResult of the simulation.
+ */
+class Profiler
+{
+public:
+  void add(ProfilePhase phase, double seconds) { phase_seconds[phase] += seconds; }
+
+  void print() const
+  {
+    static const char *phase_names[NUM_PROFILE_PHASES] = {"Parse", "Elaborate", "Simulate", "Report"};
+    static const char *module_names[NUM_PROFILED_MODULES] = {"CACHE", "CACHE_LAYER", "MAIN_MEMORY", "MULTIPLEXER_*"};
+
+    double total = 0;
+    for (double seconds : phase_seconds)
+      total += seconds;
+
+    printf("\n\t\t======PROFILE======\n");
+    printf("\t\t%-14s %14s %8s\n", "Phase", "Wall time [ms]", "Share");
+    for (int i = 0; i < NUM_PROFILE_PHASES; i++)
+      printf("\t\t%-14s %14.3f %7.1f%%\n", phase_names[i], phase_seconds[i] * 1e3, total > 0 ? 100.0 * phase_seconds[i] / total : 0.0);
+    printf("\t\t%-14s %14.3f\n\n", "Total", total * 1e3);
+
+    printf("\t\t%-26s %14s %14s\n", "Counter", "Total", "Per request");
+    print_counter("sc_start calls", sc_starts);
+    print_counter("Delta cycles", delta_cycles);
+    for (int i = 0; i < NUM_PROFILED_MODULES; i++)
+      print_counter(std::string("Activations ") + module_names[i], activations[i]);
+    printf("\t\t%-26s %29.1f\n\n", "Host ns per request", requests ? phase_seconds[PHASE_SIMULATE] * 1e9 / requests : 0.0);
+
+    printf("\t\t%-26s %14s\n", "Memory", "KiB");
+    for (size_t i = 0; i < level_bytes.size(); i++)
+      printf("\t\tL%-25zu %14.1f\n", i + 1, level_bytes[i] / 1024.0);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("\t\t%-26s %14ld\n\n", "Peak RSS (process)", usage.ru_maxrss);
+  }
+
+  double phase_seconds[NUM_PROFILE_PHASES] = {0};
+
+  uint64_t requests = 0;
+  uint64_t sc_starts = 0;
+  uint64_t delta_cycles = 0;
+  uint64_t activations[NUM_PROFILED_MODULES] = {0};
+  std::vector<size_t> level_bytes; // Memory of every cache level at the end of the run, which is its peak
+
+private:
+  void print_counter(const std::string &name, uint64_t value) const
+  {
+    printf("\t\t%-26s %14llu %14.2f\n", name.c_str(), static_cast<unsigned long long>(value),
+           requests ? static_cast<double>(value) / requests : 0.0);
+  }
+};
+
+// Adds the wall time of its scope to a phase of profiler
+class PhaseTimer
+{
+public:
+  PhaseTimer(Profiler &profiler, ProfilePhase phase)
+      : profiler(profiler), phase(phase), start(std::chrono::steady_clock::now())
+  {
+  }
+
+  ~PhaseTimer()
+  {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    profiler.add(phase, elapsed.count());
+  }
+
+private:
+  Profiler &profiler;
+  ProfilePhase phase;
+  std::chrono::steady_clock::time_point start;
+};
+
+#endif // PROFILER_HPP
@@ -0,0 +1,78 @@
+#ifndef PROGRESS_HPP
+#define PROGRESS_HPP
+
+#include "structs/progress.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+/*
+ * @brief Sends ProgressRecords of a running simulation to a pipe, e.g. to the live view of cache_application.
+ *
+ * request() is called once per completed request and only reads the clock, a record is written every
+ * PROGRESS_PERIOD seconds. The last record is written by the destructor, so every way out of a run
+ * reports where it ended. If the reader went away, reporting stops and the simulation carries on.
+ */
+class ProgressReporter
+{
+public:
+  ProgressReporter(int fd, uint64_t total, uint32_t cycle_limit, uint32_t num_levels)
+      : fd(fd), start(std::chrono::steady_clock::now()), next_record(PROGRESS_PERIOD)
+  {
+    std::memset(&record, 0, sizeof(record));
+    record.total = total;
+    record.cycleLimit = cycle_limit;
+    record.numLevels = std::min<uint32_t>(num_levels, PROGRESS_MAX_LEVELS);
+  }
+
+  ~ProgressReporter()
+  {
+    record.finished = 1;
+    send();
+  }
+
+  ProgressReporter(const ProgressReporter &) = delete;
+  ProgressReporter &operator=(const ProgressReporter &) = delete;
+
+  // served_level is 1 for L1, ..., 0 for main memory
+  void request(uint8_t served_level, uint32_t cycles)
+  {
+    record.requests++;
+    record.cycles = cycles;
+    record.served[std::min<uint32_t>(served_level, PROGRESS_MAX_LEVELS)]++;
+    if (seconds() >= next_record)
+    {
+      send();
+      next_record = record.elapsedSeconds + PROGRESS_PERIOD;
+    }
+  }
+
+  // Cycles of a request still in flight, e.g. when the cycle limit stops the run
+  void cycles(uint32_t cycles) { record.cycles = cycles; }
+
+private:
+  double seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+  void send()
+  {
+    if (fd < 0)
+      return;
+    record.elapsedSeconds = seconds();
+    ssize_t written;
+    do
+      written = write(fd, &record, sizeof(record));
+    while (written < 0 && errno == EINTR);
+    if (written != static_cast<ssize_t>(sizeof(record)))
+      fd = -1;
+  }
+
+  int fd;
+  const std::chrono::steady_clock::time_point start;
+  double next_record;
+  ProgressRecord record;
+};
+
+#endif // PROGRESS_HPP
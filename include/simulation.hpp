@@ -3,11 +3,10 @@
 
 #include "structs/request.h"
 #include "structs/result.h"
+#include "structs/options.h"
+#include <stdbool.h>
 
 
-
-#define ENABLE_DEBUG
-
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -25,9 +24,23 @@ Result run_simulation (
     uint32_t     latencyCacheL3,
     uint8_t     mappingStrategy,
     uint32_t        numRequests,
-    Request*    requests
+    Request*    requests,
+    const SimulationOptions* options
 );
 
+/* Streams the requests of filename, or of options->workload if filename is NULL, through the trace analyzer.
+   Returns the exit code of the program */
+int run_analysis(const char* filename, uint32_t cachelineSize, const SimulationOptions* options);
+
+/* Returns true if name selects one of the synthetic workloads of workload.hpp */
+bool is_workload_name(const char* name);
+
+/* Returns the TraceFormat called name (auto, csv, jsonl, lackey or memtrace), or -1 for an unknown name */
+int trace_format_from_name(const char* name);
+
+/* Returns the TraceFormat of filename guessed from its first line, or -1 if the file can't be read */
+int trace_format_of_file(const char* filename);
+
 void print_simulation_results(Result result, uint32_t cycles, const char* tracefile,
                               uint8_t numCacheLevels, uint32_t cachelineSize,
                               uint32_t numLinesL1, uint32_t numLinesL2,
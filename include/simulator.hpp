@@ -0,0 +1,416 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include "cache.hpp"
+#include "event_log.hpp"
+#include "main_memory.hpp"
+#include "profiler.hpp"
+#include "progress.hpp"
+#include "simulator_config.hpp"
+#include "trace.hpp"
+#include "workload.hpp"
+#include "structs/default.h"
+#include "structs/options.h"
+#include "structs/result.h"
+#include <algorithm>
+#include <inttypes.h>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Settings of a single run
+struct RunOptions
+{
+  uint32_t cycle_limit = CYCLES;
+  bool check_reads = false;         // Compare read data with Request::data and stop at the first mismatch
+  bool print_caches = false;        // Print the cache contents after every checked request
+  const char *event_log = nullptr;  // Binary per-request log, nullptr disables logging
+  int progress_fd = -1;             // Descriptor that receives ProgressRecords while the run lasts, -1 disables them
+};
+
+enum class RunStatus
+{
+  FINISHED,
+  CYCLE_LIMIT,
+  READ_MISMATCH
+};
+
+struct RunResult
+{
+  Result result;
+  RunStatus status;
+  uint64_t requests; // Requests completed in this run
+
+  // Requests of the two halves of a split L1 and the ones of them that hit there, counted for a unified L1 too
+  uint64_t fetches, fetch_hits;
+  uint64_t data_requests, data_hits;
+
+  // Kernel work of this run, for profiling
+  uint64_t sc_starts;
+  uint64_t delta_cycles;
+  uint64_t activations[NUM_PROFILED_MODULES];
+};
+
+/*
+ * @brief Cache hierarchy and main memory, elaborated once and reused for many runs.
+ *
+ * SystemC can elaborate a design only once per process, so only one Simulator may exist per process.
+ * Between runs, reset() empties all levels and main memory and may change every parameter except
+ * the number of levels, their names and line sizes and whether the L1 is split, which are fixed by the
+ * elaborated ports.
+ * Without a reset, the next run starts with the warm caches of the previous one.
+ */
+class Simulator
+{
+public:
+  explicit Simulator(const SimulatorConfig &config, const char *tracefile = nullptr, const TraceOptions *trace_options = nullptr)
+      : config(config),
+        cache("cache", config.num_cache_levels, level_line_sizes(config).data(), config.num_lines, config.latency,
+              level_mappings(config).data(), config.bus, level_names(config), config.split_l1 ? config.l1i_lines : 0,
+              config.l1i_latency),
+        main_memory("main_memory", config.memory_line_size(), config.dram),
+        clk("clk", CLOCK_PERIOD),
+        mem_cacheline_sig(config.memory_line_size())
+  {
+    static bool elaborated = false;
+    if (elaborated)
+      throw std::runtime_error("Only one Simulator can exist per process");
+    elaborated = true;
+
+    cache.clk(clk);
+    cache.addr(addr);
+    cache.wdata(wdata);
+    cache.r(r);
+    cache.w(w);
+    cache.fetch(fetch);
+
+    cache.rdata(rdata);
+    cache.ready(ready);
+    cache.miss(miss);
+
+    main_memory.clk(clk);
+
+    main_memory.addr(mem_addr_sig);
+    cache.mem_addr(mem_addr_sig);
+    main_memory.wdata(mem_wdata_sig);
+    cache.mem_wdata(mem_wdata_sig);
+    main_memory.r(mem_r_sig);
+    cache.mem_r(mem_r_sig);
+    main_memory.w(mem_w_sig);
+    cache.mem_w(mem_w_sig);
+    main_memory.rdata(mem_rdata_sig);
+
+    for (uint32_t i = 0; i < config.memory_line_size(); i++)
+    {
+      main_memory.cacheline[i](mem_cacheline_sig[i]);
+      cache.mem_cacheline[i](mem_cacheline_sig[i]);
+    }
+
+    cache.mem_ready(mem_ready_sig);
+    main_memory.ready(mem_ready_sig);
+    main_memory.stop(stop);
+    cache.mem_stop(stop);
+
+    if (tracefile != nullptr)
+      register_trace(tracefile, trace_options);
+    enable_recorders();
+  }
+
+  Simulator(const Simulator &) = delete;
+  Simulator &operator=(const Simulator &) = delete;
+
+  // Empties all levels and main memory and clears all statistics
+  void reset()
+  {
+    reset(config);
+  }
+
+  // Same as reset(), but the parameters are taken from new_config
+  void reset(const SimulatorConfig &new_config)
+  {
+    if (new_config.num_cache_levels != config.num_cache_levels || level_line_sizes(new_config) != level_line_sizes(config))
+      throw std::runtime_error("InvalidArgumentException: The number of levels and the cacheline size can't change after elaboration");
+    if (new_config.split_l1 != config.split_l1)
+      throw std::runtime_error("InvalidArgumentException: A split L1 can't be unified after elaboration or the other way round");
+
+    // the levels keep the names they were elaborated with
+    std::string names[MAX_CACHE_LEVELS];
+    std::copy(config.names, config.names + MAX_CACHE_LEVELS, names);
+    config = new_config;
+    std::copy(names, names + MAX_CACHE_LEVELS, config.names);
+    cache.configure(config.num_lines, config.latency, level_mappings(config).data(), config.bus, config.l1i_lines, config.l1i_latency);
+    main_memory.reset(config.dram);
+    enable_recorders();
+  }
+
+  const SimulatorConfig &get_config() const { return config; }
+
+  // Simulates all requests of source, one after another
+  RunResult run(RequestSource &source, const RunOptions &options)
+  {
+    RunResult run_result;
+    Result &result = run_result.result;
+    result.cycles = 0;
+    result.hits = 0;
+    result.misses = 0;
+    run_result.status = RunStatus::FINISHED;
+    run_result.requests = 0;
+    run_result.fetches = run_result.fetch_hits = 0;
+    run_result.data_requests = run_result.data_hits = 0;
+    run_result.sc_starts = 0;
+
+    const uint64_t deltas_before = sc_delta_count();
+    const ProcessCounters counters_before = process_counters();
+
+    std::unique_ptr<EventLog> event_log;
+    if (options.event_log != nullptr)
+      event_log.reset(new EventLog(options.event_log));
+
+    // size() is still 0 for streamed inputs, whose length isn't known up front
+    std::unique_ptr<ProgressReporter> progress;
+    if (options.progress_fd >= 0)
+      progress.reset(new ProgressReporter(options.progress_fd, source.size(), options.cycle_limit, config.num_cache_levels));
+
+    Request request;
+    for (size_t request_index = 0; source.next(request); request_index++)
+    {
+      const uint32_t request_start = result.cycles;
+      const uint32_t evictions_before = event_log ? cache.total_evictions() : 0;
+
+      LOG_DEBUG("SIMULATION: Request %zu: type=%s, addr = 0x%08" PRIX64 ", data=0x%08X\n", request_index + 1,
+                  request.w ? "W" : request.fetch ? "I" : "R",
+                  request.addr,
+                  request.data);
+
+      addr.write(request.addr);
+      wdata.write(request.data);
+      r.write(!request.w);
+      w.write(request.w);
+      fetch.write(request.fetch && !request.w);
+
+      do
+      {
+        LOG_DEBUG("Clock %u: \n", result.cycles);
+
+        if (result.cycles >= options.cycle_limit)
+        {
+          run_result.status = RunStatus::CYCLE_LIMIT;
+          if (progress) progress->cycles(result.cycles);
+          drain();
+          count_kernel_work(run_result, deltas_before, counters_before);
+          if (event_log) event_log->close();
+          return run_result;
+        }
+        if (trace) trace->update(request_index, result.cycles);
+        result.cycles++;
+
+        sc_start(CLOCK_PERIOD);
+        run_result.sc_starts++;
+
+      } while (!ready.read());
+
+      LOG_DEBUG("SIMULATION: Read data: %u\n", cache.rdata.read());
+      if (options.check_reads)
+      {
+        if (options.print_caches) cache.print_caches();
+        // fetches carry no data to compare with
+        if (!request.w && !request.fetch && request.data != cache.rdata.read())
+        {
+          std::cerr << "\t\tError: Read data does not match expected data!\n";
+          printf("\t\tExpected data: %u, Read data: %u on Request %zu: type=%s, addr = 0x%08" PRIX64 ", data=0x%08X\n", request.data, cache.rdata.read(), request_index + 1,
+                 request.w ? "W" : "R",
+                 request.addr,
+                 request.data);
+          run_result.status = RunStatus::READ_MISMATCH;
+          count_kernel_work(run_result, deltas_before, counters_before);
+          if (event_log) event_log->close();
+          return run_result;
+        }
+      }
+      if (miss.read()) result.misses++;
+      else result.hits++;
+      run_result.requests++;
+      if (request.fetch && !request.w)
+      {
+        run_result.fetches++;
+        run_result.fetch_hits += cache.served_level == 1;
+      }
+      else
+      {
+        run_result.data_requests++;
+        run_result.data_hits += cache.served_level == 1;
+      }
+      if (progress) progress->request(cache.served_level, result.cycles);
+
+      if (event_log)
+      {
+        RequestRecord record;
+        record.index = request_index;
+        record.addr = request.addr;
+        record.latency = result.cycles - request_start;
+        record.evictions = cache.total_evictions() - evictions_before;
+        record.type = request.w ? RECORD_WRITE : request.fetch ? RECORD_FETCH : RECORD_READ;
+        record.level = cache.served_level;
+        record.reserved = 0;
+        event_log->append(record);
+      }
+    }
+
+    count_kernel_work(run_result, deltas_before, counters_before);
+    if (event_log) event_log->close(); // throws EventLogError if the log couldn't be written
+    return run_result;
+  }
+
+  // Memory held by every cache level in bytes
+  std::vector<size_t> level_memory() const
+  {
+    std::vector<size_t> bytes;
+    for (const auto &level : cache.L)
+      bytes.push_back(level->memory_bytes());
+    return bytes;
+  }
+
+  // Misses of every cache level by cause since the last reset, all zero unless classify_misses is set
+  std::vector<MissClasses> miss_classes() const
+  {
+    std::vector<MissClasses> classes;
+    for (const auto &level : cache.L)
+      classes.push_back(level->miss_classifier.classes());
+    return classes;
+  }
+
+  // Prints the conflict hot spots of every level since the last reset, with top entries per list
+  void print_conflict_profiles(size_t top) const
+  {
+    for (size_t i = 0; i < cache.L.size(); i++)
+      cache.L[i]->conflict_profile.print(config.level_name(i).c_str(), config.line_size(i), top);
+  }
+
+  // Prints the DRAM and link statistics of the last run
+  void print_statistics(uint32_t cycles) const
+  {
+    main_memory.dram.print_statistics();
+    cache.bus.print_statistics(cycles, level_names(config));
+  }
+
+private:
+  static std::vector<std::string> level_names(const SimulatorConfig &config)
+  {
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+      names.push_back(config.level_name(i));
+    return names;
+  }
+
+  static std::vector<uint32_t> level_line_sizes(const SimulatorConfig &config)
+  {
+    std::vector<uint32_t> line_sizes;
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+      line_sizes.push_back(config.line_size(i));
+    return line_sizes;
+  }
+
+  static std::vector<uint8_t> level_mappings(const SimulatorConfig &config)
+  {
+    std::vector<uint8_t> mappings;
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+      mappings.push_back(config.mapping(i));
+    return mappings;
+  }
+
+  void count_kernel_work(RunResult &run_result, uint64_t deltas_before, const ProcessCounters &counters_before)
+  {
+    run_result.delta_cycles = sc_delta_count() - deltas_before;
+    for (int i = 0; i < NUM_PROFILED_MODULES; i++)
+      run_result.activations[i] = process_counters().activations[i] - counters_before.activations[i];
+  }
+
+  // The miss causes and conflicts are reported per level, L1I has none of them recorded
+  void enable_recorders()
+  {
+    for (auto &level : cache.L)
+    {
+      level->miss_classifier.enabled = config.classify_misses;
+      level->conflict_profile.enabled = config.profile_conflicts;
+    }
+  }
+
+  // Finishes the interrupted request without counting it, so that the next run starts with idle modules
+  void drain()
+  {
+    while (!ready.read())
+      sc_start(CLOCK_PERIOD);
+  }
+
+  void register_trace(const char *tracefile, const TraceOptions *trace_options)
+  {
+    TraceOptions whole_run = {0, UINT32_MAX, 0, UINT32_MAX, NULL};
+    trace.reset(new TraceWindow(tracefile, trace_options ? *trace_options : whole_run));
+    trace->add(clk, "clk");
+    trace->add(addr, "addr");
+    trace->add(wdata, "wdata");
+    trace->add(r, "r");
+    trace->add(w, "w");
+    trace->add(rdata, "rdata");
+    trace->add(ready, "ready");
+    trace->add(miss, "miss");
+
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+    {
+      const std::string level = config.level_name(i);
+      trace->add(cache.addr_mux_out[i], level + ".addr");
+      trace->add(cache.wdata_mux_out[i], level + ".wdata");
+      trace->add(i == 0 && cache.L1I ? cache.l1d_r : cache.r_mux_out[i], level + ".r");
+      trace->add(cache.w_mux_out[i], level + ".w");
+      trace->add(cache.cache_miss_in[i], level + ".miss");
+      trace->add(cache.cache_ready_in[i], level + ".ready");
+      trace->add(cache.cache_data_in[i], level + ".data");
+    }
+
+    if (cache.L1I)
+    {
+      trace->add(cache.addr_mux_in, "L1I.addr");
+      trace->add(cache.l1i_r, "L1I.r");
+      trace->add(cache.l1i_miss, "L1I.miss");
+      trace->add(cache.l1i_ready, "L1I.ready");
+      trace->add(cache.l1i_data, "L1I.data");
+    }
+
+    trace->add(mem_addr_sig, "mem.addr");
+    trace->add(mem_wdata_sig, "mem.wdata");
+    trace->add(mem_r_sig, "mem.r");
+    trace->add(mem_w_sig, "mem.w");
+    trace->add(mem_ready_sig, "mem.ready");
+    trace->add(stop, "mem.stop");
+    trace->add(mem_rdata_sig, "mem.rdata");
+
+    for (const auto &name : trace->unknown_signals())
+      std::cerr << "Unknown trace signal: " << name << "\n";
+  }
+
+  SimulatorConfig config;
+
+public:
+  CACHE cache;
+  MAIN_MEMORY main_memory;
+
+private:
+  sc_clock clk;
+
+  sc_signal<uint64_t> addr;
+  sc_signal<uint32_t> wdata;
+  sc_signal<bool> r, w, fetch, stop;
+
+  sc_signal<uint32_t> rdata;
+  sc_signal<bool> ready, miss;
+
+  sc_signal<uint64_t> mem_addr_sig;
+  sc_signal<uint32_t> mem_wdata_sig, mem_rdata_sig;
+  std::vector<sc_signal<uint8_t>> mem_cacheline_sig;
+  sc_signal<bool> mem_r_sig, mem_w_sig, mem_ready_sig;
+
+  std::unique_ptr<TraceWindow> trace;
+};
+
+#endif // SIMULATOR_HPP
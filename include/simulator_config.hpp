@@ -0,0 +1,66 @@
+#ifndef SIMULATOR_CONFIG_HPP
+#define SIMULATOR_CONFIG_HPP
+
+#include "bus.hpp"
+#include "dram_timing.hpp"
+#include "structs/default.h"
+#include "structs/options.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Mapping of a level that follows SimulatorConfig::mapping_strategy
+constexpr uint8_t INHERITED_MAPPING = 0xFF;
+
+// Complete configuration of a simulated hierarchy
+struct SimulatorConfig
+{
+  // Structure: fixed for the lifetime of a Simulator
+  uint8_t num_cache_levels = NUM_CACHE_LEVELS;
+  uint32_t cacheline_size = CACHE_LINE_SIZE;
+  uint32_t line_sizes[MAX_CACHE_LEVELS] = {}; // Line size of every level, 0 takes cacheline_size
+  std::string names[MAX_CACHE_LEVELS];        // Level names of a hierarchy file, empty for L1, L2, ...
+  bool split_l1 = false;                      // L1I beside the first level, which then only serves data
+
+  // Parameters: can be changed with Simulator::reset. Only the first num_cache_levels entries are used
+  uint32_t num_lines[MAX_CACHE_LEVELS] = {NUM_LINES_L1, NUM_LINES_L2, NUM_LINES_L3};
+  uint32_t latency[MAX_CACHE_LEVELS] = {LATENCY_CACHE_L1, LATENCY_CACHE_L2, LATENCY_CACHE_L3};
+  uint8_t mapping_strategy = MAPPING_STRATEGY;
+  uint8_t mappings[MAX_CACHE_LEVELS]; // Mapping of every level, INHERITED_MAPPING takes mapping_strategy
+  uint32_t l1i_lines = NUM_LINES_L1;  // L1I of a split L1, with the line size and mapping of the first level
+  uint32_t l1i_latency = LATENCY_CACHE_L1;
+  DramOptions dram = DramTiming::default_options();
+  BusOptions bus = Bus::default_options();
+  bool classify_misses = false;   // Sort the misses of every level into compulsory, capacity and conflict misses
+  bool profile_conflicts = false; // Count the misses and evictions of every level per set, line and 4 KiB region
+
+  SimulatorConfig() { std::fill(mappings, mappings + MAX_CACHE_LEVELS, INHERITED_MAPPING); }
+
+  std::string level_name(uint32_t level) const
+  {
+    if (!names[level].empty()) return names[level];
+    return level == 0 && split_l1 ? "L1D" : "L" + std::to_string(level + 1);
+  }
+  uint32_t line_size(uint32_t level) const { return line_sizes[level] ? line_sizes[level] : cacheline_size; }
+  uint8_t mapping(uint32_t level) const { return mappings[level] == INHERITED_MAPPING ? mapping_strategy : mappings[level]; }
+
+  // Main memory transfers the longest line of all levels, so that the line of every level is a part of it
+  uint32_t memory_line_size() const
+  {
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < num_cache_levels; i++)
+      size = std::max(size, line_size(i));
+    return size;
+  }
+
+  // Shortest line of all levels, an L1I has the line of the first level
+  uint32_t shortest_line_size() const
+  {
+    uint32_t size = UINT32_MAX;
+    for (uint32_t i = 0; i < num_cache_levels; i++)
+      size = std::min(size, line_size(i));
+    return size;
+  }
+};
+
+#endif // SIMULATOR_CONFIG_HPP
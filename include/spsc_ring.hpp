@@ -0,0 +1,107 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+ * @brief Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * The capacity is rounded up to a power of 2, so positions can be wrapped with a mask.
+ * head is only written by the producer and tail only by the consumer. Each side keeps a cached copy
+ * of the other side's index and reloads it only when the ring looks full (or empty).
+ */
+template <typename T>
+class SpscRing
+{
+public:
+  explicit SpscRing(size_t capacity)
+      : mask(round_up_to_power_of_two(capacity) - 1), buffer(mask + 1)
+  {
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+  // Producer side. Returns false if the ring is full
+  bool try_push(const T &value)
+  {
+    const size_t position = head.load(std::memory_order_relaxed);
+    if (position - cached_tail > mask)
+    {
+      cached_tail = tail.load(std::memory_order_acquire);
+      if (position - cached_tail > mask) return false;
+    }
+    buffer[position & mask] = value;
+    head.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer side. Pushes as many values as fit and returns their number
+  size_t try_push(const T *values, size_t count)
+  {
+    const size_t position = head.load(std::memory_order_relaxed);
+    size_t free_slots = capacity() - (position - cached_tail);
+    if (free_slots < count)
+    {
+      cached_tail = tail.load(std::memory_order_acquire);
+      free_slots = capacity() - (position - cached_tail);
+    }
+    const size_t n = std::min(free_slots, count);
+    for (size_t i = 0; i < n; i++)
+      buffer[(position + i) & mask] = values[i];
+    head.store(position + n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer side. Returns false if the ring is empty
+  bool try_pop(T &value)
+  {
+    return try_pop(&value, 1) == 1;
+  }
+
+  // Consumer side. Pops up to count values and returns their number
+  size_t try_pop(T *values, size_t count)
+  {
+    const size_t position = tail.load(std::memory_order_relaxed);
+    if (cached_head == position)
+    {
+      cached_head = head.load(std::memory_order_acquire);
+      if (cached_head == position) return 0;
+    }
+    const size_t n = std::min(cached_head - position, count);
+    for (size_t i = 0; i < n; i++)
+      values[i] = buffer[(position + i) & mask];
+    tail.store(position + n, std::memory_order_release);
+    return n;
+  }
+
+  // May be called from either side, the answer can be stale immediately
+  bool empty() const
+  {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+
+private:
+  static size_t round_up_to_power_of_two(size_t value)
+  {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  const size_t mask;
+  std::vector<T> buffer;
+
+  // Producer and consumer indexes are padded onto separate cache lines to avoid false sharing
+  char padding_front[64];
+  std::atomic<size_t> head{0};
+  size_t cached_tail = 0;
+  char padding_middle[64];
+  std::atomic<size_t> tail{0};
+  size_t cached_head = 0;
+  char padding_back[64];
+};
+
+#endif // SPSC_RING_HPP
@@ -3,18 +3,118 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-#ifdef ENABLE_DEBUG
-
+/* Debug flag: print the requests and the cache contents after every request */
 extern bool debug;
 
-#define DEBUG_PRINT(fmt, ...) \
-    do { if (debug) fprintf(stderr, fmt, ##__VA_ARGS__); } while (0)
+/*
+ * Leveled logging into per-thread binary ring buffers.
+ *
+ * Events above the build-time LOG_LEVEL are compiled out completely, e.g. `make LOG_LEVEL=5` compiles in
+ * every event, the default only warnings and errors. Enabled events are recorded only while a log file is
+ * open (--log-file): the format string and the raw arguments are stored in a ring of the calling thread,
+ * nothing is formatted. When the program exits, the rings are written to the log file, which is decoded
+ * offline with util/decode_log.py. Once a ring is full, the oldest events are overwritten.
+ *
+ * %s arguments have to point to string literals or other strings that live until the program exits.
+ */
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+#define LOG_LEVEL_TRACE   5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+/* Most arguments a single event can carry */
+#define LOG_MAX_ARGS 8
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern bool logEnabled;
+
+bool log_open(const char* filename);
+void log_record(uint8_t level, const char* format, uint8_t numArgs, const uint64_t* args);
+void log_printf(uint8_t level, const char* format, ...);
+
+#ifdef __cplusplus
+}
+
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, uint64_t>::type log_arg(T value)
+{
+    /* Signed values are sign-extended, so the decoder can print them with their original width */
+    return static_cast<uint64_t>(static_cast<int64_t>(value));
+}
+
+inline uint64_t log_arg(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline uint64_t log_arg(const void* pointer)
+{
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+/* Captures the arguments without looking at the format string */
+template <typename... Args>
+inline void log_event(uint8_t level, const char* format, Args... args)
+{
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many arguments for a log event");
+    if (!logEnabled) return;
+    const uint64_t values[sizeof...(Args) + 1] = {log_arg(args)...};
+    log_record(level, format, sizeof...(Args), values);
+}
 
+#define LOG_EVENT(level, ...) log_event(level, __VA_ARGS__)
+
+#else
+
+/* C callers are not on hot paths, the arguments are converted by reading the format string */
+#define LOG_EVENT(level, ...) do { if (logEnabled) log_printf(level, __VA_ARGS__); } while (0)
+
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_EVENT(LOG_LEVEL_ERROR, __VA_ARGS__)
 #else
+#define LOG_ERROR(...) ((void)0)
+#endif
 
-#define DEBUG_PRINT(...) ((void)0)
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_EVENT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
 
-#endif // ENABLE_DEBUG
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_EVENT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_EVENT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_TRACE
+#define LOG_TRACE(...) LOG_EVENT(LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
 
-#endif // DEBUG_H
\ No newline at end of file
+#endif // DEBUG_H
@@ -13,6 +13,21 @@ enum DefaultSimulationValues {
     LATENCY_CACHE_L2 = 16       ,
     LATENCY_CACHE_L3 = 32       ,
     MAPPING_STRATEGY = 1        ,
+    DRAM_CHANNELS    = 1        ,
+    DRAM_RANKS       = 1        ,
+    DRAM_BANKS       = 8        ,
+    DRAM_ROW_SIZE    = 2048     ,
+    DRAM_T_RCD       = 40       ,
+    DRAM_T_CAS       = 40       ,
+    DRAM_T_RP        = 40       ,
+    DRAM_PAGE_POLICY = 0        ,
+    BUS_WIDTH        = 32       ,
+    BUS_FREQUENCY    = 100      ,
+    CORE_FREQUENCY   = 100      , /* MHz, fixed by the 10 ns simulation clock */
+    WORKLOAD_SEED    = 1        ,
+    ANALYZE_WINDOW   = 1000000  , /* Requests per working set window of --analyze */
+    TUNE_LATENCY_BASE         = 1 , /* Cycles of a 1 KiB level in --tune */
+    TUNE_LATENCY_PER_DOUBLING = 2 , /* Cycles per doubling of the level size in --tune */
 };
 
 #endif // DEFAULT_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Maximum number of per-link bus values that can be given */
+#define MAX_BUS_LINKS 8
+
+/* Deepest hierarchy a configuration has room for. CACHE itself builds any number of levels */
+#define MAX_CACHE_LEVELS 16
+
+/* Most DRAM banks of all channels and ranks together, the model keeps an open row for every bank */
+#define MAX_DRAM_BANKS (1u << 20)
+
+/* Size of a level name, including the terminating zero */
+#define LEVEL_NAME_SIZE 16
+
+/* Window and signal selection for the VCD trace. Windows are half-open: [first; last) */
+typedef struct {
+    uint32_t    firstRequest;
+    uint32_t    lastRequest;
+    uint32_t    firstCycle;
+    uint32_t      lastCycle;
+    const char*     signals;    /* Comma separated signal names, NULL for the default set */
+} TraceOptions;
+
+/* Main memory organization and timing. Timings are given in cycles */
+typedef struct {
+    uint32_t       channels;
+    uint32_t          ranks;
+    uint32_t          banks;
+    uint32_t        rowSize;    /* Bytes per row of a single bank */
+    uint32_t           tRCD;    /* Row activation to column access */
+    uint32_t           tCAS;    /* Column access to data */
+    uint32_t            tRP;    /* Row precharge */
+    uint8_t      pagePolicy;    /* 0 = open page, 1 = closed page */
+} DramOptions;
+
+/* Buses between cache levels. Link 0 connects L1 and L2, the last link connects the last level and main memory.
+   If fewer values than links are given, the last value applies to all remaining links */
+typedef struct {
+    uint32_t      numWidths;
+    uint32_t      width[MAX_BUS_LINKS];        /* Bytes per bus beat */
+    uint32_t numFrequencies;
+    uint32_t  frequency[MAX_BUS_LINKS];        /* Bus clock in MHz */
+} BusOptions;
+
+/* Synthetic workload generated in-process instead of reading a trace file. Zero selects the workload's default */
+typedef struct {
+    const char*        name;    /* matmul, matmul-blocked, stencil, copy, strided, random, zipf, pointer-chase. NULL reads the trace file */
+    uint64_t       requests;    /* Number of requests, 0 for one pass over the data */
+    uint64_t           seed;    /* Seed of random workloads */
+    uint32_t           size;    /* Matrix/grid dimension, or number of words/nodes */
+    uint32_t         stride;    /* Stride in bytes (strided) or node size (pointer-chase) */
+    uint32_t          block;    /* Tile dimension of matmul-blocked */
+} WorkloadOptions;
+
+/* Cache hierarchy evaluated by the batch mode. Fields follow the CLI options of the same name */
+typedef struct {
+    uint8_t  numCacheLevels;
+    uint32_t  cachelineSize;
+    uint32_t    numLines[3];
+    uint32_t     latency[3];
+    uint8_t mappingStrategy;
+    DramOptions        dram;
+    BusOptions          bus;
+    uint32_t           line;    /* Line of the batch file the configuration was read from */
+} CacheConfig;
+
+/* A cache level of a hierarchy file */
+typedef struct {
+    char name[LEVEL_NAME_SIZE]; /* Name of the level in reports and trace signals, e.g. L4 or eDRAM */
+    uint32_t       numLines;
+    uint32_t        latency;
+    uint32_t  cachelineSize;    /* Line size of the level, the one of the whole hierarchy if the section doesn't set it */
+    uint8_t mappingStrategy;    /* Mapping of the level, the one of the whole hierarchy if the section doesn't set it */
+    uint32_t           line;    /* Line of the hierarchy file the level's section starts in */
+} LevelConfig;
+
+/* Hierarchy of any depth read from a hierarchy file, ordered from L1 towards main memory */
+typedef struct {
+    uint8_t       numLevels;    /* 0 uses the levels given on the command line */
+    LevelConfig levels[MAX_CACHE_LEVELS];
+} HierarchyOptions;
+
+/* L1 instruction cache beside the first level, which then only serves data. Instruction fetches read L1I
+   instead of L1, the levels below are shared */
+typedef struct {
+    uint32_t       numLines;    /* 0 keeps a unified L1 */
+    uint32_t        latency;
+} SplitL1Options;
+
+/* Many hierarchies simulated on a thread pool against the same requests */
+typedef struct {
+    const CacheConfig* configs; /* NULL runs a single SystemC simulation */
+    uint32_t     numConfigs;
+    uint32_t        threads;    /* 0 for one thread per hardware thread */
+} BatchOptions;
+
+/* Host-side profiling of a single simulation */
+typedef struct {
+    bool            enabled;
+    double     parseSeconds;    /* Time the front end spent reading and parsing the input */
+} ProfileOptions;
+
+/* Single-pass characterization of the trace instead of a simulation */
+typedef struct {
+    bool            enabled;
+    uint64_t         window;    /* Requests per working set window */
+} AnalyzeOptions;
+
+/* Search of the hierarchies with the best AMAT per capacity instead of a simulation */
+typedef struct {
+    uint64_t         budget;    /* Bytes of all cache levels together, 0 disables the search */
+    uint32_t    latencyBase;    /* Latency in cycles of a 1 KiB level */
+    uint32_t latencyPerDoubling; /* Cycles added per doubling of a level's size */
+} TuneOptions;
+
+/* Formats of the input trace */
+typedef enum {
+    TRACE_FORMAT_AUTO,          /* Detected from the first line of the file */
+    TRACE_FORMAT_CSV,
+    TRACE_FORMAT_JSONL,
+    TRACE_FORMAT_LACKEY,
+    TRACE_FORMAT_MEMTRACE
+} TraceFormat;
+
+/* Trace file streamed by the simulation. CSV traces are parsed up front by the front end unless pipelined */
+typedef struct {
+    const char*    fileName;    /* NULL if the requests are passed in or generated */
+    uint8_t          format;    /* TraceFormat of the file */
+    bool           pipeline;    /* Parse the file on its own thread while the simulation runs */
+} InputOptions;
+
+/* Optional simulation settings that are not part of the cache configuration itself */
+typedef struct {
+    TraceOptions      trace;
+    InputOptions      input;
+    const char*    eventLog;    /* Binary per-request log file, NULL disables logging */
+    int          progressFd;    /* Descriptor that receives ProgressRecords during the simulation, -1 disables them */
+    bool        missClasses;    /* Report compulsory, capacity and conflict misses per level */
+    uint32_t       hotspots;    /* Entries per top list of the conflict hot-spot report, 0 disables the report */
+    DramOptions        dram;
+    BusOptions          bus;
+    WorkloadOptions workload;
+    BatchOptions      batch;
+    ProfileOptions  profile;
+    AnalyzeOptions  analyze;
+    TuneOptions        tune;
+    HierarchyOptions hierarchy;
+    SplitL1Options      l1i;
+} SimulationOptions;
+
+#endif // OPTIONS_H
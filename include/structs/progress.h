@@ -0,0 +1,27 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdint.h>
+#include "options.h"
+
+/* Levels a progress record has room for */
+#define PROGRESS_MAX_LEVELS MAX_CACHE_LEVELS
+
+/* Host seconds between two progress records of a running simulation */
+#define PROGRESS_PERIOD 0.2
+
+/* Snapshot of a running simulation, written to the --progress-fd descriptor every PROGRESS_PERIOD seconds
+   and once more when the run ends. A record is written with a single write() below PIPE_BUF, so a reader
+   of a pipe never sees a torn record */
+typedef struct {
+    uint64_t       requests;    /* Requests completed so far */
+    uint64_t          total;    /* Requests of the whole run, 0 if the input is streamed and its length unknown */
+    uint64_t         cycles;    /* Cycles simulated so far */
+    uint64_t     cycleLimit;    /* The run stops at this cycle */
+    uint64_t         served[PROGRESS_MAX_LEVELS + 1]; /* Requests served by main memory (0) and by each level (1 = L1, ...) */
+    double   elapsedSeconds;    /* Host time since the run started */
+    uint32_t      numLevels;
+    uint32_t       finished;    /* 1 in the last record of the run */
+} ProgressRecord;
+
+#endif // PROGRESS_H
@@ -3,10 +3,13 @@
 
 #include <stdint.h>
 
+/* 16 bytes: a 64-bit address, 32-bit data and the type don't fit into the 12 bytes of 32-bit addresses.
+   The CSV text is freed once the requests are parsed, which saves more per request than the wider address costs */
 typedef struct { 
-    uint32_t    addr;
+    uint64_t    addr;
     uint32_t    data;
     uint8_t        w;
+    uint8_t    fetch;    /* 1 if the read is an instruction fetch, served by L1I if the L1 is split */
 } Request;
 
 #endif // REQUEST_H
\ No newline at end of file
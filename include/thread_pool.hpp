@@ -0,0 +1,123 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * @brief Runs a batch of independent tasks on a fixed number of threads with work stealing.
+ *
+ * Tasks are dealt round-robin to one deque per thread. A thread takes its own tasks from the front
+ * and, once its deque is empty, steals from the back of the other deques, so a thread that got short
+ * tasks helps with the long ones instead of idling.
+ */
+class WorkStealingPool
+{
+public:
+  // threads == 0 uses one thread per hardware thread
+  explicit WorkStealingPool(unsigned threads = 0)
+      : num_threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+  {
+  }
+
+  unsigned size() const { return num_threads; }
+
+  // Calls task(i) for every i in [0; num_tasks) and returns once all of them have finished.
+  // If a task throws, the remaining tasks are skipped and the first exception is rethrown
+  void run(size_t num_tasks, const std::function<void(size_t)> &task)
+  {
+    const unsigned workers = static_cast<unsigned>(std::min<size_t>(num_threads, num_tasks));
+    if (workers == 0)
+      return;
+
+    queues.clear();
+    for (unsigned i = 0; i < workers; i++)
+      queues.emplace_back(new Queue);
+    for (size_t i = 0; i < num_tasks; i++)
+      queues[i % workers]->tasks.push_back(i);
+
+    failed = false;
+    error = nullptr;
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; i++)
+      threads.emplace_back(&WorkStealingPool::work, this, i, std::cref(task));
+    work(0, task);
+    for (std::thread &thread : threads)
+      thread.join();
+
+    queues.clear();
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<size_t> tasks;
+  };
+
+  void work(unsigned self, const std::function<void(size_t)> &task)
+  {
+    size_t index;
+    while (!failed && next(self, index))
+    {
+      try
+      {
+        task(index);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+          error = std::current_exception();
+        failed = true;
+      }
+    }
+  }
+
+  // Takes the next task of thread self, or steals one. Returns false if no task is left anywhere
+  bool next(unsigned self, size_t &index)
+  {
+    {
+      Queue &own = *queues[self];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty())
+      {
+        index = own.tasks.front();
+        own.tasks.pop_front();
+        return true;
+      }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+      Queue &victim = *queues[(self + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty())
+      {
+        index = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  unsigned num_threads;
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::atomic<bool> failed{false};
+  std::mutex error_mutex;
+  std::exception_ptr error;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,131 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "structs/options.h"
+#include <systemc>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sc_core;
+
+// Copies a traced signal into its own mirror signal, but only while the trace window is open.
+// Outside of the window the mirror keeps its value, so the VCD writer has nothing to dump.
+template <typename T>
+struct TRACE_PROBE : public sc_module
+{
+  sc_in<T> in;
+  sc_signal<T> mirror;
+
+  const bool &enabled;
+
+  SC_HAS_PROCESS(TRACE_PROBE);
+
+  TRACE_PROBE(sc_module_name name, const bool &enabled, const sc_event &window_opened)
+      : sc_module(name), enabled(enabled)
+  {
+    SC_METHOD(behaviour);
+    sensitive << in << window_opened;
+    dont_initialize();
+  }
+
+  void behaviour()
+  {
+    if (enabled) mirror.write(in.read());
+  }
+};
+
+/*
+ * @brief Owns the VCD trace file and decides which signals are traced and when.
+ *
+ * If the whole run is traced, signals are handed to sc_trace directly. Otherwise every selected
+ * signal gets a TRACE_PROBE, which only forwards value changes while the window is open.
+ * The window is opened and closed from the simulation loop with update() before every clock cycle.
+ */
+class TraceWindow
+{
+public:
+  TraceWindow(const char *filename, const TraceOptions &options)
+      : options(options),
+        unbounded(options.firstRequest == 0 && options.lastRequest == UINT32_MAX &&
+                  options.firstCycle == 0 && options.lastCycle == UINT32_MAX),
+        enabled(false)
+  {
+    file = sc_create_vcd_trace_file(filename);
+
+    if (options.signals == NULL)
+      requested = {"clk", "addr", "wdata", "r", "w", "rdata", "ready", "miss"};
+    else
+    {
+      std::stringstream list(options.signals);
+      std::string name;
+      while (std::getline(list, name, ','))
+        if (!name.empty()) requested.insert(name);
+    }
+  }
+
+  ~TraceWindow()
+  {
+    sc_close_vcd_trace_file(file);
+  }
+
+  // Traces the signal if it was selected. Has to be called before the simulation starts
+  template <typename T>
+  void add(const sc_signal_in_if<T> &signal, const std::string &name)
+  {
+    if (!requested.count("all") && !requested.count(name)) return;
+    matched.insert(name);
+
+    if (unbounded)
+    {
+      sc_trace(file, signal, name);
+      return;
+    }
+
+    // SystemC names must not contain the hierarchy separator
+    std::string probe_name = "probe_" + name;
+    for (char &c : probe_name)
+      if (c == '.') c = '_';
+
+    auto probe = std::unique_ptr<TRACE_PROBE<T>>(new TRACE_PROBE<T>(probe_name.c_str(), enabled, window_opened));
+    probe->in(signal);
+    sc_trace(file, probe->mirror, name);
+    probes.push_back(std::move(probe));
+  }
+
+  // Returns names that were requested but don't match any signal
+  std::vector<std::string> unknown_signals() const
+  {
+    std::vector<std::string> unknown;
+    for (const auto &name : requested)
+      if (name != "all" && !matched.count(name)) unknown.push_back(name);
+    return unknown;
+  }
+
+  // Opens or closes the window depending on the current request and cycle
+  void update(uint32_t request_index, uint32_t cycle)
+  {
+    bool inside = request_index >= options.firstRequest && request_index < options.lastRequest &&
+                  cycle >= options.firstCycle && cycle < options.lastCycle;
+    if (inside == enabled) return;
+
+    enabled = inside;
+    // Probes copy the current value of their signal as soon as the window opens
+    if (enabled) window_opened.notify(SC_ZERO_TIME);
+  }
+
+private:
+  TraceOptions options;
+  bool unbounded;
+  bool enabled;
+
+  sc_trace_file *file;
+  sc_event window_opened;
+
+  std::set<std::string> requested, matched;
+  std::vector<std::unique_ptr<sc_module>> probes;
+};
+
+#endif // TRACE_HPP
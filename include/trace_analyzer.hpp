@@ -0,0 +1,309 @@
+#ifndef TRACE_ANALYZER_HPP
+#define TRACE_ANALYZER_HPP
+
+#include "structs/request.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * @brief Hash table from line addresses to Value with open addressing and linear probing.
+ *
+ * Keys and values live in two flat arrays, so a line costs 8 bytes plus sizeof(Value) per slot and no
+ * allocation per entry, which keeps traces with hundreds of millions of distinct lines in memory.
+ * Line addresses are addresses shifted by the line size, so UINT64_MAX never occurs and marks empty slots.
+ */
+template <class Value>
+class LineTable
+{
+public:
+  LineTable() { rehash(1 << 12); }
+
+  // Returns the value of line. A new line is inserted with Value() and sets inserted
+  Value &find_or_insert(uint64_t line, bool &inserted)
+  {
+    if ((count + 1) * 2 > keys.size())
+      rehash(keys.size() * 2);
+
+    size_t i = slot(line);
+    while (keys[i] != EMPTY)
+    {
+      if (keys[i] == line)
+      {
+        inserted = false;
+        return values[i];
+      }
+      i = (i + 1) & mask;
+    }
+
+    keys[i] = line;
+    values[i] = Value();
+    count++;
+    inserted = true;
+    return values[i];
+  }
+
+  size_t size() const { return count; }
+
+  template <class Function>
+  void for_each(Function function)
+  {
+    for (size_t i = 0; i < keys.size(); i++)
+      if (keys[i] != EMPTY) function(keys[i], values[i]);
+  }
+
+  size_t memory_bytes() const { return keys.capacity() * sizeof(uint64_t) + values.capacity() * sizeof(Value); }
+
+private:
+  static constexpr uint64_t EMPTY = UINT64_MAX;
+
+  // Fibonacci hashing, the upper bits of the product are well mixed even for strided lines
+  size_t slot(uint64_t line) const { return static_cast<size_t>((line * 0x9E3779B97F4A7C15ull) >> shift); }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<uint64_t> old_keys(capacity, EMPTY);
+    std::vector<Value> old_values(capacity);
+    old_keys.swap(keys);
+    old_values.swap(values);
+    mask = capacity - 1;
+    shift = 64 - __builtin_ctzll(capacity);
+    count = 0;
+
+    bool inserted;
+    for (size_t i = 0; i < old_keys.size(); i++)
+      if (old_keys[i] != EMPTY) find_or_insert(old_keys[i], inserted) = old_values[i];
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<Value> values;
+  size_t count = 0;
+  size_t mask = 0;
+  unsigned shift = 0;
+};
+
+// Binary indexed tree over access slots, counts the marked slots of a prefix in O(log n)
+class FenwickTree
+{
+public:
+  // Resizes the tree to capacity slots, of which the first marked ones are marked
+  void assign(size_t capacity, size_t marked)
+  {
+    tree.assign(capacity + 1, 0);
+    for (size_t i = 1; i <= capacity; i++)
+    {
+      const size_t first = i - (i & (~i + 1)); // node i covers the slots [first; i)
+      tree[i] = static_cast<uint32_t>(std::min(i, std::max(marked, first)) - first);
+    }
+  }
+
+  void add(size_t slot, int32_t delta)
+  {
+    for (size_t i = slot + 1; i < tree.size(); i += i & (~i + 1))
+      tree[i] += delta;
+  }
+
+  // Number of marked slots in [0; slot]
+  uint64_t prefix(size_t slot) const
+  {
+    uint64_t sum = 0;
+    for (size_t i = slot + 1; i > 0; i -= i & (~i + 1))
+      sum += tree[i];
+    return sum;
+  }
+
+  size_t capacity() const { return tree.size() - 1; }
+  size_t memory_bytes() const { return tree.capacity() * sizeof(uint32_t); }
+
+private:
+  std::vector<uint32_t> tree;
+};
+
+/*
+ * @brief Characterizes a request stream in a single pass, without simulating a cache.
+ *
+ * Computes the read/write mix, the number of distinct lines for every line size from 16 B to 2 KiB,
+ * the histogram of LRU stack (reuse) distances and the working set of every window of requests.
+ * The distances are counted in lines of cacheline_size: the number of distinct lines touched since the
+ * last access to the same line, so an access hits in a fully associative LRU cache of N lines iff its
+ * distance is below N.
+ *
+ * Every line keeps the slot of its last access in a Fenwick tree, a distance is the number of slots
+ * marked after it. Slots are renumbered once the tree is full, which bounds the tree by the number of
+ * distinct lines instead of the number of requests.
+ */
+class TraceAnalyzer
+{
+public:
+  static constexpr uint32_t FIRST_FOOTPRINT_SIZE = 16;
+  static constexpr unsigned NUM_FOOTPRINT_SIZES = 8;
+  static constexpr unsigned NUM_DISTANCE_BINS = 65; // 0, then [2^(b-1); 2^b) for bin b
+
+  TraceAnalyzer(uint32_t cacheline_size, uint64_t window)
+      : histogram(NUM_DISTANCE_BINS, 0), line_bits(__builtin_ctz(cacheline_size)), window(window)
+  {
+    if (__builtin_popcount(cacheline_size) != 1 || window == 0)
+      throw std::runtime_error("InvalidArgumentException: cacheline_size must be a power of 2 and the window positive");
+    fenwick.assign(MIN_SLOTS, 0);
+  }
+
+  void add(const Request &request)
+  {
+    if (requests > 0 && requests % window == 0)
+      close_window();
+    requests++;
+    if (request.w) writes++;
+    else if (request.fetch) fetches++;
+    else reads++;
+
+    // a line that was touched before lies in lines touched before at every larger size
+    for (unsigned i = 0; i < NUM_FOOTPRINT_SIZES; i++)
+    {
+      bool inserted;
+      footprint[i].find_or_insert(request.addr >> (__builtin_ctz(FIRST_FOOTPRINT_SIZE) + i), inserted);
+      if (!inserted) break;
+    }
+
+    if (next_slot == fenwick.capacity())
+      compact();
+
+    bool inserted;
+    LineState &line = reuse.find_or_insert(request.addr >> line_bits, inserted);
+    if (inserted)
+      cold++;
+    else
+    {
+      histogram[distance_bin(live - fenwick.prefix(line.slot))]++;
+      fenwick.add(line.slot, -1);
+      live--;
+    }
+    line.slot = static_cast<uint32_t>(next_slot++);
+    fenwick.add(line.slot, 1);
+    live++;
+
+    if (inserted || line.window != windows.size())
+    {
+      line.window = static_cast<uint32_t>(windows.size());
+      window_lines++;
+    }
+  }
+
+  // Ends the last, possibly partial window. Has to be called once after the last request
+  void finish()
+  {
+    if (requests > 0)
+      close_window();
+  }
+
+  void print() const
+  {
+    const uint32_t line_size = 1u << line_bits;
+
+    printf("\n\t\t======TRACE ANALYSIS======\n\
+            \tRequests: %" PRIu64 "\n\
+            \tReads: %" PRIu64 " (%.2f%%)\n\
+            \tWrites: %" PRIu64 " (%.2f%%)\n\
+            \tInstruction fetches: %" PRIu64 " (%.2f%%)\n\
+            \tDistinct %u B lines: %zu\n\
+            \tAnalyzer memory: %.1f MiB\n\n",
+           requests, reads, percent(reads, requests), writes, percent(writes, requests), fetches, percent(fetches, requests),
+           line_size, reuse.size(), memory_bytes() / (1024.0 * 1024.0));
+
+    printf("Footprint:\n%10s %14s %14s\n", "Line size", "Lines", "Bytes");
+    for (unsigned i = 0; i < NUM_FOOTPRINT_SIZES; i++)
+    {
+      const uint64_t size = static_cast<uint64_t>(FIRST_FOOTPRINT_SIZE) << i;
+      printf("%10" PRIu64 " %14zu %14" PRIu64 "\n", size, footprint[i].size(), footprint[i].size() * size);
+    }
+
+    printf("\nReuse distance in %u B lines. Hit rate of a fully associative LRU cache with as many lines:\n", line_size);
+    printf("%22s %14s %10s %9s\n", "Distance", "Accesses", "Lines", "Hit rate");
+    printf("%22s %14" PRIu64 "\n", "cold", cold);
+    unsigned last = NUM_DISTANCE_BINS;
+    while (last > 0 && histogram[last - 1] == 0) last--;
+    uint64_t hits = 0;
+    for (unsigned b = 0; b < last; b++)
+    {
+      const uint64_t first = b == 0 ? 0 : 1ull << (b - 1);
+      const uint64_t lines = 1ull << b;
+      char range[48];
+      if (first == lines - 1) snprintf(range, sizeof(range), "%" PRIu64, first);
+      else snprintf(range, sizeof(range), "%" PRIu64 "-%" PRIu64, first, lines - 1);
+      hits += histogram[b];
+      printf("%22s %14" PRIu64 " %10" PRIu64 " %8.2f%%\n", range, histogram[b], lines, percent(hits, requests));
+    }
+
+    printf("\nWorking set in %u B lines per window of %" PRIu64 " requests:\n", line_size, window);
+    printf("%8s %16s %14s %14s\n", "Window", "First request", "Lines", "Bytes");
+    for (size_t i = 0; i < windows.size(); i++)
+      printf("%8zu %16" PRIu64 " %14" PRIu64 " %14" PRIu64 "\n", i, i * window, windows[i], windows[i] * line_size);
+    printf("\n");
+  }
+
+  uint64_t requests = 0, reads = 0, writes = 0, fetches = 0;
+  uint64_t cold = 0;                 // First accesses of a line, their distance is infinite
+  std::vector<uint64_t> histogram;   // Accesses per distance bin
+  std::vector<uint64_t> windows;     // Distinct lines per completed window
+
+  // Distinct lines of FIRST_FOOTPRINT_SIZE << i bytes
+  size_t unique_lines(unsigned i) const { return footprint[i].size(); }
+
+  static unsigned distance_bin(uint64_t distance) { return distance == 0 ? 0 : 64 - __builtin_clzll(distance); }
+
+  size_t memory_bytes() const
+  {
+    size_t bytes = reuse.memory_bytes() + fenwick.memory_bytes();
+    for (const auto &lines : footprint)
+      bytes += lines.memory_bytes();
+    return bytes;
+  }
+
+private:
+  static constexpr size_t MIN_SLOTS = 1 << 16;
+
+  struct LineState
+  {
+    uint32_t slot = 0;   // Slot of the last access in the Fenwick tree
+    uint32_t window = 0; // Last window the line was counted in
+  };
+
+  void close_window()
+  {
+    windows.push_back(window_lines);
+    window_lines = 0;
+  }
+
+  // Renumbers the last accesses to the slots [0; live) in their order and grows the tree to 4x the live lines
+  void compact()
+  {
+    std::vector<LineState *> lines;
+    lines.reserve(live);
+    reuse.for_each([&](uint64_t, LineState &line) { lines.push_back(&line); });
+    std::sort(lines.begin(), lines.end(), [](const LineState *a, const LineState *b) { return a->slot < b->slot; });
+    for (size_t i = 0; i < lines.size(); i++)
+      lines[i]->slot = static_cast<uint32_t>(i);
+
+    const size_t capacity = std::max(size_t(MIN_SLOTS), 4 * static_cast<size_t>(live));
+    if (capacity > UINT32_MAX)
+      throw std::runtime_error("Too many distinct lines for the reuse distance analysis");
+    fenwick.assign(capacity, live);
+    next_slot = live;
+  }
+
+  static double percent(uint64_t part, uint64_t total) { return total ? 100.0 * part / total : 0.0; }
+
+  const unsigned line_bits;
+  const uint64_t window;
+
+  LineTable<uint8_t> footprint[NUM_FOOTPRINT_SIZES];
+  LineTable<LineState> reuse;
+  FenwickTree fenwick;
+  uint64_t live = 0;      // Distinct lines so far, each marks the slot of its last access
+  uint64_t next_slot = 0; // Slot of the next access
+  uint64_t window_lines = 0;
+};
+
+#endif // TRACE_ANALYZER_HPP
@@ -0,0 +1,519 @@
+#ifndef TRACE_READER_HPP
+#define TRACE_READER_HPP
+
+#include "parsers/csv_parser.h"
+#include "structs/options.h"
+#include "workload.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+// Requests read from a CSV trace file line by line, so that the trace never has to fit in memory
+class CsvStreamSource : public RequestSource
+{
+public:
+  explicit CsvStreamSource(const char *filename)
+  {
+    if (!csv_stream_open(&stream, filename))
+      throw std::runtime_error("InvalidArgumentException: Can't open trace file " + std::string(filename));
+  }
+
+  ~CsvStreamSource() override { csv_stream_close(&stream); }
+
+  CsvStreamSource(const CsvStreamSource &) = delete;
+  CsvStreamSource &operator=(const CsvStreamSource &) = delete;
+
+  // Throws on an invalid line, the parser has already printed the reason
+  bool next(Request &request) override
+  {
+    const int status = csv_stream_next(&stream, &request);
+    if (status < 0)
+      throw std::runtime_error("InvalidTraceException: Invalid request in line " + std::to_string(stream.lineNumber));
+    if (status == 0)
+      return false;
+    count++;
+    return true;
+  }
+
+  // Requests read so far, the total is only known once the file has ended
+  uint64_t size() const override { return count; }
+
+private:
+  CsvStream stream;
+  uint64_t count = 0;
+};
+
+/*
+ * @brief Base of the text trace formats other than CSV: reads the file line by line and leaves a line to parse().
+ *
+ * A line yields up to two accesses (a Lackey modify is a load and a store), lines yielding none are skipped.
+ * Captures hold accesses of any size at any byte, while a level reads and writes whole words within a line.
+ * So an access is split at every boundary of split_size bytes, the shortest line simulated, and every piece
+ * is a request at the word of its first byte.
+ */
+class TextTraceSource : public RequestSource
+{
+public:
+  TextTraceSource(const char *filename, uint32_t split_size)
+      : file(fopen(filename, "r")), split_size(std::max<uint32_t>(split_size, sizeof(uint32_t)))
+  {
+    if (!file)
+      throw std::runtime_error("InvalidArgumentException: Can't open trace file " + std::string(filename));
+  }
+
+  ~TextTraceSource() override
+  {
+    fclose(file);
+    free(line);
+  }
+
+  TextTraceSource(const TextTraceSource &) = delete;
+  TextTraceSource &operator=(const TextTraceSource &) = delete;
+
+  // Throws on an invalid line
+  bool next(Request &request) override
+  {
+    while (position == parsed)
+    {
+      if (getline(&line, &capacity, file) < 0)
+      {
+        if (ferror(file))
+          throw std::runtime_error("InvalidTraceException: Error reading line " + std::to_string(line_number + 1));
+        return false;
+      }
+      line_number++;
+      position = 0;
+      parsed = parse(line, pending);
+      if (parsed > 0) piece = pending[0].request.addr;
+    }
+
+    const Access &access = pending[position];
+    request = access.request;
+    request.addr = piece & ~static_cast<uint64_t>(sizeof(uint32_t) - 1);
+    const uint64_t boundary = piece | (split_size - 1);
+    if (boundary >= access.last)
+    {
+      if (++position < parsed) piece = pending[position].request.addr;
+    }
+    else piece = boundary + 1;
+    count++;
+    return true;
+  }
+
+  // Requests read so far, the total is only known once the file has ended
+  uint64_t size() const override { return count; }
+
+protected:
+  struct Access
+  {
+    Request request; // Request at the first byte of the access
+    uint64_t last;   // Last byte of the access
+  };
+
+  // Parses a line into at most two accesses and returns their number. Throws through invalid() on an invalid line
+  virtual unsigned parse(const char *line, Access accesses[2]) = 0;
+
+  // Access of size bytes from request.addr on, one byte if the size is unknown. Ends at the top of the address space
+  static Access access_of(const Request &request, uint64_t size)
+  {
+    const uint64_t length = std::max<uint64_t>(size, 1) - 1;
+    return {request, request.addr > UINT64_MAX - length ? UINT64_MAX : request.addr + length};
+  }
+
+  [[noreturn]] void invalid(const std::string &reason) const
+  {
+    throw std::runtime_error("InvalidTraceException: " + reason + " in line " + std::to_string(line_number));
+  }
+
+  static const char *skip_space(const char *p)
+  {
+    while (isspace(static_cast<unsigned char>(*p))) p++;
+    return p;
+  }
+
+  // Parses [begin; end) as a hexadecimal number, with or without 0x
+  static bool parse_hex(const char *begin, const char *end, uint64_t &value)
+  {
+    if (end - begin > 2 && begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X'))
+      begin += 2;
+    if (begin == end || end - begin > 16)
+      return false;
+    value = 0;
+    for (const char *p = begin; p < end; p++)
+    {
+      if (!isxdigit(static_cast<unsigned char>(*p)))
+        return false;
+      value = value << 4 | static_cast<uint64_t>(isdigit(static_cast<unsigned char>(*p)) ? *p - '0' : (tolower(*p) - 'a' + 10));
+    }
+    return true;
+  }
+
+  // Parses [begin; end) as a decimal number
+  static bool parse_decimal(const char *begin, const char *end, uint64_t &value)
+  {
+    if (begin == end || end - begin > 19)
+      return false;
+    value = 0;
+    for (const char *p = begin; p < end; p++)
+    {
+      if (!isdigit(static_cast<unsigned char>(*p)))
+        return false;
+      value = value * 10 + static_cast<uint64_t>(*p - '0');
+    }
+    return true;
+  }
+
+private:
+  FILE *file;
+  char *line = nullptr;
+  size_t capacity = 0;
+  uint64_t line_number = 0;
+  uint64_t count = 0;
+  const uint32_t split_size;
+  Access pending[2];
+  unsigned parsed = 0, position = 0;
+  uint64_t piece = 0; // First byte of the next piece of pending[position]
+};
+
+/*
+ * @brief One JSON object per line, e.g. {"type": "W", "address": "0x1f40", "data": 7}.
+ *
+ * type is R, W, I, read, write or ifetch, address (or addr) a number or a decimal or 0x string, data (or value)
+ * and size optional with the same syntax. Other keys, e.g. a timestamp, are ignored. Blank lines are skipped.
+ */
+class JsonlTraceSource : public TextTraceSource
+{
+public:
+  using TextTraceSource::TextTraceSource;
+
+protected:
+  unsigned parse(const char *line, Access accesses[2]) override
+  {
+    const char *p = skip_space(line);
+    if (*p == '\0')
+      return 0;
+    if (*p++ != '{')
+      invalid("Expected a JSON object");
+
+    Request request = Request();
+    uint64_t size = 0;
+    bool has_type = false, has_address = false;
+    p = skip_space(p);
+    if (*p == '}')
+      invalid("Empty JSON object");
+    while (true)
+    {
+      const std::string key = string_value(p);
+      p = skip_space(p);
+      if (*p++ != ':')
+        invalid("Expected ':' after key " + key);
+      p = skip_space(p);
+
+      if (key == "type" || key == "op")
+      {
+        const std::string type = string_value(p);
+        if (strcasecmp(type.c_str(), "w") == 0 || strcasecmp(type.c_str(), "write") == 0) request.w = 1;
+        else if (strcasecmp(type.c_str(), "r") == 0 || strcasecmp(type.c_str(), "read") == 0) request.w = 0;
+        else if (strcasecmp(type.c_str(), "i") == 0 || strcasecmp(type.c_str(), "ifetch") == 0) request.fetch = 1;
+        else invalid("Invalid type " + type);
+        has_type = true;
+      }
+      else if (key == "address" || key == "addr")
+      {
+        request.addr = number_value(p, UINT64_MAX, key);
+        has_address = true;
+      }
+      else if (key == "data" || key == "value")
+        request.data = static_cast<uint32_t>(number_value(p, UINT32_MAX, key));
+      else if (key == "size")
+        size = number_value(p, UINT64_MAX, key);
+      else
+        skip_value(p, 0);
+
+      p = skip_space(p);
+      if (*p == ',') { p = skip_space(p + 1); continue; }
+      if (*p++ == '}') break;
+      invalid("Expected ',' or '}'");
+    }
+
+    if (*skip_space(p) != '\0')
+      invalid("Unexpected data after the JSON object");
+    if (!has_type || !has_address)
+      invalid("Missing type or address");
+    accesses[0] = access_of(request, size);
+    return 1;
+  }
+
+private:
+  static constexpr unsigned MAX_DEPTH = 64;
+
+  // Reads a string and moves p past it. Escapes are kept undecoded, none of the known keys or values has one
+  std::string string_value(const char *&p) const
+  {
+    if (*p != '"')
+      invalid("Expected a string");
+    const char *begin = ++p;
+    while (*p != '"')
+    {
+      if (*p == '\0') invalid("Unterminated string");
+      if (*p == '\\' && p[1] != '\0') p++;
+      p++;
+    }
+    return std::string(begin, p++);
+  }
+
+  // Reads a non-negative integer, given as number or as decimal or 0x string, of at most max
+  uint64_t number_value(const char *&p, uint64_t max, const std::string &key) const
+  {
+    std::string text;
+    if (*p == '"')
+      text = string_value(p);
+    else
+    {
+      const char *begin = p;
+      while (isalnum(static_cast<unsigned char>(*p)) || *p == '-' || *p == '.') p++;
+      text.assign(begin, p);
+    }
+
+    uint64_t value;
+    const char *begin = text.c_str(), *end = begin + text.size();
+    const bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    if (!(hex ? parse_hex(begin, end, value) : parse_decimal(begin, end, value)) || value > max)
+      invalid("Invalid " + key + " " + text);
+    return value;
+  }
+
+  // Skips a value of an unknown key, including nested objects and arrays
+  void skip_value(const char *&p, unsigned depth) const
+  {
+    if (depth > MAX_DEPTH)
+      invalid("JSON nested too deeply");
+    if (*p == '"')
+    {
+      string_value(p);
+      return;
+    }
+    if (*p != '{' && *p != '[')
+    {
+      const char *begin = p;
+      while (*p && *p != ',' && *p != '}' && *p != ']' && !isspace(static_cast<unsigned char>(*p))) p++;
+      if (p == begin) invalid("Expected a value");
+      return;
+    }
+
+    const char close = *p == '{' ? '}' : ']';
+    p = skip_space(p + 1);
+    if (*p == close) { p++; return; }
+    while (true)
+    {
+      if (close == '}')
+      {
+        string_value(p);
+        p = skip_space(p);
+        if (*p++ != ':') invalid("Expected ':'");
+        p = skip_space(p);
+      }
+      skip_value(p, depth + 1);
+      p = skip_space(p);
+      if (*p == ',') { p = skip_space(p + 1); continue; }
+      if (*p++ == close) return;
+      invalid("Unterminated JSON value");
+    }
+  }
+};
+
+/*
+ * @brief Output of valgrind --tool=lackey --trace-mem=yes: "I  ADDR,SIZE", " L ADDR,SIZE", " S ADDR,SIZE", " M ADDR,SIZE".
+ *
+ * Addresses are hexadecimal. Instructions are fetches, loads are reads, stores writes with data 0, and a modify
+ * is a read followed by a write of the same address. Valgrind's own "==PID==" messages are skipped.
+ */
+class LackeyTraceSource : public TextTraceSource
+{
+public:
+  using TextTraceSource::TextTraceSource;
+
+protected:
+  unsigned parse(const char *line, Access accesses[2]) override
+  {
+    const char *p = skip_space(line);
+    if (*p == '\0' || (p[0] == '=' && p[1] == '='))
+      return 0;
+
+    const char op = *p++;
+    if (op != 'I' && op != 'L' && op != 'S' && op != 'M')
+      invalid(std::string("Invalid Lackey operation ") + op);
+    if (!isspace(static_cast<unsigned char>(*p)))
+      invalid("Expected a space after the operation");
+    p = skip_space(p);
+
+    const char *comma = strchr(p, ',');
+    uint64_t address, size;
+    if (!comma || !parse_hex(p, comma, address))
+      invalid("Invalid address");
+    const char *end = comma + 1;
+    while (isdigit(static_cast<unsigned char>(*end))) end++;
+    if (!parse_decimal(comma + 1, end, size) || size == 0 || *skip_space(end) != '\0')
+      invalid("Invalid size");
+
+    Request request = Request();
+    request.addr = address;
+    request.w = op == 'S';
+    request.fetch = op == 'I';
+    accesses[0] = access_of(request, size);
+    if (op != 'M')
+      return 1;
+    request.w = 1;
+    accesses[1] = access_of(request, size);
+    return 2;
+  }
+};
+
+/*
+ * @brief Generic memory trace text, one access per line as fields separated by whitespace, ',' or ':'.
+ *
+ * A line holds the type (R, W, I, read, write or ifetch, in any case) and the hexadecimal address, with or without 0x,
+ * in either order, optionally followed by decimal numbers, the first of them the size. This reads "W 0x7ffd5a10 8" as well as the
+ * "0x7ffd5a10: 8, w" of DynamoRIO's memtrace samples. Lines starting with '#' are comments.
+ */
+class MemtraceTraceSource : public TextTraceSource
+{
+public:
+  using TextTraceSource::TextTraceSource;
+
+protected:
+  unsigned parse(const char *line, Access accesses[2]) override
+  {
+    const char *p = skip_field_separators(line);
+    if (*p == '\0' || *p == '#')
+      return 0;
+
+    Request request = Request();
+    uint64_t size = 0;
+    bool has_type = false, has_address = false, has_size = false;
+    while (*p != '\0')
+    {
+      const char *end = p;
+      while (*end && !is_field_separator(*end)) end++;
+      const std::string field(p, end);
+
+      uint64_t value;
+      if (is_type(field, "r", "read") || is_type(field, "w", "write") || is_type(field, "i", "ifetch"))
+      {
+        if (has_type) invalid("Second type " + field);
+        request.w = is_type(field, "w", "write");
+        request.fetch = is_type(field, "i", "ifetch");
+        has_type = true;
+      }
+      else if (!has_address)
+      {
+        if (!parse_hex(p, end, request.addr)) invalid("Invalid address " + field);
+        has_address = true;
+      }
+      else if (!parse_decimal(p, end, value))
+        invalid("Unexpected field " + field);
+      else if (!has_size)
+      {
+        size = value;
+        has_size = true;
+      }
+      p = skip_field_separators(end);
+    }
+
+    if (!has_type || !has_address)
+      invalid("Missing type or address");
+    accesses[0] = access_of(request, size);
+    return 1;
+  }
+
+private:
+  static bool is_field_separator(char c) { return isspace(static_cast<unsigned char>(c)) || c == ',' || c == ':'; }
+
+  static const char *skip_field_separators(const char *p)
+  {
+    while (*p && is_field_separator(*p)) p++;
+    return p;
+  }
+
+  static bool is_type(const std::string &field, const char *letter, const char *word)
+  {
+    return strcasecmp(field.c_str(), letter) == 0 || strcasecmp(field.c_str(), word) == 0;
+  }
+};
+
+// Names of the TraceFormat values, in their order
+inline const std::vector<std::string> &trace_format_names()
+{
+  static const std::vector<std::string> names = {"auto", "csv", "jsonl", "lackey", "memtrace"};
+  return names;
+}
+
+// "OP ADDR,SIZE" with a Lackey operation, p starts at the operation
+inline bool is_lackey_line(const char *p)
+{
+  if (*p == '\0' || !strchr("ILSM", *p) || (p[1] != ' ' && p[1] != '\t'))
+    return false;
+  p += 1 + strspn(p + 1, " \t");
+  const size_t digits = strspn(p, "0123456789abcdefABCDEF");
+  return digits > 0 && p[digits] == ',' && isdigit(static_cast<unsigned char>(p[digits + 1]));
+}
+
+/*
+ * @brief Guesses the format of a trace from its first line that is not blank, a comment or a valgrind message.
+ *
+ * A JSON object is JSONL, "OP ADDR,SIZE" with a Lackey operation is Lackey, a line with two commas or
+ * starting with "R," or "W," is CSV and anything else the generic memtrace text. Empty files count as CSV.
+ */
+inline TraceFormat detect_trace_format(const char *filename)
+{
+  FILE *file = fopen(filename, "r");
+  if (!file)
+    throw std::runtime_error("InvalidArgumentException: Can't open trace file " + std::string(filename));
+
+  char *line = nullptr;
+  size_t capacity = 0;
+  TraceFormat format = TRACE_FORMAT_CSV;
+  while (getline(&line, &capacity, file) >= 0)
+  {
+    const char *p = line;
+    while (isspace(static_cast<unsigned char>(*p))) p++;
+    if (*p == '\0' || *p == '#' || (p[0] == '=' && p[1] == '='))
+      continue;
+
+    const char *comma = strchr(p, ',');
+    if (*p == '{') format = TRACE_FORMAT_JSONL;
+    else if (is_lackey_line(p)) format = TRACE_FORMAT_LACKEY;
+    else if (((*p == 'R' || *p == 'W' || *p == 'I') && p[1] == ',') || (comma && strchr(comma + 1, ','))) format = TRACE_FORMAT_CSV;
+    else format = TRACE_FORMAT_MEMTRACE;
+    break;
+  }
+  free(line);
+  fclose(file);
+  return format;
+}
+
+// Opens filename as a stream of requests in format, TRACE_FORMAT_AUTO detects it. Throws if the file can't be read.
+// Accesses of the captures are split at the boundaries of split_size bytes, the shortest line they are simulated with
+inline std::unique_ptr<RequestSource> make_trace_reader(const char *filename, uint8_t format, uint32_t split_size)
+{
+  if (format == TRACE_FORMAT_AUTO)
+    format = detect_trace_format(filename);
+  switch (format)
+  {
+  case TRACE_FORMAT_CSV: return std::unique_ptr<RequestSource>(new CsvStreamSource(filename));
+  case TRACE_FORMAT_JSONL: return std::unique_ptr<RequestSource>(new JsonlTraceSource(filename, split_size));
+  case TRACE_FORMAT_LACKEY: return std::unique_ptr<RequestSource>(new LackeyTraceSource(filename, split_size));
+  case TRACE_FORMAT_MEMTRACE: return std::unique_ptr<RequestSource>(new MemtraceTraceSource(filename, split_size));
+  default: throw std::runtime_error("InvalidArgumentException: Unknown trace format " + std::to_string(format));
+  }
+}
+
+#endif // TRACE_READER_HPP
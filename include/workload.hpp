@@ -0,0 +1,386 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include "structs/options.h"
+#include "structs/request.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Stream of requests consumed by the simulation one at a time
+class RequestSource
+{
+public:
+  virtual ~RequestSource() {}
+
+  // Stores the next request and returns true, or returns false if the stream has ended
+  virtual bool next(Request &request) = 0;
+
+  // Total number of requests in the stream
+  virtual uint64_t size() const = 0;
+};
+
+// Requests parsed from a trace file
+class ArrayRequestSource : public RequestSource
+{
+public:
+  ArrayRequestSource(const Request *requests, uint64_t count) : requests(requests), count(count) {}
+
+  bool next(Request &request) override
+  {
+    if (position == count) return false;
+    request = requests[position++];
+    return true;
+  }
+
+  uint64_t size() const override { return count; }
+
+private:
+  const Request *requests;
+  uint64_t count;
+  uint64_t position = 0;
+};
+
+// xorshift64*, fast and good enough for address streams
+class Xorshift
+{
+public:
+  explicit Xorshift(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+  uint64_t next()
+  {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+  }
+
+  // Uniform value in [0; bound)
+  uint64_t below(uint64_t bound) { return next() % bound; }
+
+  // Uniform value in [0; 1)
+  double uniform() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+  uint64_t state;
+};
+
+/*
+ * @brief Base of all synthetic workloads.
+ *
+ * A workload has a natural length (one pass over its data, e.g. one matrix multiplication).
+ * Deterministic workloads compute request t of the pass directly from t, so no state has to be kept
+ * and a stream longer than one pass simply starts the next pass.
+ */
+class Workload : public RequestSource
+{
+public:
+  explicit Workload(const WorkloadOptions &options) : options(options) {}
+
+  bool next(Request &request) override
+  {
+    if (position == total) return false;
+    generate(position++ % pass_length, request);
+    return true;
+  }
+
+  uint64_t size() const override { return total; }
+
+protected:
+  // Has to be called by the derived constructor once the length of a pass is known
+  void set_pass_length(uint64_t length)
+  {
+    if (length == 0)
+      throw std::runtime_error("InvalidArgumentException: Workload size is too small");
+    pass_length = length;
+    total = options.requests ? options.requests : length;
+  }
+
+  virtual void generate(uint64_t t, Request &request) = 0;
+
+  static void read(Request &request, uint64_t addr)
+  {
+    request.addr = addr;
+    request.data = 0;
+    request.w = 0;
+    request.fetch = 0;
+  }
+
+  static void write(Request &request, uint64_t addr, uint32_t data)
+  {
+    request.addr = addr;
+    request.data = data;
+    request.w = 1;
+    request.fetch = 0;
+  }
+
+  const WorkloadOptions options;
+
+private:
+  uint64_t pass_length = 1;
+  uint64_t total = 0;
+  uint64_t position = 0;
+};
+
+constexpr uint64_t WORD_SIZE = 4;
+
+// C = A * B with the ijk loop order. Per element of C: 2N reads of A and B, then one write of C
+class MatmulWorkload : public Workload
+{
+public:
+  explicit MatmulWorkload(const WorkloadOptions &options) : Workload(options), n(options.size ? options.size : 64)
+  {
+    set_pass_length(n * n * (2 * n + 1));
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    const uint64_t element = t / (2 * n + 1), step = t % (2 * n + 1);
+    const uint64_t i = element / n, j = element % n, k = step / 2;
+    if (step == 2 * n) write(request, c_base() + (i * n + j) * WORD_SIZE, static_cast<uint32_t>(t));
+    else if (step % 2 == 0) read(request, (i * n + k) * WORD_SIZE);
+    else read(request, b_base() + (k * n + j) * WORD_SIZE);
+  }
+
+  uint64_t b_base() const { return n * n * WORD_SIZE; }
+  uint64_t c_base() const { return 2 * n * n * WORD_SIZE; }
+
+  const uint64_t n;
+};
+
+// Tiled C = A * B. For every tile triple (ii, jj, kk) and element of the C tile:
+// 2B reads of A and B, then one write of the partial sum
+class BlockedMatmulWorkload : public MatmulWorkload
+{
+public:
+  explicit BlockedMatmulWorkload(const WorkloadOptions &options)
+      : MatmulWorkload(options), block(options.block ? options.block : 8)
+  {
+    if (n % block != 0)
+      throw std::runtime_error("InvalidArgumentException: Matrix size must be a multiple of the block size");
+    tiles = n / block;
+    set_pass_length(tiles * tiles * tiles * block * block * (2 * block + 1));
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    const uint64_t per_triple = block * block * (2 * block + 1);
+    const uint64_t triple = t / per_triple, rest = t % per_triple;
+    const uint64_t ii = triple / (tiles * tiles), jj = (triple / tiles) % tiles, kk = triple % tiles;
+    const uint64_t element = rest / (2 * block + 1), step = rest % (2 * block + 1);
+    const uint64_t i = ii * block + element / block, j = jj * block + element % block, k = kk * block + step / 2;
+    if (step == 2 * block) write(request, c_base() + (i * n + j) * WORD_SIZE, static_cast<uint32_t>(t));
+    else if (step % 2 == 0) read(request, (i * n + k) * WORD_SIZE);
+    else read(request, b_base() + (k * n + j) * WORD_SIZE);
+  }
+
+  const uint64_t block;
+  uint64_t tiles;
+};
+
+// 2D 5-point Jacobi sweep over the interior of an N x N grid. Reads center, north, south, west, east
+// of one grid and writes the other one. Every pass swaps the grids
+class StencilWorkload : public Workload
+{
+public:
+  explicit StencilWorkload(const WorkloadOptions &options) : Workload(options), n(options.size ? options.size : 256)
+  {
+    if (n < 3)
+      throw std::runtime_error("InvalidArgumentException: Stencil grid must be at least 3 x 3");
+    set_pass_length((n - 2) * (n - 2) * 6);
+  }
+
+  bool next(Request &request) override
+  {
+    // Remember the pass, so that source and destination grid can be swapped
+    if (!Workload::next(request)) return false;
+    if (++step_in_pass == (n - 2) * (n - 2) * 6)
+    {
+      step_in_pass = 0;
+      swapped = !swapped;
+    }
+    return true;
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    const uint64_t point = t / 6, step = t % 6;
+    const uint64_t i = point / (n - 2) + 1, j = point % (n - 2) + 1;
+    const uint64_t source = swapped ? n * n * WORD_SIZE : 0, destination = swapped ? 0 : n * n * WORD_SIZE;
+    static const int64_t di[] = {0, -1, 1, 0, 0}, dj[] = {0, 0, 0, -1, 1};
+    if (step == 5) write(request, destination + (i * n + j) * WORD_SIZE, static_cast<uint32_t>(t));
+    else read(request, source + ((i + di[step]) * n + (j + dj[step])) * WORD_SIZE);
+  }
+
+  const uint64_t n;
+  uint64_t step_in_pass = 0;
+  bool swapped = false;
+};
+
+// dst[i] = src[i] over arrays of N words
+class CopyWorkload : public Workload
+{
+public:
+  explicit CopyWorkload(const WorkloadOptions &options) : Workload(options), n(options.size ? options.size : 1 << 20)
+  {
+    set_pass_length(2 * n);
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    const uint64_t i = t / 2;
+    if (t % 2 == 0) read(request, i * WORD_SIZE);
+    else write(request, (n + i) * WORD_SIZE, static_cast<uint32_t>(i));
+  }
+
+  const uint64_t n;
+};
+
+// Reads every stride bytes through a footprint of N words, wrapping around at its end
+class StridedWorkload : public Workload
+{
+public:
+  explicit StridedWorkload(const WorkloadOptions &options)
+      : Workload(options), footprint((options.size ? options.size : 1 << 20) * WORD_SIZE),
+        stride(options.stride ? options.stride : 64)
+  {
+    set_pass_length(footprint / stride ? footprint / stride : 1);
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    read(request, (t * stride) % footprint & ~(WORD_SIZE - 1));
+  }
+
+  const uint64_t footprint, stride;
+};
+
+// Uniformly random words of a footprint of N words, a quarter of them writes
+class RandomWorkload : public Workload
+{
+public:
+  explicit RandomWorkload(const WorkloadOptions &options)
+      : Workload(options), n(options.size ? options.size : 1 << 20), rng(options.seed)
+  {
+    set_pass_length(n);
+  }
+
+protected:
+  void generate(uint64_t, Request &request) override
+  {
+    const uint64_t value = rng.next();
+    const uint64_t addr = (value % n) * WORD_SIZE;
+    if ((value >> 62) == 0) write(request, addr, static_cast<uint32_t>(value >> 32));
+    else read(request, addr);
+  }
+
+  const uint64_t n;
+  Xorshift rng;
+};
+
+/*
+ * Zipf distributed accesses (skew 0.99, as in YCSB) over N words: a small hot set receives most accesses.
+ * Ranks are sampled with the method of Gray et al., "Quickly Generating Billion-Record Synthetic Databases",
+ * and scattered over the footprint, so that hot words don't share cache lines. Every 8th access is a write
+ */
+class ZipfWorkload : public Workload
+{
+public:
+  static constexpr double THETA = 0.99;
+
+  explicit ZipfWorkload(const WorkloadOptions &options)
+      : Workload(options), n(options.size ? options.size : 1 << 20), rng(options.seed)
+  {
+    double zeta_n = 0.0;
+    for (uint64_t i = 1; i <= n; i++)
+      zeta_n += 1.0 / std::pow(static_cast<double>(i), THETA);
+    const double zeta_2 = 1.0 + 1.0 / std::pow(2.0, THETA);
+
+    alpha = 1.0 / (1.0 - THETA);
+    eta = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - THETA)) / (1.0 - zeta_2 / zeta_n);
+    half_pow_theta = 1.0 + std::pow(0.5, THETA);
+    zeta = zeta_n;
+    set_pass_length(n);
+  }
+
+protected:
+  void generate(uint64_t t, Request &request) override
+  {
+    const double u = rng.uniform(), uz = u * zeta;
+    uint64_t rank;
+    if (uz < 1.0) rank = 0;
+    else if (uz < half_pow_theta) rank = 1;
+    else rank = static_cast<uint64_t>(static_cast<double>(n) * std::pow(eta * u - eta + 1.0, alpha)) % n;
+
+    // Multiplication by an odd constant permutes the ranks, as long as it is coprime to n
+    const uint64_t addr = (rank * 2654435761ULL) % n * WORD_SIZE;
+    if (t % 8 == 7) write(request, addr, static_cast<uint32_t>(t));
+    else read(request, addr);
+  }
+
+  const uint64_t n;
+  Xorshift rng;
+  double zeta, alpha, eta, half_pow_theta;
+};
+
+// Follows a random cycle through N nodes of stride bytes each, like a shuffled linked list
+class PointerChaseWorkload : public Workload
+{
+public:
+  explicit PointerChaseWorkload(const WorkloadOptions &options)
+      : Workload(options), node_size(options.stride ? options.stride : 64),
+        successor(options.size ? options.size : 1 << 16)
+  {
+    // Sattolo's algorithm yields a single cycle through all nodes
+    Xorshift rng(options.seed);
+    for (uint32_t i = 0; i < successor.size(); i++)
+      successor[i] = i;
+    for (uint32_t i = successor.size() - 1; i > 0; i--)
+      std::swap(successor[i], successor[rng.below(i)]);
+    set_pass_length(successor.size());
+  }
+
+protected:
+  void generate(uint64_t, Request &request) override
+  {
+    read(request, static_cast<uint64_t>(current) * node_size);
+    current = successor[current];
+  }
+
+  const uint64_t node_size;
+  std::vector<uint32_t> successor;
+  uint32_t current = 0;
+};
+
+inline const std::vector<std::string> &workload_names()
+{
+  static const std::vector<std::string> names = {"matmul", "matmul-blocked", "stencil", "copy", "strided",
+                                                 "random", "zipf", "pointer-chase"};
+  return names;
+}
+
+// Creates the workload selected by options.name. Throws for unknown names and invalid sizes
+inline std::unique_ptr<RequestSource> make_workload(const WorkloadOptions &options)
+{
+  const std::string name = options.name ? options.name : "";
+  if (name == "matmul") return std::unique_ptr<RequestSource>(new MatmulWorkload(options));
+  if (name == "matmul-blocked") return std::unique_ptr<RequestSource>(new BlockedMatmulWorkload(options));
+  if (name == "stencil") return std::unique_ptr<RequestSource>(new StencilWorkload(options));
+  if (name == "copy") return std::unique_ptr<RequestSource>(new CopyWorkload(options));
+  if (name == "strided") return std::unique_ptr<RequestSource>(new StridedWorkload(options));
+  if (name == "random") return std::unique_ptr<RequestSource>(new RandomWorkload(options));
+  if (name == "zipf") return std::unique_ptr<RequestSource>(new ZipfWorkload(options));
+  if (name == "pointer-chase") return std::unique_ptr<RequestSource>(new PointerChaseWorkload(options));
+  throw std::runtime_error("InvalidArgumentException: Unknown workload: " + name);
+}
+
+#endif // WORKLOAD_HPP
@@ -1,14 +1,15 @@
+#include <fcntl.h>
 #include <getopt.h>
+#include <signal.h>
 #include <sysexits.h>
 
-/* This macro ensures that debug.h uses appropriate DEBUG_PRINT function */
-#define ENABLE_DEBUG
-
 #include "../include/structs/debug.h"
 #include "../include/structs/test.h"
 #include "../include/simulation.hpp"
 #include "../include/parsers/csv_parser.h"
 #include "../include/parsers/numeric_parser.h"
+#include "../include/parsers/batch_parser.h"
+#include "../include/parsers/hierarchy_parser.h"
 #include "../util/helper_functions.h"
 
 /* Debug flag */
@@ -17,6 +18,46 @@ bool debug = false;
 /* Test  flag */
 bool test  = false;
 
+/* Long options without a short equivalent. Values are outside of the char range, so they can't clash with short options */
+enum LongOnlyOptions {
+    OPT_TRACE_REQUESTS = 256,
+    OPT_TRACE_CYCLES,
+    OPT_TRACE_SIGNALS,
+    OPT_EVENT_LOG,
+    OPT_DRAM_CHANNELS,
+    OPT_DRAM_RANKS,
+    OPT_DRAM_BANKS,
+    OPT_DRAM_ROW_SIZE,
+    OPT_DRAM_TRCD,
+    OPT_DRAM_TCAS,
+    OPT_DRAM_TRP,
+    OPT_DRAM_PAGE_POLICY,
+    OPT_BUS_WIDTH,
+    OPT_BUS_FREQUENCY,
+    OPT_WORKLOAD,
+    OPT_WORKLOAD_REQUESTS,
+    OPT_WORKLOAD_SIZE,
+    OPT_WORKLOAD_STRIDE,
+    OPT_WORKLOAD_BLOCK,
+    OPT_SEED,
+    OPT_BATCH,
+    OPT_THREADS,
+    OPT_PROFILE,
+    OPT_LOG_FILE,
+    OPT_MISS_CLASSES,
+    OPT_HOTSPOTS,
+    OPT_ANALYZE,
+    OPT_ANALYZE_WINDOW,
+    OPT_TUNE,
+    OPT_TUNE_LATENCY,
+    OPT_INPUT_FORMAT,
+    OPT_PIPELINE,
+    OPT_PROGRESS_FD,
+    OPT_HIERARCHY,
+    OPT_NUM_LINES_L1I,
+    OPT_LATENCY_CACHE_L1I,
+};
+
 int main(int argc, char** argv)
 {
     /* Supported long options for CLI parsing */
@@ -35,6 +76,42 @@ int main(int argc, char** argv)
         {"mapping-strategy", required_argument, 0, 'S'},
         {"debug"           , no_argument      , 0, 'd'}, /* additional flag for debug printing */
         {"expected-values" , no_argument      , 0, 't'}, /* additional flag for testing. It requires expected values for R request in request, so we can compare actual values from cache with expected */
+        {"trace-requests"  , required_argument, 0, OPT_TRACE_REQUESTS},
+        {"trace-cycles"    , required_argument, 0, OPT_TRACE_CYCLES  },
+        {"trace-signals"   , required_argument, 0, OPT_TRACE_SIGNALS },
+        {"event-log"       , required_argument, 0, OPT_EVENT_LOG     },
+        {"dram-channels"   , required_argument, 0, OPT_DRAM_CHANNELS },
+        {"dram-ranks"      , required_argument, 0, OPT_DRAM_RANKS    },
+        {"dram-banks"      , required_argument, 0, OPT_DRAM_BANKS    },
+        {"dram-row-size"   , required_argument, 0, OPT_DRAM_ROW_SIZE },
+        {"dram-trcd"       , required_argument, 0, OPT_DRAM_TRCD     },
+        {"dram-tcas"       , required_argument, 0, OPT_DRAM_TCAS     },
+        {"dram-trp"        , required_argument, 0, OPT_DRAM_TRP      },
+        {"dram-page-policy", required_argument, 0, OPT_DRAM_PAGE_POLICY},
+        {"bus-width"       , required_argument, 0, OPT_BUS_WIDTH     },
+        {"bus-frequency"   , required_argument, 0, OPT_BUS_FREQUENCY },
+        {"workload"        , required_argument, 0, OPT_WORKLOAD      },
+        {"workload-requests", required_argument, 0, OPT_WORKLOAD_REQUESTS},
+        {"workload-size"   , required_argument, 0, OPT_WORKLOAD_SIZE },
+        {"workload-stride" , required_argument, 0, OPT_WORKLOAD_STRIDE},
+        {"workload-block"  , required_argument, 0, OPT_WORKLOAD_BLOCK},
+        {"seed"            , required_argument, 0, OPT_SEED          },
+        {"batch"           , required_argument, 0, OPT_BATCH         },
+        {"threads"         , required_argument, 0, OPT_THREADS       },
+        {"profile"         , no_argument      , 0, OPT_PROFILE       },
+        {"log-file"        , required_argument, 0, OPT_LOG_FILE      },
+        {"miss-classes"    , no_argument      , 0, OPT_MISS_CLASSES  },
+        {"hotspots"        , required_argument, 0, OPT_HOTSPOTS      },
+        {"analyze"         , no_argument      , 0, OPT_ANALYZE       },
+        {"analyze-window"  , required_argument, 0, OPT_ANALYZE_WINDOW},
+        {"tune"            , required_argument, 0, OPT_TUNE          },
+        {"tune-latency"    , required_argument, 0, OPT_TUNE_LATENCY  },
+        {"input-format"    , required_argument, 0, OPT_INPUT_FORMAT  },
+        {"pipeline"        , no_argument      , 0, OPT_PIPELINE      },
+        {"progress-fd"     , required_argument, 0, OPT_PROGRESS_FD   },
+        {"hierarchy"       , required_argument, 0, OPT_HIERARCHY     },
+        {"num-lines-l1i"   , required_argument, 0, OPT_NUM_LINES_L1I },
+        {"latency-cache-l1i", required_argument, 0, OPT_LATENCY_CACHE_L1I},
         {0                 , 0                , 0,  0 }
     };   
 
@@ -50,6 +127,12 @@ int main(int argc, char** argv)
     uint8_t   numCacheLevels   = NUM_CACHE_LEVELS;
     uint8_t   mappingStrategy  = MAPPING_STRATEGY;
     char*     traceFileName    = NULL;
+    char*     batchFileName    = NULL;
+    char*     hierarchyFileName = NULL;
+
+    /* Default optional settings */
+    SimulationOptions options;
+    init_simulation_options(&options);
 
     /* Parse CLI options using getopt_long.
        Supports both long (--cycles, --tf) and short (-c, -f) options.  */
@@ -77,7 +160,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cycles set\n");
+                LOG_DEBUG("Cycles set\n");
                 break;
             
             /* Tracefile specified. It should be created during simulation */
@@ -86,7 +169,7 @@ int main(int argc, char** argv)
                 if (!(traceFileName)) {
                     return EINVAL;
                 }
-                DEBUG_PRINT("Tracefile set\n");
+                LOG_DEBUG("Tracefile set\n");
                 break;
 
             /* Help flag. When this option is set, print helpful message for application usage */
@@ -113,7 +196,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cacheline size set\n");
+                LOG_DEBUG("Cacheline size set\n");
                 break;
 
             /* Parse and validate cache L1 number of lines, and pass it to simulation paramets afterwards */
@@ -131,7 +214,32 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
           
-                DEBUG_PRINT("Cache L1 lines set\n");
+                LOG_DEBUG("Cache L1 lines set\n");
+                break;
+
+            /* A separate L1 instruction cache splits L1, which then only serves data */
+            case OPT_NUM_LINES_L1I:
+
+                if (!parse_unsigned_int32(optarg, &options.l1i.numLines, "cache L1I line value")) {
+                    return EINVAL;
+                }
+
+                if (!is_power_of_two(options.l1i.numLines))
+                {
+                    fprintf(stderr, "Number of L1I cache lines is not a power of 2: %u\n", options.l1i.numLines);
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Cache L1I lines set\n");
+                break;
+
+            case OPT_LATENCY_CACHE_L1I:
+
+                if (!parse_unsigned_int32(optarg, &options.l1i.latency, "cache L1I latency value")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Cache L1I latency set\n");
                 break;
 
             /* Parse and validate cache L2 number of lines, and pass it to simulation paramets afterwards */
@@ -149,7 +257,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache L2 lines set\n");
+                LOG_DEBUG("Cache L2 lines set\n");
                 break;
         
             /* Parse and validate cache L3 number of lines, and pass it to simulation paramets afterwards */
@@ -167,7 +275,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache L3 lines set\n");
+                LOG_DEBUG("Cache L3 lines set\n");
                 break;
 
             /* Parse and validate cache L1 latency, and pass it to simulation paramets afterwards */
@@ -178,7 +286,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache L1 latency set\n");
+                LOG_DEBUG("Cache L1 latency set\n");
                 break;
 
             /* Parse and validate cache L2 latency, and pass it to simulation paramets afterwards */
@@ -189,7 +297,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache L2 latency set\n");
+                LOG_DEBUG("Cache L2 latency set\n");
                 break;
 
             /* Parse and validate cache L3 latency, and pass it to simulation paramets afterwards */
@@ -200,7 +308,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache L3 latency set\n");
+                LOG_DEBUG("Cache L3 latency set\n");
                 break;
             
             /* Parse and validate number of cache levels, and pass it to simulation paramets afterwards */
@@ -216,7 +324,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Cache levels set\n");
+                LOG_DEBUG("Cache levels set\n");
                 break;
             
             /* Parse and validate mapping strategy, and pass it to simulation paramets afterwards */
@@ -232,7 +340,7 @@ int main(int argc, char** argv)
                     return EINVAL;
                 }
 
-                DEBUG_PRINT("Mapping strategy set\n");
+                LOG_DEBUG("Mapping strategy set\n");
                 break;
 
             /* Set debuggers mode */
@@ -241,7 +349,7 @@ int main(int argc, char** argv)
                 /* Set debug flag as true for debugging purposes */
                 debug = true;
 
-                DEBUG_PRINT("Debug set\n");
+                LOG_DEBUG("Debug set\n");
                 break;
 
             case 't':
@@ -249,8 +357,405 @@ int main(int argc, char** argv)
                 /* Set test flag as true for testing purposes */
                 test = true;
 
-                DEBUG_PRINT("Test set\n");
+                LOG_DEBUG("Test set\n");
+                break;
+
+            /* Trace options */
+
+            /* Parse and validate the window of requests to trace */
+            case OPT_TRACE_REQUESTS:
+
+                if (!parse_range(optarg, &options.trace.firstRequest, &options.trace.lastRequest, "trace requests")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Trace requests window set\n");
+                break;
+
+            /* Parse and validate the window of cycles to trace */
+            case OPT_TRACE_CYCLES:
+
+                if (!parse_range(optarg, &options.trace.firstCycle, &options.trace.lastCycle, "trace cycles")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Trace cycles window set\n");
+                break;
+
+            /* Signals to trace. Names are checked by the simulation, since it knows which signals exist */
+            case OPT_TRACE_SIGNALS:
+
+                options.trace.signals = optarg;
+
+                LOG_DEBUG("Trace signals set\n");
+                break;
+
+            /* Binary per-request log. The file is created by the simulation */
+            case OPT_EVENT_LOG:
+
+                options.eventLog = optarg;
+
+                LOG_DEBUG("Event log set\n");
+                break;
+
+            /* Live progress for a reader such as cache_application. The descriptor is inherited from the parent */
+            case OPT_PROGRESS_FD: {
+
+                uint32_t fd;
+                if (!parse_unsigned_int32(optarg, &fd, "progress descriptor")) {
+                    return EINVAL;
+                }
+                if (fd > INT32_MAX || fcntl((int) fd, F_GETFD) == -1) {
+                    fprintf(stderr, "Progress descriptor %s is not open.\n", optarg);
+                    return EINVAL;
+                }
+
+                /* A reader that goes away ends the progress, not the simulation */
+                signal(SIGPIPE, SIG_IGN);
+                options.progressFd = (int) fd;
+                LOG_DEBUG("Progress descriptor set\n");
+                break;
+            }
+
+            /* Host-side profiling. The simulation prints the report */
+            case OPT_PROFILE:
+
+                options.profile.enabled = true;
+
+                LOG_DEBUG("Profile set\n");
+                break;
+
+            /* Binary log of the events compiled in with LOG_LEVEL. Written when the program exits */
+            case OPT_LOG_FILE:
+
+                if (!log_open(optarg)) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Log file set\n");
+                break;
+
+            /* Shadow caches per level. The simulation prints the breakdown */
+            case OPT_MISS_CLASSES:
+
+                options.missClasses = true;
+
+                LOG_DEBUG("Miss classes set\n");
+                break;
+
+            /* Per-set, per-line and per-region miss counts. The simulation prints the report */
+            case OPT_HOTSPOTS:
+
+                if (!parse_unsigned_int32(optarg, &options.hotspots, "hotspots")) {
+                    return EINVAL;
+                }
+                if (options.hotspots == 0) {
+                    fprintf(stderr, "The hot-spot report needs at least one entry per list.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Hotspots set\n");
+                break;
+
+            /* Characterize the trace instead of simulating it */
+            case OPT_ANALYZE:
+
+                options.analyze.enabled = true;
+
+                LOG_DEBUG("Analyze set\n");
+                break;
+
+            case OPT_ANALYZE_WINDOW:
+
+                if (!parse_unsigned_int64(optarg, &options.analyze.window, "analyze window")) {
+                    return EINVAL;
+                }
+                if (options.analyze.window == 0) {
+                    fprintf(stderr, "The analyze window has to contain at least one request.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Analyze window set\n");
+                break;
+
+            /* Tuning options */
+
+            /* Search the hierarchies that fit the budget instead of simulating the given one */
+            case OPT_TUNE:
+
+                if (!parse_unsigned_int64(optarg, &options.tune.budget, "tune budget")) {
+                    return EINVAL;
+                }
+                /* The smallest candidate is a single level of 16 lines of 32 bytes */
+                if (options.tune.budget < 512) {
+                    fprintf(stderr, "The tuning budget has to be at least 512 bytes.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Tune budget set\n");
+                break;
+
+            /* Latency model of the candidates as BASE,PER_DOUBLING */
+            case OPT_TUNE_LATENCY: {
+
+                uint32_t model[2];
+                uint32_t count = 0;
+                if (!parse_unsigned_list(optarg, model, 2, &count, "tune latency")) {
+                    return EINVAL;
+                }
+                if (count != 2) {
+                    fprintf(stderr, "The tuning latency model needs two values: BASE,PER_DOUBLING.\n");
+                    return EINVAL;
+                }
+                options.tune.latencyBase        = model[0];
+                options.tune.latencyPerDoubling = model[1];
+
+                LOG_DEBUG("Tune latency set\n");
+                break;
+            }
+
+            /* Main memory options */
+
+            /* Parse and validate DRAM organization, and pass it to simulation options */
+            case OPT_DRAM_CHANNELS:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.channels, "DRAM channels")) {
+                    return EINVAL;
+                }
+
+                if (options.dram.channels == 0) {
+                    fprintf(stderr, "DRAM channels must be positive.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM channels set\n");
+                break;
+
+            case OPT_DRAM_RANKS:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.ranks, "DRAM ranks")) {
+                    return EINVAL;
+                }
+
+                if (options.dram.ranks == 0) {
+                    fprintf(stderr, "DRAM ranks must be positive.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM ranks set\n");
+                break;
+
+            case OPT_DRAM_BANKS:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.banks, "DRAM banks")) {
+                    return EINVAL;
+                }
+
+                if (options.dram.banks == 0) {
+                    fprintf(stderr, "DRAM banks must be positive.\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM banks set\n");
+                break;
+
+            case OPT_DRAM_ROW_SIZE:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.rowSize, "DRAM row size")) {
+                    return EINVAL;
+                }
+
+                /* Row size should be power of 2 */
+                if (!is_power_of_two(options.dram.rowSize))
+                {
+                    fprintf(stderr, "DRAM row size is not a power of 2: %u\n", options.dram.rowSize);
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM row size set\n");
+                break;
+
+            /* Parse and validate DRAM timings, and pass them to simulation options */
+            case OPT_DRAM_TRCD:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.tRCD, "DRAM tRCD")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM tRCD set\n");
+                break;
+
+            case OPT_DRAM_TCAS:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.tCAS, "DRAM tCAS")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM tCAS set\n");
+                break;
+
+            case OPT_DRAM_TRP:
+
+                if (!parse_unsigned_int32(optarg, &options.dram.tRP, "DRAM tRP")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM tRP set\n");
+                break;
+
+            case OPT_DRAM_PAGE_POLICY:
+
+                if (!parse_unsigned_int8(optarg, &options.dram.pagePolicy, "DRAM page policy")) {
+                    return EINVAL;
+                }
+
+                if (options.dram.pagePolicy > 1) {
+                    fprintf(stderr, "DRAM page policy is either 0 (Open page) or 1 (Closed page).\n");
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("DRAM page policy set\n");
+                break;
+
+            case OPT_BUS_WIDTH:
+
+                if (!parse_unsigned_list(optarg, options.bus.width, MAX_BUS_LINKS, &options.bus.numWidths, "bus width")) {
+                    return EINVAL;
+                }
+
+                for (uint32_t i = 0; i < options.bus.numWidths; i++) {
+                    if (options.bus.width[i] == 0) {
+                        fprintf(stderr, "Bus width must be positive: %s\n", optarg);
+                        return EINVAL;
+                    }
+                }
+
+                LOG_DEBUG("Bus width set\n");
                 break;
+
+            case OPT_BUS_FREQUENCY:
+
+                if (!parse_unsigned_list(optarg, options.bus.frequency, MAX_BUS_LINKS, &options.bus.numFrequencies, "bus frequency")) {
+                    return EINVAL;
+                }
+
+                for (uint32_t i = 0; i < options.bus.numFrequencies; i++) {
+                    if (options.bus.frequency[i] == 0) {
+                        fprintf(stderr, "Bus frequency must be positive: %s\n", optarg);
+                        return EINVAL;
+                    }
+                }
+
+                LOG_DEBUG("Bus frequency set\n");
+                break;
+
+            /* Workload options */
+
+            /* Format of requests.csv, detected from its first line by default */
+            case OPT_INPUT_FORMAT: {
+
+                int format = trace_format_from_name(optarg);
+                if (format < 0) {
+                    fprintf(stderr, "Unknown input format: %s. Please use --help to see valid formats.\n", optarg);
+                    return EINVAL;
+                }
+
+                options.input.format = (uint8_t) format;
+                LOG_DEBUG("Input format set\n");
+                break;
+            }
+
+            /* Parsing overlaps the simulation instead of preceding it */
+            case OPT_PIPELINE:
+
+                options.input.pipeline = true;
+
+                LOG_DEBUG("Pipeline set\n");
+                break;
+
+            case OPT_WORKLOAD:
+
+                if (!is_workload_name(optarg)) {
+                    fprintf(stderr, "Unknown workload: %s. Please use --help to see valid workloads.\n", optarg);
+                    return EINVAL;
+                }
+
+                options.workload.name = optarg;
+                LOG_DEBUG("Workload set\n");
+                break;
+
+            case OPT_WORKLOAD_REQUESTS:
+
+                if (!parse_unsigned_int64(optarg, &options.workload.requests, "workload requests")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Workload requests set\n");
+                break;
+
+            case OPT_WORKLOAD_SIZE:
+
+                if (!parse_unsigned_int32(optarg, &options.workload.size, "workload size")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Workload size set\n");
+                break;
+
+            case OPT_WORKLOAD_STRIDE:
+
+                if (!parse_unsigned_int32(optarg, &options.workload.stride, "workload stride")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Workload stride set\n");
+                break;
+
+            case OPT_WORKLOAD_BLOCK:
+
+                if (!parse_unsigned_int32(optarg, &options.workload.block, "workload block")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Workload block set\n");
+                break;
+
+            case OPT_SEED:
+
+                if (!parse_unsigned_int64(optarg, &options.workload.seed, "seed")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Seed set\n");
+                break;
+
+            /* Batch options */
+
+            /* Configurations are read after all options, since they default to the values given on the command line */
+            case OPT_BATCH:
+
+                batchFileName = optarg;
+
+                LOG_DEBUG("Batch file set\n");
+                break;
+
+            /* Levels are read after all options, since the cacheline size and mapping strategy default to the values given on the command line */
+            case OPT_HIERARCHY:
+
+                hierarchyFileName = optarg;
+
+                LOG_DEBUG("Hierarchy file set\n");
+                break;
+
+            case OPT_THREADS:
+
+                if (!parse_unsigned_int32(optarg, &options.batch.threads, "threads")) {
+                    return EINVAL;
+                }
+
+                LOG_DEBUG("Threads set\n");
+                break;
+
             /* Unrecognized option */
             case '?':
                 if (optopt) {
@@ -263,40 +768,210 @@ int main(int argc, char** argv)
         }
     }
 
-    /* No input file specified */
-    if (optind >= argc) {
-        fprintf(stderr, "No input file specified. Please run with --help.\n");
+    /* The number of banks depends on three options, so it is only checked once all of them are known */
+    if (!validate_memory_options(&options.dram, &options.bus)) {
+        return EINVAL;
+    }
+
+    /* Progress is reported by the simulation loop, the other modes don't run it */
+    if (options.progressFd >= 0 && (batchFileName || options.tune.budget || options.analyze.enabled)) {
+        fprintf(stderr, "--progress-fd can't be used with --batch, --tune or --analyze.\n");
         return EX_USAGE;
-    } 
-    
-    /* Get filename from last argument */
-    const char *filename = argv[optind];
-
-    /* Try to read into content buffer contents from file, specified by filename*/
-    char* content = read_file_to_buffer(filename);
-    if (!content){
-        /*Failed to write in buffer*/
-        return errno;
     }
 
-    /* Count how many requests in order to allocate memory accordingly */
-    uint32_t requests_size = count_requests(content);
+    /* Configurations of the batch mode and the search have a unified L1 */
+    if (options.l1i.numLines && (batchFileName || options.tune.budget)) {
+        fprintf(stderr, "--num-lines-l1i can't be used with --batch or --tune.\n");
+        return EX_USAGE;
+    }
+
+    /* The batch mode and the search describe their hierarchies themselves */
+    if (hierarchyFileName && (batchFileName || options.tune.budget || options.analyze.enabled)) {
+        fprintf(stderr, "--hierarchy can't be used with --batch, --tune or --analyze.\n");
+        return EX_USAGE;
+    }
+
+    /* Only a single simulation consumes the requests while they are parsed, the other modes need all of them up front */
+    if (options.input.pipeline && (batchFileName || options.tune.budget || options.analyze.enabled || options.workload.name)) {
+        fprintf(stderr, "--pipeline can't be used with --batch, --tune, --analyze or --workload.\n");
+        return EX_USAGE;
+    }
+
+    if (options.analyze.enabled) {
+
+        /* The analysis only streams the requests, there is no simulation to trace, check, log or profile */
+        if (batchFileName || test || traceFileName || options.eventLog || options.profile.enabled || options.missClasses || options.hotspots || options.tune.budget) {
+            fprintf(stderr, "--analyze can't be used with --batch, -t, --tf, --event-log, --profile, --miss-classes, --hotspots or --tune.\n");
+            return EX_USAGE;
+        }
+        if (options.workload.name && optind < argc) {
+            fprintf(stderr, "Either an input file or --workload can be given, not both.\n");
+            return EX_USAGE;
+        }
+        if (!options.workload.name && optind >= argc) {
+            fprintf(stderr, "No input file specified. Please run with --help.\n");
+            return EX_USAGE;
+        }
+
+        /* The trace is read line by line, so it doesn't have to fit in memory */
+        return run_analysis(options.workload.name ? NULL : argv[optind], cachelineSize, &options);
+    }
+
+    /* The search runs many functional simulations, there is no single run to trace, check or profile */
+    if (options.tune.budget && (batchFileName || test || traceFileName || options.eventLog || options.profile.enabled || options.missClasses || options.hotspots)) {
+        fprintf(stderr, "--tune can't be used with --batch, -t, --tf, --event-log, --profile, --miss-classes or --hotspots.\n");
+        return EX_USAGE;
+    }
+
+    if (hierarchyFileName) {
+
+        char* hierarchyContent = read_file_to_buffer(hierarchyFileName);
+        if (!hierarchyContent) {
+            return errno;
+        }
+
+        /* The levels of the file replace the ones given with -e, -L, -l, -N, -n and their long forms */
+        bool parsed = parse_hierarchy(hierarchyContent, &options.hierarchy, &cachelineSize, &mappingStrategy);
+        free(hierarchyContent);
+        if (!parsed) {
+            return EX_DATAERR;
+        }
+        numCacheLevels = options.hierarchy.numLevels;
+    }
+
+    CacheConfig* batchConfigs = NULL;
+
+    /* Reading and parsing the input is the first phase of the profile */
+    double parseStart = monotonic_seconds();
+
+    if (batchFileName) {
+
+        /* The batch mode only counts hits and misses, there is no single run to trace, check or profile */
+        if (test || traceFileName || options.eventLog || options.profile.enabled || options.missClasses || options.hotspots) {
+            fprintf(stderr, "--batch can't be used with -t, --tf, --event-log, --profile, --miss-classes or --hotspots.\n");
+            return EX_USAGE;
+        }
+
+        char* batchContent = read_file_to_buffer(batchFileName);
+        if (!batchContent) {
+            return errno;
+        }
+
+        /* Parameters missing in the batch file are taken from the command line */
+        CacheConfig base = {
+            .numCacheLevels  = numCacheLevels,
+            .cachelineSize   = cachelineSize,
+            .numLines        = {numLinesL1, numLinesL2, numLinesL3},
+            .latency         = {latencyCacheL1, latencyCacheL2, latencyCacheL3},
+            .mappingStrategy = mappingStrategy,
+            .dram            = options.dram,
+            .bus             = options.bus,
+            .line            = 0
+        };
+
+        batchConfigs = parse_batch_configs(batchContent, &base, &options.batch.numConfigs);
+        free(batchContent);
+        if (!batchConfigs) {
+            return EX_DATAERR;
+        }
+        options.batch.configs = batchConfigs;
+    }
+
+    char*     content       = NULL;
+    Request*  requests      = NULL;
+    uint32_t  requests_size = 0;
+
+    if (options.workload.name) {
+
+        /* Requests are generated by the simulation, there is nothing to read */
+        if (optind < argc) {
+            fprintf(stderr, "Either an input file or --workload can be given, not both.\n");
+            return EX_USAGE;
+        }
+
+        /* Generated reads carry no expected values */
+        if (test) {
+            fprintf(stderr, "Test mode needs expected values from an input file and can't be used with --workload.\n");
+            return EX_USAGE;
+        }
+    }
+    else {
+
+        /* No input file specified */
+        if (optind >= argc) {
+            fprintf(stderr, "No input file specified. Please run with --help.\n");
+            return EX_USAGE;
+        } 
+        
+        /* Get filename from last argument */
+        const char *filename = argv[optind];
+
+        if (options.input.format == TRACE_FORMAT_AUTO) {
+            int format = trace_format_of_file(filename);
+            if (format < 0) {
+                free(batchConfigs);
+                return EX_NOINPUT;
+            }
+            options.input.format = (uint8_t) format;
+        }
+    }
+
+    /* Other formats than CSV are read by the simulation request by request, so captures are simulated without a conversion.
+       A pipelined CSV trace is read the same way, by a parser thread of the simulation */
+    if (!options.workload.name && (options.input.format != TRACE_FORMAT_CSV || options.input.pipeline)) {
 
-    /* Allocate memory for requests */
-    Request* requests = (Request*) calloc(requests_size, sizeof(Request));
+        /* Only CSV traces carry expected values */
+        if (test && options.input.format != TRACE_FORMAT_CSV) {
+            fprintf(stderr, "Test mode needs expected values from a CSV file.\n");
+            free(batchConfigs);
+            return EX_USAGE;
+        }
+
+        /* A pipelined CSV trace is rejected like one read at once, if it is missing or empty */
+        if (options.input.format == TRACE_FORMAT_CSV && !check_trace_file(argv[optind])) {
+            free(batchConfigs);
+            return errno;
+        }
+
+        options.input.fileName = argv[optind];
+    }
+    else if (!options.workload.name) {
 
-    /* Try to form requests */
-    int err;
-    err = form_requests(content, requests);
-    if (err != 0) {
-        /* In the case of error, cleanup and return with an error*/
-        free(requests);
+        const char *filename = argv[optind];
+
+        /* Try to read into content buffer contents from file, specified by filename*/
+        content = read_file_to_buffer(filename);
+        if (!content){
+            /*Failed to write in buffer*/
+            return errno;
+        }
+
+        /* Count how many requests in order to allocate memory accordingly */
+        requests_size = count_requests(content);
+
+        /* Allocate memory for requests */
+        requests = (Request*) calloc(requests_size, sizeof(Request));
+
+        /* Try to form requests */
+        int err;
+        err = form_requests(content, requests);
+
+        /* The text isn't needed once parsed, so it doesn't stay resident during the simulation */
         free(content);
-        return EX_DATAERR;
+        content = NULL;
+
+        if (err != 0) {
+            /* In the case of error, cleanup and return with an error*/
+            free(requests);
+            free(batchConfigs);
+            return EX_DATAERR;
+        }
+
+        /* If debug mode enabled, print requests to the console output */
+        if (debug) print_requests(requests, requests_size);
     }
 
-    /* If debug mode enabled, print requests to the console output */
-    if (debug) print_requests(requests, requests_size);
+    options.profile.parseSeconds = monotonic_seconds() - parseStart;
     
     /* Run C++ SystemC simulation */
     Result result = run_simulation(
@@ -312,12 +987,14 @@ int main(int argc, char** argv)
         latencyCacheL3,
        mappingStrategy,
          requests_size,
-              requests
+              requests,
+              &options
     );
 
     /* Normal cleanup */
     free(requests);
     free(content);
+    free(batchConfigs);
 
     /* Programm ran successfuly*/
     return EXIT_SUCCESS;
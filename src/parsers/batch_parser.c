@@ -0,0 +1,178 @@
+#include "../../include/parsers/batch_parser.h"
+#include "../../include/parsers/numeric_parser.h"
+#include "../../util/helper_functions.h"
+#include <ctype.h>
+
+/*
+   * @brief               Sets a single parameter of a configuration. Keys are the long CLI options of the same parameter
+   *
+   * @param config        Configuration to change
+   * @param key           Name of the parameter, e.g. num-lines-l1
+   * @param value         String of the value. Validated with the same numeric parsers as the CLI
+   *
+   * @return              true if the key is known and the value is valid, false otherwise
+*/
+bool set_config_value(CacheConfig* config, const char* key, const char* value)
+{
+    if (strcmp(key, "num-cache-levels") == 0)  return parse_unsigned_int8(value, &config->numCacheLevels, key);
+    if (strcmp(key, "cacheline-size") == 0)    return parse_unsigned_int32(value, &config->cachelineSize, key);
+    if (strcmp(key, "num-lines-l1") == 0)      return parse_unsigned_int32(value, &config->numLines[0], key);
+    if (strcmp(key, "num-lines-l2") == 0)      return parse_unsigned_int32(value, &config->numLines[1], key);
+    if (strcmp(key, "num-lines-l3") == 0)      return parse_unsigned_int32(value, &config->numLines[2], key);
+    if (strcmp(key, "latency-cache-l1") == 0)  return parse_unsigned_int32(value, &config->latency[0], key);
+    if (strcmp(key, "latency-cache-l2") == 0)  return parse_unsigned_int32(value, &config->latency[1], key);
+    if (strcmp(key, "latency-cache-l3") == 0)  return parse_unsigned_int32(value, &config->latency[2], key);
+    if (strcmp(key, "mapping-strategy") == 0)  return parse_unsigned_int8(value, &config->mappingStrategy, key);
+    if (strcmp(key, "dram-channels") == 0)     return parse_unsigned_int32(value, &config->dram.channels, key);
+    if (strcmp(key, "dram-ranks") == 0)        return parse_unsigned_int32(value, &config->dram.ranks, key);
+    if (strcmp(key, "dram-banks") == 0)        return parse_unsigned_int32(value, &config->dram.banks, key);
+    if (strcmp(key, "dram-row-size") == 0)     return parse_unsigned_int32(value, &config->dram.rowSize, key);
+    if (strcmp(key, "dram-trcd") == 0)         return parse_unsigned_int32(value, &config->dram.tRCD, key);
+    if (strcmp(key, "dram-tcas") == 0)         return parse_unsigned_int32(value, &config->dram.tCAS, key);
+    if (strcmp(key, "dram-trp") == 0)          return parse_unsigned_int32(value, &config->dram.tRP, key);
+    if (strcmp(key, "dram-page-policy") == 0)  return parse_unsigned_int8(value, &config->dram.pagePolicy, key);
+    if (strcmp(key, "bus-width") == 0)         return parse_unsigned_list(value, config->bus.width, MAX_BUS_LINKS, &config->bus.numWidths, key);
+    if (strcmp(key, "bus-frequency") == 0)     return parse_unsigned_list(value, config->bus.frequency, MAX_BUS_LINKS, &config->bus.numFrequencies, key);
+
+    fprintf(stderr, "Unknown parameter: %s\n", key);
+    return false;
+}
+
+/*
+   * @brief               Applies the checks of the CLI that involve more than a single number
+   *
+   * @param config        Configuration to check
+   *
+   * @return              true if the configuration can be simulated, false otherwise
+*/
+bool validate_config(const CacheConfig* config)
+{
+    if (config->numCacheLevels < 1 || config->numCacheLevels > 3) {
+        fprintf(stderr, "Number of caches is between 1 and 3.\n");
+        return false;
+    }
+
+    if (!is_power_of_two(config->cachelineSize)) {
+        fprintf(stderr, "Number of cacheline size is not a power of 2: %u\n", config->cachelineSize);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < config->numCacheLevels; i++) {
+        if (!is_power_of_two(config->numLines[i])) {
+            fprintf(stderr, "Number of L%u cache lines is not a power of 2: %u\n", i + 1, config->numLines[i]);
+            return false;
+        }
+    }
+
+    if (config->mappingStrategy > 1) {
+        fprintf(stderr, "Mapping strategy is either 0 (Dirrect-mapped) or 1 (Fully-associative).\n");
+        return false;
+    }
+
+    if (!is_power_of_two(config->dram.rowSize)) {
+        fprintf(stderr, "DRAM row size is not a power of 2: %u\n", config->dram.rowSize);
+        return false;
+    }
+
+    if (config->dram.pagePolicy > 1) {
+        fprintf(stderr, "DRAM page policy is either 0 (Open page) or 1 (Closed page).\n");
+        return false;
+    }
+
+    return validate_memory_options(&config->dram, &config->bus);
+}
+
+/*
+   * @brief               Parses a batch file with one cache configuration per line
+   *
+   * Every line consists of whitespace separated key=value pairs, e.g. "num-cache-levels=2 num-lines-l1=64".
+   * Parameters that are not given are taken from base. Empty lines and everything after '#' are ignored.
+   *
+   * @param content       Content of the batch file
+   * @param base          Configuration given on the command line
+   * @param count         Pointer, where the number of configurations should be saved
+   *
+   * @return              Array of configurations, which has to be freed by the caller, or NULL if the file is invalid
+*/
+CacheConfig* parse_batch_configs(const char* content, const CacheConfig* base, uint32_t* count)
+{
+    /* Every configuration takes a line, so the number of lines bounds the number of configurations */
+    size_t capacity = 1;
+    for (const char* c = content; *c; c++) {
+        if (*c == '\n') capacity++;
+    }
+
+    CacheConfig* configs = (CacheConfig*) calloc(capacity, sizeof(CacheConfig));
+    if (!configs) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return NULL;
+    }
+
+    uint32_t parsed = 0;
+    uint32_t lineNumber = 0;
+    const char* line = content;
+
+    while (line && *line) {
+        lineNumber++;
+        const char* newline = strchr(line, '\n');
+        size_t lineLen = newline ? (size_t)(newline - line) : strlen(line);
+
+        /* Create a temporary copy of the line for tokenization */
+        char* lineCopy = strndup(line, lineLen);
+        if (!lineCopy) {
+            fprintf(stderr, "Memory allocation failed\n");
+            free(configs);
+            return NULL;
+        }
+
+        /* Strip the comment */
+        char* comment = strchr(lineCopy, '#');
+        if (comment) *comment = '\0';
+
+        CacheConfig config = *base;
+        config.line = lineNumber;
+        bool empty = true;
+
+        for (char* token = strtok(lineCopy, " \t\r"); token; token = strtok(NULL, " \t\r")) {
+            empty = false;
+
+            char* equals = strchr(token, '=');
+            if (!equals || equals == token || *(equals + 1) == '\0') {
+                fprintf(stderr, "Batch file line %u: expected key=value, got %s\n", lineNumber, token);
+                free(lineCopy);
+                free(configs);
+                return NULL;
+            }
+
+            *equals = '\0';
+            if (!set_config_value(&config, token, equals + 1)) {
+                fprintf(stderr, "Batch file line %u: invalid parameter\n", lineNumber);
+                free(lineCopy);
+                free(configs);
+                return NULL;
+            }
+        }
+
+        free(lineCopy);
+
+        if (!empty) {
+            if (!validate_config(&config)) {
+                fprintf(stderr, "Batch file line %u: invalid configuration\n", lineNumber);
+                free(configs);
+                return NULL;
+            }
+            configs[parsed++] = config;
+        }
+
+        line = newline ? newline + 1 : NULL;
+    }
+
+    if (parsed == 0) {
+        fprintf(stderr, "Batch file contains no configurations\n");
+        free(configs);
+        return NULL;
+    }
+
+    *count = parsed;
+    return configs;
+}
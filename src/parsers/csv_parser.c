@@ -1,341 +1,448 @@
 #include "../../include/parsers/csv_parser.h"
 #include <ctype.h>
 
-#define MAX_ALLOWED_BUFFER 14
+/* Word-at-a-time scanning: a 64-bit word holds 8 characters of the trace */
+#define SWAR_ONES  0x0101010101010101ULL
+#define SWAR_LOWS  0x7F7F7F7F7F7F7F7FULL
+
+/* Value + 1 of every hexadecimal digit, 0 for all other characters */
+static const unsigned char HEX_DIGITS[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,  ['6'] = 7,  ['7'] = 8,
+    ['8'] = 9,  ['9'] = 10, ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16
+};
+
+/* Outcome of parse_number */
+enum NumberStatus {
+    NUMBER_OK,
+    NUMBER_INVALID,
+    NUMBER_NEGATIVE,
+    NUMBER_OVERFLOW
+};
 
 /*
-   * @brief               Splits the content by line and returns pointer to new line in content
+   * @brief               Marks the bytes of a word that are equal to c, without false positives
+   *
+   * @param word          8 characters, the first one in the lowest byte
+   * @param c             Character to look for
+   *
+   * @return              0x80 in every byte equal to c, 0 in all other bytes
    *
-   * @param content       Pointer to content to read from
-   * @param type          Buffer for type of a request (either R or W)
-   * @param address       Buffer for address of a request
-   * @param data          Buffer for data of a request 
-   * 
-   * @return              Pointer to the next line in content or NULL, if there is no more lines
-   * 
-   * @copyright           This function was inspired by MiniAssembler homework submission 
 */
-char* split_next_line(const char* content, char* type, char* address, char* data) {
-    /* Find the end of the current line */
-    const char* newline = strchr(content, '\n');
-    size_t line_len = newline ? (size_t)(newline - content) : strlen(content);
+static inline uint64_t swar_equal(uint64_t word, unsigned char c)
+{
+    uint64_t x = word ^ (SWAR_ONES * c);
+    return ~(((x & SWAR_LOWS) + SWAR_LOWS) | x | SWAR_LOWS);
+}
 
-    /* Create a temporary copy of the line for tokenization */
-    char* line_copy = strndup(content, line_len);
-    if (!line_copy) return NULL;
+static inline uint64_t swar_load(const char* p)
+{
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
 
-    /* Skip empty or whitespace-only lines */
-    bool emptyLine = true;
-    for (size_t i = 0; i < line_len; i++) {
-        if (!isspace((unsigned char)line_copy[i])){
-            emptyLine = false;
-            break;
+/*
+   * @brief               Finds the end of the line starting at p and counts its commas, 8 characters at a time
+   *
+   * @param p             Start of the line
+   * @param end           End of the content
+   * @param commas        Pointer, where the number of commas of the line should be saved
+   *
+   * @return              Pointer to the '\n' ending the line, or end for the last line
+   *
+*/
+static const char* scan_line(const char* p, const char* end, unsigned* commas)
+{
+    unsigned count = 0;
+    for (; end - p >= 8; p += 8) {
+        uint64_t word     = swar_load(p);
+        uint64_t newlines = swar_equal(word, '\n');
+        uint64_t found    = swar_equal(word, ',');
+        if (newlines) {
+            /* Only the commas below the first newline belong to the line */
+            uint64_t first = newlines & (~newlines + 1);
+            *commas = count + __builtin_popcountll(found & (first - 1));
+            return p + __builtin_ctzll(first) / 8;
         }
+        count += __builtin_popcountll(found);
     }
-
-    if (emptyLine){
-        free(line_copy);
-        fprintf(stderr, "The file contains empty lines\n");
-        return PARSE_ERROR;
+    for (; p < end && *p != '\n'; p++) {
+        count += *p == ',';
     }
+    *commas = count;
+    return p;
+}
 
-    /* Count commas to ensure correct CSV format */
-    int comma_count = 0;
-    for (size_t i = 0; i < line_len; i++){
-        if (content[i] == ',') comma_count++;
-        else if (content[i] == '\0' || content[i] == '\n') {
-            free(line_copy);
-            return NULL;
+/*
+   * @brief               Parses a decimal or 0x- or 0X-prefixed hexadecimal number in place, the formats of the trace
+   *
+   * @param p             First character of the number
+   * @param end           End of the number
+   * @param max           Largest accepted value
+   * @param out           Pointer, where the value should be saved
+   *
+   * @return              NUMBER_OK or the reason the number was rejected
+   *
+*/
+static enum NumberStatus parse_number(const char* p, const char* end, uint64_t max, uint64_t* out)
+{
+    if (p < end && *p == '-') return NUMBER_NEGATIVE;
+
+    uint64_t value = 0;
+    bool overflow = false;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        /* Looked up instead of compared, random addresses mix digits and letters unpredictably */
+        for (p += 2; p < end; p++) {
+            int digit = HEX_DIGITS[(unsigned char)*p] - 1;
+            if (digit < 0) return NUMBER_INVALID;
+            overflow |= value >> 60 != 0;
+            value = value << 4 | (unsigned)digit;
         }
     }
-    if (comma_count < 2){
-        fprintf(stderr, "Missing fields: less than 3 columns\n");
-        free(line_copy);
-        return PARSE_ERROR;
+    else {
+        if (p == end) return NUMBER_INVALID;
+        for (; p < end; p++) {
+            unsigned digit = (unsigned char)*p - '0';
+            if (digit > 9) return NUMBER_INVALID;
+            overflow |= __builtin_mul_overflow(value, 10, &value);
+            overflow |= __builtin_add_overflow(value, digit, &value);
+        }
     }
 
-    /* Tokenization using space and comma delimetrs */
-    const char* delimiters = " ,";
+    if (overflow || value > max) return NUMBER_OVERFLOW;
+    *out = value;
+    return NUMBER_OK;
+}
 
-    /* Extract type */
-    char* token = strtok(line_copy, delimiters);
-    if (token) {
-        strncpy(type, token, 1);
-        type[1] = '\0';
-    } 
-    else {
-        fprintf(stderr, "Failed to parse type\n");
-        free(line_copy);
-        return PARSE_ERROR;
+/*
+   * @brief               Validates the address field of a request and reports why it is invalid
+   *
+   * @param field         First character of the field
+   * @param end           End of the field
+   * @param address       Pointer, where the address should be saved
+   *
+   * @return              true if the address is valid, false otherwise
+   *
+*/
+static bool parse_address_field(const char* field, const char* end, uint64_t* address)
+{
+    int length = (int)(end - field);
+    switch (parse_number(field, end, UINT64_MAX, address)) {
+        case NUMBER_OK:
+            return true;
+        case NUMBER_NEGATIVE:
+            fprintf(stderr, "Negative address is not allowed: %.*s\n", length, field);
+            return false;
+        case NUMBER_OVERFLOW:
+            fprintf(stderr, "Address exceeds uint64_t range: %.*s\n", length, field);
+            return false;
+        default:
+            fprintf(stderr, "Failed to parse address %.*s\n", length, field);
+            return false;
+    }
+}
+
+/*
+   * @brief               Validates the data field of a request and reports why it is invalid
+   *
+   * @param field         First character of the field
+   * @param end           End of the field
+   * @param data          Pointer, where the value should be saved
+   *
+   * @return              true if the value is valid, false otherwise
+   *
+*/
+static bool parse_data_field(const char* field, const char* end, uint32_t* data)
+{
+    int length = (int)(end - field);
+    uint64_t value;
+    switch (parse_number(field, end, UINT32_MAX, &value)) {
+        case NUMBER_OK:
+            *data = (uint32_t)value;
+            return true;
+        case NUMBER_NEGATIVE:
+            fprintf(stderr, "Negative data is not allowed: %.*s\n", length, field);
+            return false;
+        case NUMBER_OVERFLOW:
+            fprintf(stderr, "Value exceeds uint32_t range: %.*s\n", length, field);
+            return false;
+        default:
+            fprintf(stderr, "Failed to parse value %.*s\n", length, field);
+            return false;
     }
+}
 
-    /* Extract address */
-    token = strtok(NULL, delimiters);
-    if (token) {
-        strncpy(address, token, MAX_ALLOWED_BUFFER - 1);
-        address[MAX_ALLOWED_BUFFER - 1] = '\0';
+/*
+   * @brief               Parses a single line of the trace straight into a request, without copying the line
+   *
+   * A line has at least two commas and its fields are separated by commas and spaces: type (R, W or I for an
+   * instruction fetch), address, and data. Data is required by W, and by R only in test mode, where it is the
+   * expected value. I never has data.
+   *
+   * @param line          First character of the line
+   * @param length        Length of the line without the '\n'
+   * @param commas        Number of commas of the line
+   * @param lineNumber    Number of the line in the trace, starting at 1, for the error messages
+   * @param request       Pointer, where the request should be saved
+   *
+   * @return              true if the line is a valid request, false otherwise
+   *
+*/
+static bool parse_line(const char* line, size_t length, unsigned commas, unsigned long lineNumber, Request* request)
+{
+    const char* end = line + length;
+
+    /* Skip empty or whitespace-only lines */
+    const char* p = line;
+    while (p < end && isspace((unsigned char)*p)) p++;
+    if (p == end) {
+        fprintf(stderr, "The file contains empty lines (line %lu)\n", lineNumber);
+        return false;
     }
-    else { 
-        fprintf(stderr, "Failed to parse address\n");
-        free(line_copy);
-        return PARSE_ERROR;
+
+    if (commas < 2) {
+        fprintf(stderr, "Missing fields: less than 3 columns in line %lu\n", lineNumber);
+        return false;
     }
 
-    /* Extract data (may be optional) */
-    token = strtok(NULL, delimiters);
-    if (token) {
-        strncpy(data, token, MAX_ALLOWED_BUFFER - 1);
-        token[MAX_ALLOWED_BUFFER - 1] = '\0';
-    } 
-    else {
-        *data = '\0';
+    /* Split into at most 3 fields using space and comma delimiters */
+    const char* field[3];
+    const char* fieldEnd[3];
+    unsigned fields = 0;
+    for (p = line; ; ) {
+        while (p < end && (*p == ',' || *p == ' ')) p++;
+        if (p == end) break;
+
+        if (fields == 3) {
+            fprintf(stderr, "Unexpected extra data in line %lu\n", lineNumber);
+            return false;
+        }
+        field[fields] = p;
+        while (p < end && *p != ',' && *p != ' ') p++;
+        fieldEnd[fields++] = p;
     }
 
-    /* Check for anything extra after this */
-    token = strtok(NULL, delimiters);
-    if (token)
-    {
-        fprintf(stderr, "Unexpected extra data\n");
-        free(line_copy);
-        return PARSE_ERROR;
+    if (fields == 0) {
+        fprintf(stderr, "Failed to parse type in line %lu\n", lineNumber);
+        return false;
     }
+    if (fields == 1) {
+        fprintf(stderr, "Failed to parse address in line %lu\n", lineNumber);
+        return false;
+    }
+
+    Request req = {0};
+    bool hasData = fields == 3;
 
-    free(line_copy);    
-    
-    /* Return pointer to next line, or NULL if this was the last one */
-    if (!newline) return NULL;
-    return (char*)(newline + 1);
+    /* Determine request type by its first character */
+    if (*field[0] == 'W') {
+        req.w = 1;
+    }
+    else if (*field[0] == 'I') {
+        req.fetch = 1;
+    }
+    else if (*field[0] != 'R') {
+        fprintf(stderr, "Invalid type %.*s in line %lu\n", (int)(fieldEnd[0] - field[0]), field[0], lineNumber);
+        return false;
+    }
+
+    if (!parse_address_field(field[1], fieldEnd[1], &req.addr)) {
+        fprintf(stderr, "Invalid address in line %lu\n", lineNumber);
+        return false;
+    }
+
+    /* A fetched instruction has no expected value, not even in test mode */
+    if (req.fetch && hasData) {
+        fprintf(stderr, "Invalid data --- no data expected by instruction fetch in line %lu\n", lineNumber);
+        return false;
+    }
+    if (!req.w && hasData && !test) {
+        fprintf(stderr, "Invalid data --- no data expected by read in line %lu\n", lineNumber);
+        return false;
+    }
+    if (!req.w && !req.fetch && !hasData && test) {
+        fprintf(stderr, "Missing expected value for read request in test mode in line %lu\n", lineNumber);
+        return false;
+    }
+    if (req.w && !hasData) {
+        fprintf(stderr, "Missing data for write request in line %lu\n", lineNumber);
+        return false;
+    }
+
+    /* In test mode the data of a read is the expected value */
+    if (hasData && !parse_data_field(field[2], fieldEnd[2], &req.data)) {
+        fprintf(stderr, "Invalid %s in line %lu\n", req.w ? "data" : "expected value", lineNumber);
+        return false;
+    }
+
+    *request = req;
+    return true;
 }
 
 /*
    * @brief               Counts the number of memory request lines in the input content. A memory request is defined as a line, a sequence ending with '\n'
    *
    * @param content       Pointer to content to read from
-   * 
+   *
    * @return              The number of lines found in the content
-   * 
+   *
 */
 unsigned long count_requests(char* content)
 {
-    /* Use strdup so not to modify the original content */
-    size_t requestsCount = 0L;
-    char* requests = strdup(content);
-    char* ptr = requests;
-
-    /* Count lines */
-    while (*ptr){
-        if (*ptr == '\n'){
-            requestsCount++;
-        }
-        ptr++;
+    size_t length = strlen(content);
+    const char* p   = content;
+    const char* end = content + length;
+
+    /* Count newlines 8 characters at a time */
+    unsigned long requestsCount = 0;
+    for (; end - p >= 8; p += 8) {
+        requestsCount += __builtin_popcountll(swar_equal(swar_load(p), '\n'));
+    }
+    for (; p < end; p++) {
+        requestsCount += *p == '\n';
     }
 
     /* If the last character wasn't a newline, count the final line */
-    if (ptr != content && *(ptr-1) != '\n')
-    {
+    if (length > 0 && content[length - 1] != '\n') {
         requestsCount++;
     }
 
-    free(requests);
     return requestsCount;
 }
 
 /*
-   * @brief               Validates the string value and returns integer
+   * @brief               Validates the string value and stores it as 32-bit integer
+   *
+   * @param someValue     String of a value to validate, either in hexadecimal or decimal format
+   * @param value         Pointer to 32-bit unsigned integer, where validated value should be saved
+   *
+   * @return              true if the value is valid, false otherwise
    *
-   * @param someValue     String of a value to validate
-   * 
-   * @return              Validated integer value or parse error
-   * 
 */
-uint32_t validate_value(char* someValue)
+bool validate_value(char* someValue, uint32_t* value)
 {
-    /* Accept both hexadecimal and decimal format */
-    char* isEnd;
-    long value;
-    if (strncmp(someValue, "0x", 2) == 0){
-        value = strtol(someValue,&isEnd,16);
-    } 
-    else {
-        value = strtol(someValue,&isEnd,10);
-    }
-    /* Not a value check */
-    if (*isEnd != '\0')
-    {
-        fprintf(stderr, "Failed to parse value %lu\n", value);
-        return VALUE_ERROR;
-    }
-    /* Don't accept negative values */
-    if (value < 0) {
-        fprintf(stderr, "Negative data is not allowed: %li\n", value);
-        return VALUE_ERROR;
-    }
-
-    /* Don't accept overflow */
-    if (value > UINT32_MAX)
-    {
-        fprintf(stderr, "Value exceeds uint32_t range: %lu\n", value);
-        return VALUE_ERROR;
-    }
-
-    return (uint32_t)value;
+    return parse_data_field(someValue, someValue + strlen(someValue), value);
 }
 
 /*
-   * @brief               Parses a single memory request from raw string inputs and constructs a Request struct
-   *
-   * @param type          String indicating the request type
-   * @param address       String containing the address in hexadecimal or decimal format
-   * @param data          String representing the data (should be non-empty only for write requests)
-   * @param ok            Pointer to a boolean that will be set to true if the request was valid, false otherwise
-   * 
-   * @return              A filled Request struct if valid, otherwise a zeroed struct
-   * 
+   * @brief               Validates the string address and stores it as 64-bit integer
+   *
+   * @param someValue     String of an address to validate, either in hexadecimal or decimal format
+   * @param address       Pointer to 64-bit unsigned integer, where validated address should be saved
+   *
+   * @return              true if the address is valid, false otherwise
+   *
 */
-Request form_single_request(char* type, char* address, char* data, bool* ok)
+bool validate_address(char* someValue, uint64_t* address)
 {
-    Request req = {0};   /* Initialize requests */
-    *ok = false;        /*    Assume failure   */
-    bool isR = false;
-
-    /* Determine request type */
-    if (strncmp(type,"W",1) == 0){
-        req.w = 1;
-    }
-    else if (strncmp(type,"R",1) == 0){
-        req.w = 0;
-        isR   = true;
-    }
-    else {
-        printf("Invalid type\n");
-        return req;
-    }
-
-    /* Validate and assing address*/
-    uint32_t req_address = validate_value(address);
-    if (req_address == VALUE_ERROR){
-        printf("Invalid address\n");
-        return req;
-    } else {
-        req.addr = req_address;
-    }
-
-    /* Handle data based on request type */
-    uint32_t req_data;
-
-    /* Check data by R request. If debug mode is off, then R request should not include data */
-    if (isR && *data != '\0' && !test){
-        printf("Invalid data --- no data expected by read\n");
-        return req;
-
-    /* If debug mode is enabled, then CSV also includes expected values, so we write them 
-        Following condition for R is triggered only in debug mode */  
-    } else if (isR && test) {
-
-        /* Attention */
-        /* In this case "data" variable name could be misleading. 
-            We refer to expected value not data  */
-
-        /* if debug is enabled, then there should be third field by R request */
-        if (*data == '\0'){
-            printf("Missing expected value for read request in test mode\n");
-            return req;
-        }
-
-        /* Validate value and assign to Request data*/
-        req_data = validate_value(data);
-
-        if (req_data == VALUE_ERROR){
-            printf("Invalid expected value\n");
-            return req;
-        }
-        else {
-            req.data = req_data;
-        }
-
-
-    } else if (isR) {
-        /* Data is empty by read request without debugger mode, which is correct.
-            Do nothing...  */
-    } 
-    else {
-
-        /* Data empty for W request */
-        if (*data == '\0'){
-            printf("Missing data for write request\n");
-            return req;
-        }
-
-        /* Validate value and assign to Request data*/
-        req_data = validate_value(data);
-
-        if (req_data == VALUE_ERROR){
-            printf("Invalid data\n");
-            return req;
-        }
-        else {
-            req.data = req_data;
-        }
-    }
-
-    /* If function didn't return earlier, and response is ok */
-    *ok = true;
-    return req;
+    return parse_address_field(someValue, someValue + strlen(someValue), address);
 }
 
 /*
    * @brief               Receives content and forms requests out of it. If any of them is invalid, returns -1 indicating error
    *
+   * Every line is parsed in place and written straight into requests, nothing is allocated or copied.
+   *
    * @param content       String content to form requests from
-   * @param address       String containing the address in hexadecimal or decimal format
-   * 
+   * @param requests      Array of count_requests(content) requests to fill
+   *
    * @return              Returns either 0 indicating normal procedure or -1 indicating failure
-   * 
+   *
 */
 int form_requests(char* content, Request* requests)
 {
+    const char* p   = content;
+    const char* end = content + strlen(content);
+
+    /* Every '\n' starts another line, so the content can't end with one */
+    for (unsigned long lineNumber = 1; ; lineNumber++) {
+        unsigned commas;
+        const char* newline = scan_line(p, end, &commas);
 
-    /* Allocate memory for type, address and data of a single request */
-    char* type    = (char*) calloc(2, sizeof(char));
-    char* address = (char*) calloc(MAX_ALLOWED_BUFFER,sizeof(char));
-    char* data    = (char*) calloc(MAX_ALLOWED_BUFFER,sizeof(char));
-
-    /* Loop through content */
-    size_t request_counter = 0;
-    while(content){
-        /* Try to store type, address and data from a single line and return pointer to the next line */
-        content = split_next_line(content, type, address, data);
-
-        /* If a parse error happens, free resources and return an error */
-        if (content == PARSE_ERROR){
-            free(type);
-            free(address);
-            free(data);
+        if (!parse_line(p, (size_t)(newline - p), commas, lineNumber, &requests[lineNumber - 1])) {
+            fprintf(stderr, "Failed to form a request\n");
             return -1;
         }
 
-        /* Set a response for single request */
-        bool ok = false;
-        /* Try to form a single request */
-        Request request = form_single_request(type,address,data,&ok);
-        /* If response is not okay, free resources and return an error */
-        if (!ok) {
-            fprintf(stderr,"Failed to form a request\n");
-            free(type);
-            free(address);
-            free(data);
+        if (newline == end) return 0;
+        p = newline + 1;
+    }
+}
+
+/*
+   * @brief               Opens a trace file for reading it request by request
+   *
+   * @param stream        Stream to initialize
+   * @param filename      Path of the CSV file
+   *
+   * @return              true on success, false if the file can't be opened
+   *
+*/
+bool csv_stream_open(CsvStream* stream, const char* filename)
+{
+    memset(stream, 0, sizeof(*stream));
+    stream->file = fopen(filename, "r");
+    if (!stream->file) {
+        fprintf(stderr, "Error while opening file %s\n", filename);
+        return false;
+    }
+    stream->lineExpected = true;
+    return true;
+}
+
+/*
+   * @brief               Parses the next line of the trace file into a request, with the same rules as form_requests
+   *
+   * Like in form_requests, every '\n' starts another line, so an empty file or one ending with '\n' is invalid.
+   *
+   * @param stream        Stream opened by csv_stream_open
+   * @param request       Request to fill
+   *
+   * @return              1 if a request was read, 0 at the end of the file, -1 on an invalid line or a read error
+   *
+*/
+int csv_stream_next(CsvStream* stream, Request* request)
+{
+    ssize_t length = getline(&stream->line, &stream->capacity, stream->file);
+    if (length < 0) {
+        if (ferror(stream->file)) {
+            fprintf(stderr, "Error reading line %lu\n", stream->lineNumber + 1);
             return -1;
         }
+        if (!stream->lineExpected) return 0;
 
-        /* Store single request and increment the pointer */
-        requests[request_counter++] = request;
+        /* The empty last line is rejected by parse_line */
+        stream->lineExpected = false;
+        length = 0;
     }
+    stream->lineNumber++;
+
+    unsigned commas;
+    const char* newline = scan_line(stream->line, stream->line + length, &commas);
+    stream->lineExpected = newline != stream->line + length;
+    if (!parse_line(stream->line, (size_t)(newline - stream->line), commas, stream->lineNumber, request)) {
+        fprintf(stderr, "Failed to form a request in line %lu\n", stream->lineNumber);
+        return -1;
+    }
+    return 1;
+}
 
-    /* Normal cleanup */
-    free(type);
-    free(address);
-    free(data);
-
-    /* Success */
-    return 0;
-}
\ No newline at end of file
+/*
+   * @brief               Closes the file of the stream and frees its line buffer
+   *
+   * @param stream        Stream opened by csv_stream_open
+   *
+   * @return              void
+   *
+*/
+void csv_stream_close(CsvStream* stream)
+{
+    if (stream->file) fclose(stream->file);
+    free(stream->line);
+    stream->file = NULL;
+    stream->line = NULL;
+}
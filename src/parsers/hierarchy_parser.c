@@ -0,0 +1,181 @@
+#include "../../include/parsers/hierarchy_parser.h"
+#include "../../include/parsers/numeric_parser.h"
+#include "../../util/helper_functions.h"
+#include <ctype.h>
+
+/* Removes leading and trailing whitespace in place */
+static char* trim(char* text)
+{
+    while (isspace((unsigned char) *text)) text++;
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char) *(end - 1))) end--;
+    *end = '\0';
+    return text;
+}
+
+/* Level names end up in reports and VCD signal names, so they are restricted to [A-Za-z0-9_-] */
+static bool is_valid_level_name(const char* name)
+{
+    if (*name == '\0' || strlen(name) >= LEVEL_NAME_SIZE) return false;
+    for (const char* c = name; *c; c++) {
+        if (!isalnum((unsigned char) *c) && *c != '_' && *c != '-') return false;
+    }
+    return true;
+}
+
+/* Applies the checks of the CLI to a completed level section */
+static bool validate_level(const LevelConfig* level, bool hasLines, bool hasLatency)
+{
+    if (!hasLines || !hasLatency) {
+        fprintf(stderr, "Hierarchy file line %u: level %s needs lines and latency\n", level->line, level->name);
+        return false;
+    }
+    if (!is_power_of_two(level->numLines)) {
+        fprintf(stderr, "Hierarchy file line %u: number of %s cache lines is not a power of 2: %u\n",
+                level->line, level->name, level->numLines);
+        return false;
+    }
+    return true;
+}
+
+/*
+   * @brief               Parses a hierarchy file, an INI file with one section per cache level
+   *
+   * Sections are ordered from L1 towards main memory, their name is the name of the level, e.g. [eDRAM].
+   * Every section sets "lines" and "latency". "cacheline-size" and "mapping-strategy" before the first section
+   * override the values of the command line, in a section they only apply to that level. Empty lines and
+   * everything after '#' or ';' are ignored.
+   *
+   * @param content       Content of the hierarchy file
+   * @param hierarchy     Pointer, where the levels should be saved
+   * @param cachelineSize Cacheline size given on the command line, replaced if the file sets it
+   * @param mappingStrategy Mapping strategy given on the command line, replaced if the file sets it
+   *
+   * @return              true if the file describes a valid hierarchy, false otherwise
+*/
+bool parse_hierarchy(const char* content, HierarchyOptions* hierarchy, uint32_t* cachelineSize, uint8_t* mappingStrategy)
+{
+    memset(hierarchy, 0, sizeof(*hierarchy));
+
+    LevelConfig* level = NULL;
+    bool hasLines = false;
+    bool hasLatency = false;
+    uint32_t lineNumber = 0;
+    const char* line = content;
+
+    while (line && *line) {
+        lineNumber++;
+        const char* newline = strchr(line, '\n');
+        size_t lineLen = newline ? (size_t)(newline - line) : strlen(line);
+
+        char* lineCopy = strndup(line, lineLen);
+        line = newline ? newline + 1 : NULL;
+        if (!lineCopy) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return false;
+        }
+
+        /* Strip the comment */
+        lineCopy[strcspn(lineCopy, "#;")] = '\0';
+        char* text = trim(lineCopy);
+
+        bool valid = true;
+        if (*text == '\0') {
+            /* Nothing to do */
+        }
+        else if (*text == '[') {
+            size_t textLen = strlen(text);
+            if (text[textLen - 1] != ']') {
+                fprintf(stderr, "Hierarchy file line %u: expected [name], got %s\n", lineNumber, text);
+                valid = false;
+            }
+            else if (level && !validate_level(level, hasLines, hasLatency)) {
+                valid = false;
+            }
+            else if (hierarchy->numLevels == MAX_CACHE_LEVELS) {
+                fprintf(stderr, "Hierarchy file line %u: a hierarchy has at most %u levels\n", lineNumber, MAX_CACHE_LEVELS);
+                valid = false;
+            }
+            else {
+                text[textLen - 1] = '\0';
+                char* name = trim(text + 1);
+
+                if (!is_valid_level_name(name)) {
+                    fprintf(stderr, "Hierarchy file line %u: level names have 1 to %u letters, digits, '_' or '-', got %s\n",
+                            lineNumber, LEVEL_NAME_SIZE - 1, name);
+                    valid = false;
+                }
+                for (uint8_t i = 0; valid && i < hierarchy->numLevels; i++) {
+                    if (strcmp(hierarchy->levels[i].name, name) == 0) {
+                        fprintf(stderr, "Hierarchy file line %u: level %s is defined twice\n", lineNumber, name);
+                        valid = false;
+                    }
+                }
+
+                if (valid) {
+                    level = &hierarchy->levels[hierarchy->numLevels++];
+                    strcpy(level->name, name);
+                    level->cachelineSize = *cachelineSize;
+                    level->mappingStrategy = *mappingStrategy;
+                    level->line = lineNumber;
+                    hasLines = false;
+                    hasLatency = false;
+                }
+            }
+        }
+        else {
+            char* equals = strchr(text, '=');
+            if (!equals) {
+                fprintf(stderr, "Hierarchy file line %u: expected key = value, got %s\n", lineNumber, text);
+                valid = false;
+            }
+            else {
+                *equals = '\0';
+                const char* key = trim(text);
+                const char* value = trim(equals + 1);
+
+                if (level && strcmp(key, "lines") == 0) {
+                    valid = hasLines = parse_unsigned_int32(value, &level->numLines, key);
+                }
+                else if (level && strcmp(key, "latency") == 0) {
+                    valid = hasLatency = parse_unsigned_int32(value, &level->latency, key);
+                }
+                else if (strcmp(key, "cacheline-size") == 0) {
+                    uint32_t* size = level ? &level->cachelineSize : cachelineSize;
+                    valid = parse_unsigned_int32(value, size, key);
+                    if (valid && !is_power_of_two(*size)) {
+                        fprintf(stderr, "Number of cacheline size is not a power of 2: %u\n", *size);
+                        valid = false;
+                    }
+                }
+                else if (strcmp(key, "mapping-strategy") == 0) {
+                    uint8_t* mapping = level ? &level->mappingStrategy : mappingStrategy;
+                    valid = parse_unsigned_int8(value, mapping, key);
+                    if (valid && *mapping > 1) {
+                        fprintf(stderr, "Mapping strategy is either 0 (Dirrect-mapped) or 1 (Fully-associative).\n");
+                        valid = false;
+                    }
+                }
+                else {
+                    fprintf(stderr, "Unknown %s parameter: %s\n", level ? "level" : "hierarchy", key);
+                    valid = false;
+                }
+
+                if (!valid) {
+                    fprintf(stderr, "Hierarchy file line %u: invalid parameter\n", lineNumber);
+                }
+            }
+        }
+
+        free(lineCopy);
+        if (!valid) {
+            return false;
+        }
+    }
+
+    if (!level) {
+        fprintf(stderr, "Hierarchy file contains no levels\n");
+        return false;
+    }
+    return validate_level(level, hasLines, hasLatency);
+}
@@ -73,6 +73,35 @@ bool parse_unsigned_int32(const char* arg, uint32_t* out32, const char* name) {
     return true;
 }
 
+/* 
+   * @brief         Function to parse and write a value into 64 bit unsigned integer
+   *
+   * @param arg     The string from CLI that needs to be parsed
+   * @param out64   Pointer to 64-bit unsigned integer, where validated arg should be saved.
+   * @param name    The string containing supposed argument name. If it fails to be validated, the corresponding name will be given to the console
+   * 
+   * @return        - true if parsing succeeded
+   *                - false if parsing failed (out of range, invalid charachters, etc.). Programm should immidiately stop.
+   *    
+*/
+bool parse_unsigned_int64(const char* arg, uint64_t* out64, const char* name) {
+
+    unsigned long value;
+
+    /* Validate value */
+    if ((value = validate_value_decimal(arg, name)) == INVALID_VALUE) {
+        return false;
+    }
+
+    if (value == 0) {
+        fprintf(stderr, "Out of bounds %s: %s\n", name, arg);
+        return false;
+    }
+
+    *out64 = (uint64_t) value;
+    return true;
+}
+
 /* 
    * @brief         Function to parse and write a value into 8 bit unsigned integer
    *
@@ -102,4 +131,118 @@ bool parse_unsigned_int8(const char* arg, uint8_t* out8, const char* name) {
 
     /* Verification is successful. Return true as an indicator of success */
     return true;
-}
\ No newline at end of file
+}
+
+/* 
+   * @brief         Function to parse a half-open range "N:M" into two 32 bit unsigned integers
+   *
+   * @param arg     The string from CLI that needs to be parsed. M may be omitted ("N:"), then the range is open till UINT32_MAX
+   * @param first   Pointer to 32-bit unsigned integer, where the beginning of the range should be saved
+   * @param last    Pointer to 32-bit unsigned integer, where the end of the range should be saved
+   * @param name    The string containing supposed argument name. If it fails to be validated, the corresponding name will be given to the console
+   * 
+   * @return        - true if parsing succeeded
+   *                - false if parsing failed (missing colon, invalid numbers, empty range). Programm should immidiately stop.
+   *    
+*/
+bool parse_range(const char* arg, uint32_t* first, uint32_t* last, const char* name) {
+
+    const char* colon = strchr(arg, ':');
+
+    /* Range must contain a colon between its bounds */
+    if (!colon || colon == arg) {
+        fprintf(stderr, "Range is expected in format N:M %s: %s\n", name, arg);
+        return false;
+    }
+
+    /* Copy the beginning of the range, so it can be validated separately */
+    size_t first_len = (size_t)(colon - arg);
+    char* first_str = strndup(arg, first_len);
+    if (!first_str) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return false;
+    }
+
+    unsigned long first_value = validate_value_decimal(first_str, name);
+    free(first_str);
+    if (first_value == INVALID_VALUE) {
+        return false;
+    }
+
+    /* Missing end means the range is open */
+    unsigned long last_value = UINT32_MAX;
+    if (*(colon + 1) != '\0' && (last_value = validate_value_decimal(colon + 1, name)) == INVALID_VALUE) {
+        return false;
+    }
+
+    if (first_value > UINT32_MAX || last_value > UINT32_MAX) {
+        fprintf(stderr, "Out of bounds %s: %s\n", name, arg);
+        return false;
+    }
+
+    /* Empty ranges would produce an empty trace */
+    if (first_value >= last_value) {
+        fprintf(stderr, "Empty range %s: %s\n", name, arg);
+        return false;
+    }
+
+    *first = (uint32_t) first_value;
+    *last  = (uint32_t) last_value;
+
+    return true;
+}
+
+
+/* 
+   * @brief         Function to parse a comma separated list of positive 32 bit unsigned integers, e.g. "32,16,8"
+   *
+   * @param arg     The string from CLI that needs to be parsed
+   * @param out32   Array, where validated values should be saved
+   * @param max     Capacity of out32
+   * @param count   Pointer, where the number of parsed values should be saved
+   * @param name    The string containing supposed argument name. If it fails to be validated, the corresponding name will be given to the console
+   * 
+   * @return        - true if parsing succeeded
+   *                - false if parsing failed (empty or invalid element, too many elements). Programm should immidiately stop.
+   *    
+*/
+bool parse_unsigned_list(const char* arg, uint32_t* out32, uint32_t max, uint32_t* count, const char* name) {
+
+    uint32_t n = 0;
+    const char* element = arg;
+
+    while (true) {
+        const char* comma = strchr(element, ',');
+        size_t element_len = comma ? (size_t)(comma - element) : strlen(element);
+
+        if (element_len == 0) {
+            fprintf(stderr, "Empty element in list %s: %s\n", name, arg);
+            return false;
+        }
+
+        if (n == max) {
+            fprintf(stderr, "Too many elements (at most %u) %s: %s\n", max, name, arg);
+            return false;
+        }
+
+        /* Copy the element, so it can be validated separately */
+        char* element_str = strndup(element, element_len);
+        if (!element_str) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return false;
+        }
+
+        bool ok = parse_unsigned_int32(element_str, &out32[n], name);
+        free(element_str);
+        if (!ok) {
+            return false;
+        }
+        n++;
+
+        if (!comma) break;
+        element = comma + 1;
+    }
+
+    *count = n;
+    return true;
+}
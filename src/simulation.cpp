@@ -1,11 +1,32 @@
 #include "../include/simulation.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <string>
+#include <sysexits.h>
 #include "../util/helper_functions.h"
-#include "../include/cache.hpp"
+#include "../include/simulator.hpp"
+#include "../include/functional_model.hpp"
+#include "../include/auto_tuner.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/trace_analyzer.hpp"
+#include "../include/trace_reader.hpp"
+#include "../include/pipelined_source.hpp"
+#include "../include/profiler.hpp"
 #include "../include/structs/test.h"
 #include "../include/structs/debug.h"
 
 
+static void print_results(Result result)
+{
+    printf("\n\t\t======SIMULATION RESULTS======\n\
+            \tCycles: %u\n\
+            \tHits: %u\n\
+            \tMisses: %u\n\n",
+            result.cycles, result.hits, result.misses);
+}
+
 void print_simulation_results(Result result, uint32_t cycles, const char* tracefile,
                               uint8_t numCacheLevels, uint32_t cachelineSize,
                               uint32_t numLinesL1, uint32_t numLinesL2,
@@ -36,11 +57,267 @@ void print_simulation_results(Result result, uint32_t cycles, const char* tracef
             latencyCacheL3,
             mappingStrategy == 1 ? "Fully associative" : "Direct mapped"); 
 
-    printf("\n\t\t======SIMULATION RESULTS======\n\
+    print_results(result);
+}
+
+// Parameters of a run whose levels were read from a hierarchy file, one row per level
+static void print_hierarchy_parameters(uint32_t cycles, const char *tracefile, const SimulatorConfig &config)
+{
+    printf("\n\t\t======SIMULATION PARAMETRS======\n\
             \tCycles: %u\n\
-            \tHits: %u\n\
-            \tMisses: %u\n\n",
-            result.cycles, result.hits, result.misses);
+            \tTracefile: %s\n\
+            \tNumber of cache levels: %u\n\
+            \tMain memory line size: %u\n\n",
+            cycles,
+            tracefile ? tracefile : "none",
+            config.num_cache_levels,
+            config.memory_line_size());
+
+    printf("%16s %12s %12s %10s %18s\n", "Level", "Lines", "Latency", "Line size", "Mapping");
+    for (uint32_t i = 0; i < config.num_cache_levels; i++)
+        printf("%16s %12u %12u %10u %18s\n", config.level_name(i).c_str(), config.num_lines[i], config.latency[i],
+               config.line_size(i), config.mapping(i) == FULLY_ASSOCIATIVE ? "Fully associative" : "Direct mapped");
+}
+
+static void print_miss_classes(const std::vector<MissClasses> &levels, const SimulatorConfig &config)
+{
+    printf("\n\t\t======MISS CLASSES======\n");
+    printf("%6s %12s %12s %12s %12s\n", "Level", "Misses", "Compulsory", "Capacity", "Conflict");
+
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        const MissClasses &classes = levels[i];
+        printf("%6s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n", config.level_name(i).c_str(),
+               classes.total(), classes.compulsory, classes.capacity, classes.conflict);
+    }
+    printf("\n");
+}
+
+static double hit_rate(uint64_t hits, uint64_t requests)
+{
+    return requests > 0 ? static_cast<double>(hits) / static_cast<double>(requests) : 0.0;
+}
+
+// Requests and hits of both halves of a split L1, so the instruction footprint shows apart from the data
+static void print_split_l1(const RunResult &run, const SimulatorConfig &config)
+{
+    printf("\n\t\t======SPLIT L1======\n");
+    printf("%6s %12s %12s %12s %12s %10s\n", "Cache", "Lines", "Latency", "Requests", "Hits", "Hit rate");
+    printf("%6s %12u %12u %12" PRIu64 " %12" PRIu64 " %10.4f\n", "L1I", config.l1i_lines, config.l1i_latency,
+           run.fetches, run.fetch_hits, hit_rate(run.fetch_hits, run.fetches));
+    printf("%6s %12u %12u %12" PRIu64 " %12" PRIu64 " %10.4f\n", config.level_name(0).c_str(), config.num_lines[0],
+           config.latency[0], run.data_requests, run.data_hits, hit_rate(run.data_hits, run.data_requests));
+    printf("\n");
+}
+
+static SimulatorConfig to_simulator_config(const CacheConfig &cache_config)
+{
+    SimulatorConfig config;
+    config.num_cache_levels = cache_config.numCacheLevels;
+    config.cacheline_size = cache_config.cachelineSize;
+    for (int i = 0; i < 3; i++)
+    {
+        config.num_lines[i] = cache_config.numLines[i];
+        config.latency[i] = cache_config.latency[i];
+    }
+    config.mapping_strategy = cache_config.mappingStrategy;
+    config.dram = cache_config.dram;
+    config.bus = cache_config.bus;
+    return config;
+}
+
+// Joins the values of the active levels, e.g. "64/256"
+static std::string per_level(const uint32_t *values, uint8_t numCacheLevels)
+{
+    std::string joined;
+    for (uint8_t i = 0; i < numCacheLevels; i++)
+        joined += (i ? "/" : "") + std::to_string(values[i]);
+    return joined;
+}
+
+static void print_batch_results(const BatchOptions &batch, const std::vector<FunctionalRun> &runs,
+                         size_t numRequests, unsigned threads, double seconds)
+{
+    printf("\n\t\t======BATCH RESULTS======\n\
+            \tConfigurations: %u\n\
+            \tRequests per configuration: %zu\n\
+            \tThreads: %u\n\
+            \tWall time: %.3f s\n\n",
+            batch.numConfigs, numRequests, threads, seconds);
+
+    printf("%6s %6s %6s %16s %12s %8s %12s %12s %9s %12s %10s %9s\n",
+           "Line", "Levels", "Size", "Lines", "Latency", "Mapping",
+           "Hits", "Misses", "Hit rate", "Cycles", "Evictions", "Row hits");
+
+    for (uint32_t i = 0; i < batch.numConfigs; i++)
+    {
+        const CacheConfig &config = batch.configs[i];
+        const FunctionalRun &run = runs[i];
+        const uint64_t completed = run.result.hits + run.result.misses;
+
+        printf("%6u %6u %6u %16s %12s %8s %12u %12u %8.2f%% %11u%s %10" PRIu64 " %8.2f%%\n",
+               config.line, config.numCacheLevels, config.cachelineSize,
+               per_level(config.numLines, config.numCacheLevels).c_str(),
+               per_level(config.latency, config.numCacheLevels).c_str(),
+               config.mappingStrategy == FULLY_ASSOCIATIVE ? "FA" : "DM",
+               run.result.hits, run.result.misses,
+               completed ? 100.0 * run.result.hits / completed : 0.0,
+               run.result.cycles, run.cycle_limit_reached ? "*" : " ",
+               run.evictions, 100.0 * run.row_hit_rate);
+    }
+
+    printf("\nCycles are estimated by the functional model. * marks runs stopped by the cycle limit.\n");
+}
+
+// Stream of the requests that options select: a synthetic workload, a streamed trace file or the requests passed in.
+// Accesses of a capture are split at the boundaries of the shortest simulated line, shortestLine bytes
+static std::unique_ptr<RequestSource> make_request_source(uint32_t numRequests, Request *requests, const SimulationOptions *options,
+                                                          uint32_t shortestLine)
+{
+    if (options->workload.name != NULL)
+        return make_workload(options->workload);
+    if (options->input.fileName != NULL)
+        return make_trace_reader(options->input.fileName, options->input.format, shortestLine);
+    return std::unique_ptr<RequestSource>(new ArrayRequestSource(requests, numRequests));
+}
+
+// An invalid request of a streamed trace ends the program, like an invalid CSV trace does in the front end
+[[noreturn]] static void exit_invalid_trace(const std::runtime_error &error)
+{
+    std::cerr << error.what() << "\n";
+    std::exit(EX_DATAERR);
+}
+
+// Output files that can't be created are no fault of the trace
+[[noreturn]] static void exit_output_error(const std::runtime_error &error)
+{
+    std::cerr << error.what() << "\n";
+    std::exit(EX_CANTCREAT);
+}
+
+/*
+ * @brief                     Makes the requests that options select available as an array, for modes that share them between threads
+ *
+ * Workloads and streamed trace files are read into storage once up front, requests passed in are used in place.
+ *
+ * @return                    Number of requests, requests points to the first one
+ */
+static size_t gather_requests(uint32_t numRequests, Request *&requests, std::vector<Request> &storage, const SimulationOptions *options,
+                              uint32_t shortestLine)
+{
+    if (options->workload.name == NULL && options->input.fileName == NULL)
+        return numRequests;
+
+    try
+    {
+        std::unique_ptr<RequestSource> source = make_request_source(numRequests, requests, options, shortestLine);
+        Request request;
+        while (source->next(request))
+            storage.push_back(request);
+    }
+    catch (const std::runtime_error &error)
+    {
+        exit_invalid_trace(error);
+    }
+    requests = storage.data();
+    return storage.size();
+}
+
+/*
+ * @brief                     Simulates every configuration of options->batch against the same requests
+ *
+ * Configurations run on a work-stealing thread pool with the kernel-free functional model, since the
+ * SystemC kernel can only run one simulation per process. The requests are shared read-only between
+ * the threads, a synthetic workload or a streamed trace is read once up front.
+ */
+static void run_batch(uint32_t cycles, uint32_t numRequests, Request *requests, const SimulationOptions *options)
+{
+    const BatchOptions &batch = options->batch;
+
+    uint32_t shortestLine = UINT32_MAX;
+    for (uint32_t i = 0; i < batch.numConfigs; i++)
+        shortestLine = std::min(shortestLine, batch.configs[i].cachelineSize);
+
+    std::vector<Request> storage;
+    const size_t count = gather_requests(numRequests, requests, storage, options, shortestLine);
+
+    std::vector<FunctionalRun> runs(batch.numConfigs);
+    WorkStealingPool pool(batch.threads);
+
+    const auto start = std::chrono::steady_clock::now();
+    // the pool rethrows the first exception of a configuration, e.g. an address its levels can't hold
+    try
+    {
+        pool.run(batch.numConfigs, [&](size_t i) {
+            FunctionalHierarchy hierarchy(to_simulator_config(batch.configs[i]));
+            runs[i] = hierarchy.run(requests, count, cycles);
+        });
+    }
+    catch (const std::runtime_error &error)
+    {
+        exit_invalid_trace(error);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    print_batch_results(batch, runs, count, pool.size(), elapsed.count());
+}
+
+static void print_tune_results(const AutoTuner &tuner, size_t numRequests, unsigned threads, double seconds)
+{
+    printf("\n\t\t======AUTO-TUNING======\n\
+            \tCandidates: %zu\n\
+            \tRequests: %zu\n\
+            \tThreads: %u\n\
+            \tWall time: %.3f s\n\n",
+            tuner.candidates.size(), numRequests, threads, seconds);
+
+    printf("%6s %12s %12s\n", "Round", "Prefix", "Candidates");
+    for (size_t i = 0; i < tuner.rounds.size(); i++)
+        printf("%6zu %12" PRIu64 " %12zu\n", i, tuner.rounds[i].prefix, tuner.rounds[i].candidates);
+
+    printf("\nPareto front of AMAT against capacity:\n");
+    printf("%12s %10s %9s %6s %6s %16s %12s %8s\n",
+           "Capacity", "AMAT", "Hit rate", "Levels", "Line", "Lines", "Latency", "Mapping");
+    for (const TuneCandidate &candidate : tuner.pareto_front())
+    {
+        const SimulatorConfig &config = candidate.config;
+        printf("%12" PRIu64 " %10.3f %8.2f%% %6u %6u %16s %12s %8s\n",
+               candidate.capacity, candidate.amat, 100.0 * candidate.hit_rate,
+               config.num_cache_levels, config.cacheline_size,
+               per_level(config.num_lines, config.num_cache_levels).c_str(),
+               per_level(config.latency, config.num_cache_levels).c_str(),
+               config.mapping_strategy == FULLY_ASSOCIATIVE ? "FA" : "DM");
+    }
+
+    printf("\nAMAT is in cycles per request, estimated by the functional model.\n");
+}
+
+/*
+ * @brief                     Searches the hierarchies that fit options->tune.budget for the best AMAT per capacity
+ *
+ * Candidates take the main memory and buses of base. Like the batch mode, they run on a work-stealing
+ * thread pool with the functional model against requests shared read-only between the threads.
+ */
+static void run_tune(const SimulatorConfig &base, uint32_t numRequests, Request *requests, const SimulationOptions *options)
+{
+    std::vector<Request> storage;
+    const size_t count = gather_requests(numRequests, requests, storage, options, AutoTuner::MIN_LINE_SIZE);
+
+    try
+    {
+        AutoTuner tuner(base, options->tune);
+        WorkStealingPool pool(options->batch.threads);
+
+        const auto start = std::chrono::steady_clock::now();
+        tuner.run(requests, count, pool);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        print_tune_results(tuner, count, pool.size(), elapsed.count());
+    }
+    catch (const std::runtime_error &error)
+    {
+        exit_invalid_trace(error);
+    }
 }
 
 /*
@@ -58,9 +335,10 @@ void print_simulation_results(Result result, uint32_t cycles, const char* tracef
  * @param latencyCacheL3      Latency of L3 cache
  * @param mappingStrategy     Chosen mapping strategy for the simulation (0=Direct-mapped, 1=Fully associative)
  * @param numRequests         Number of requests to process
- * @param requests            Pointer to requests
+ * @param requests            Pointer to requests. Ignored if options select a synthetic workload or a streamed trace file
+ * @param options             Optional settings (trace window, workload, batch, ...). If passed as NULL, defaults are used
  *
- * @return
+ * @return                    Result of the simulation. Zero in batch and tuning mode, which print a result per configuration
  */
 Result run_simulation(
     uint32_t cycles,
@@ -75,157 +353,225 @@ Result run_simulation(
     uint32_t latencyCacheL3,
     uint8_t mappingStrategy,
     uint32_t numRequests,
-    Request *requests)
+    Request *requests,
+    const SimulationOptions *options)
 {
-    CACHE cache("cache",
-                numCacheLevels,
-                cachelineSize,
-                numLinesL1,
-                numLinesL2,
-                numLinesL3,
-                latencyCacheL1,
-                latencyCacheL2,
-                latencyCacheL3,
-                mappingStrategy);
-
-    sc_clock clk("clk", 10, SC_NS);
-
-    sc_signal<uint32_t> addr, wdata;
-    sc_signal<bool> r, w, stop;
-
-    sc_signal<uint32_t> rdata;
-    sc_signal<bool> ready, miss;
-
-    cache.clk(clk);
-    cache.addr(addr);
-    cache.wdata(wdata);
-    cache.r(r);
-    cache.w(w);
-
-    cache.rdata(rdata);
-    cache.ready(ready);
-    cache.miss(miss);
-
-    MAIN_MEMORY main_memory("main_memory", cachelineSize);
-
-    main_memory.clk(clk);
-
-
-    sc_signal<uint32_t> mem_addr_sig, mem_wdata_sig, mem_rdata_sig;
-    std::vector<sc_signal<uint8_t>> mem_cacheline_sig(cachelineSize);
-    sc_signal<bool> mem_r_sig, mem_w_sig, mem_ready_sig;
-
-    main_memory.addr(mem_addr_sig);
-    cache.mem_addr(mem_addr_sig);
-    main_memory.wdata(mem_wdata_sig);
-    cache.mem_wdata(mem_wdata_sig);
-    main_memory.r(mem_r_sig);
-    cache.mem_r(mem_r_sig);
-    main_memory.w(mem_w_sig);
-    cache.mem_w(mem_w_sig);
-    main_memory.rdata(mem_rdata_sig);
-
-    for (uint32_t i = 0; i < cachelineSize; i++)
-    {
-      main_memory.cacheline[i](mem_cacheline_sig[i]);
-      cache.mem_cacheline[i](mem_cacheline_sig[i]);
-    }
-
-    cache.mem_ready(mem_ready_sig);
-    main_memory.ready(mem_ready_sig);
-    main_memory.stop(stop);
-    cache.mem_stop(stop);
-
-    Result result;
-    result.cycles = 0;
-    result.hits = 0;
-    result.misses = 0;
-    Request request;
-
-    sc_trace_file *trace = NULL;
-
-    if (tracefile != NULL && is_valid_filename(tracefile))
-    {
-        trace = sc_create_vcd_trace_file(tracefile);
-        sc_trace(trace, clk, "clk");
-        sc_trace(trace, addr, "addr");
-        sc_trace(trace, wdata, "wdata");
-        sc_trace(trace, r, "r");
-        sc_trace(trace, w, "w");
-        sc_trace(trace, rdata, "rdata");
-        sc_trace(trace, ready, "ready");
-        sc_trace(trace, miss, "miss");
-    }
-
-    for (size_t request_index = 0; request_index < numRequests; request_index++) {
-        request = requests[request_index];
-
-        DEBUG_PRINT("SIMULATION: Request %zu: type=%s, addr = 0x%08X, data=0x%08X\n", request_index + 1,
-            request.w ? "W" : "R",
-            request.addr,
-            request.data);
-
-        addr.write(request.addr);
-        wdata.write(request.data);
-        r.write(!request.w);
-        w.write(request.w);
-
-        do {
-            DEBUG_PRINT("Clock %u: \n", result.cycles);
-            
-            if (result.cycles >= cycles) {
-                cache.print_caches();
-
-                print_simulation_results(result, cycles, tracefile,
-                              numCacheLevels, cachelineSize,
-                              numLinesL1, numLinesL2,
-                              numLinesL3, latencyCacheL1,
-                              latencyCacheL2, latencyCacheL3,
-                              mappingStrategy);
-                printf("Limit of cycles reached, stopping simulation.\n");
-                return result;
-            }
-            result.cycles++;
-
-            sc_start(10, SC_NS);
-
-        } while (!ready.read());
-
-        DEBUG_PRINT("SIMULATION: Read data: %u\n", cache.rdata.read());
-        if (test) {
-            if (debug) cache.print_caches();
-            if (!request.w && request.data != cache.rdata.read()) {
-                print_simulation_results(result, cycles, tracefile,
-                                    numCacheLevels, cachelineSize,
-                                    numLinesL1, numLinesL2,
-                                    numLinesL3, latencyCacheL1,
-                                    latencyCacheL2, latencyCacheL3,
-                                    mappingStrategy);
-                std::cerr << "\t\tError: Read data does not match expected data!\n";
-                printf("\t\tExpected data: %u, Read data: %u on Request %zu: type=%s, addr = 0x%08X, data=0x%08X\n", request.data, cache.rdata.read(), request_index + 1,
-                        request.w ? "W" : "R",
-                        request.addr,
-                        request.data);
-                return result;
-            }
+    SimulationOptions default_options;
+    if (options == NULL)
+    {
+        init_simulation_options(&default_options);
+        options = &default_options;
+    }
+
+    if (options->batch.configs != NULL)
+    {
+        run_batch(cycles, numRequests, requests, options);
+        return Result{0, 0, 0};
+    }
+
+    SimulatorConfig config;
+    config.num_cache_levels = numCacheLevels;
+    config.cacheline_size = cachelineSize;
+    config.num_lines[0] = numLinesL1;
+    config.num_lines[1] = numLinesL2;
+    config.num_lines[2] = numLinesL3;
+    config.latency[0] = latencyCacheL1;
+    config.latency[1] = latencyCacheL2;
+    config.latency[2] = latencyCacheL3;
+    config.mapping_strategy = mappingStrategy;
+    config.dram = options->dram;
+    config.bus = options->bus;
+    config.classify_misses = options->missClasses;
+    config.profile_conflicts = options->hotspots > 0;
+
+    const HierarchyOptions &hierarchy = options->hierarchy;
+    if (hierarchy.numLevels > 0)
+    {
+        config.num_cache_levels = hierarchy.numLevels;
+        for (uint8_t i = 0; i < hierarchy.numLevels; i++)
+        {
+            config.names[i] = hierarchy.levels[i].name;
+            config.num_lines[i] = hierarchy.levels[i].numLines;
+            config.latency[i] = hierarchy.levels[i].latency;
+            config.line_sizes[i] = hierarchy.levels[i].cachelineSize;
+            config.mappings[i] = hierarchy.levels[i].mappingStrategy;
+        }
+    }
+
+    // L1I sits beside the first level, of the options or of the hierarchy file
+    if (options->l1i.numLines > 0)
+    {
+        config.split_l1 = true;
+        config.l1i_lines = options->l1i.numLines;
+        config.l1i_latency = options->l1i.latency;
+    }
+
+    if (options->tune.budget > 0)
+    {
+        run_tune(config, numRequests, requests, options);
+        return Result{0, 0, 0};
+    }
+
+    const bool trace = tracefile != NULL && is_valid_filename(tracefile);
+    Profiler profiler;
+    profiler.add(PHASE_PARSE, options->profile.parseSeconds);
+
+    // Elaboration checks the parameters of the levels, buses and DRAM and opens the trace file
+    std::unique_ptr<Simulator> simulator;
+    std::unique_ptr<RequestSource> source;
+    try
+    {
+        {
+            PhaseTimer timer(profiler, PHASE_ELABORATE);
+            simulator.reset(new Simulator(config, trace ? tracefile : nullptr, &options->trace));
+        }
+        source = make_request_source(numRequests, requests, options, config.shortest_line_size());
+        if (options->input.pipeline)
+            source = std::unique_ptr<RequestSource>(new PipelinedSource(std::move(source)));
+    }
+    catch (const std::runtime_error &error)
+    {
+        exit_invalid_trace(error);
+    }
+
+    RunOptions run_options;
+    run_options.cycle_limit = cycles;
+    run_options.check_reads = test;
+    run_options.print_caches = debug;
+    run_options.event_log = options->eventLog;
+    run_options.progress_fd = options->progressFd;
+
+    RunResult run;
+    {
+        PhaseTimer timer(profiler, PHASE_SIMULATE);
+        try
+        {
+            run = simulator->run(*source, run_options);
+        }
+        catch (const EventLogError &error)
+        {
+            exit_output_error(error);
+        }
+        catch (const std::runtime_error &error)
+        {
+            exit_invalid_trace(error);
         }
-        if (miss.read()) result.misses++;
-        else result.hits++;
     }
+    // stops a pipelined parser that is still ahead of the simulation, e.g. at the cycle limit
+    source.reset();
+    Result result = run.result;
 
-    if (tracefile != NULL && trace != NULL)
-        sc_close_vcd_trace_file(trace);
-    
-    cache.print_caches();
+    auto report = [&]() {
+        if (run.status != RunStatus::READ_MISMATCH)
+            simulator->cache.print_caches();
 
-    print_simulation_results(result, cycles, tracefile,
-                              numCacheLevels, cachelineSize,
-                              numLinesL1, numLinesL2,
-                              numLinesL3, latencyCacheL1,
-                              latencyCacheL2, latencyCacheL3,
-                              mappingStrategy);
+        if (hierarchy.numLevels > 0)
+        {
+            print_hierarchy_parameters(cycles, tracefile, config);
+            print_results(result);
+        }
+        else
+            print_simulation_results(result, cycles, tracefile,
+                                      numCacheLevels, cachelineSize,
+                                      numLinesL1, numLinesL2,
+                                      numLinesL3, latencyCacheL1,
+                                      latencyCacheL2, latencyCacheL3,
+                                      mappingStrategy);
+        if (run.status == RunStatus::READ_MISMATCH)
+            return;
 
-    printf("\t\tSIMULATION: Simulation finished successfully with %.2f hit rate and %.2f%% efficiency\n", static_cast<double>(result.hits)/static_cast<double>(numRequests), 100.0 * static_cast<double>(numRequests * 100) / static_cast<double>(result.cycles) - 100.0);
+        simulator->print_statistics(result.cycles);
+        if (config.split_l1)
+            print_split_l1(run, config);
+        if (options->missClasses)
+            print_miss_classes(simulator->miss_classes(), config);
+        if (options->hotspots > 0)
+            simulator->print_conflict_profiles(options->hotspots);
+
+        if (run.status == RunStatus::CYCLE_LIMIT)
+        {
+            printf("Limit of cycles reached, stopping simulation.\n");
+            return;
+        }
+
+        printf("\t\tSIMULATION: Simulation finished successfully with %.2f hit rate and %.2f%% efficiency\n", static_cast<double>(result.hits)/static_cast<double>(run.requests), 100.0 * static_cast<double>(run.requests * 100) / static_cast<double>(result.cycles) - 100.0);
+    };
+    {
+        PhaseTimer timer(profiler, PHASE_REPORT);
+        report();
+    }
+
+    if (options->profile.enabled)
+    {
+        profiler.requests = run.requests;
+        profiler.sc_starts = run.sc_starts;
+        profiler.delta_cycles = run.delta_cycles;
+        std::copy(run.activations, run.activations + NUM_PROFILED_MODULES, profiler.activations);
+        profiler.level_bytes = simulator->level_memory();
+        profiler.print();
+    }
 
     return result;
 }
+
+/*
+ * @brief                     Characterizes a trace or a synthetic workload in a single pass, without a simulation
+ *
+ * @param filename            Trace read line by line in options->input.format, NULL to analyze options->workload instead
+ * @param cachelineSize       Line size of the reuse distances and working sets
+ * @param options             Workload and analyzer settings
+ *
+ * @return                    EXIT_SUCCESS, or EX_DATAERR if the trace contains an invalid request
+ */
+int run_analysis(const char *filename, uint32_t cachelineSize, const SimulationOptions *options)
+{
+    try
+    {
+        std::unique_ptr<RequestSource> source;
+        if (filename == NULL)
+            source = make_workload(options->workload);
+        else
+            source = make_trace_reader(filename, options->input.format, cachelineSize);
+
+        TraceAnalyzer analyzer(cachelineSize, options->analyze.window);
+        Request request;
+        while (source->next(request))
+            analyzer.add(request);
+        analyzer.finish();
+        analyzer.print();
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << "\n";
+        return EX_DATAERR;
+    }
+    return EXIT_SUCCESS;
+}
+
+bool is_workload_name(const char *name)
+{
+    for (const auto &workload : workload_names())
+        if (workload == name) return true;
+    return false;
+}
+
+int trace_format_from_name(const char *name)
+{
+    const std::vector<std::string> &names = trace_format_names();
+    for (size_t i = 0; i < names.size(); i++)
+        if (names[i] == name) return static_cast<int>(i);
+    return -1;
+}
+
+int trace_format_of_file(const char *filename)
+{
+    try
+    {
+        return detect_trace_format(filename);
+    }
+    catch (const std::runtime_error &error)
+    {
+        std::cerr << error.what() << "\n";
+        return -1;
+    }
+}
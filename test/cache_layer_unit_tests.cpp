@@ -80,7 +80,7 @@ void assert_data(const std::string &test_name, const std::vector<uint8_t> &expec
     }
 }
 
-void test_direct_mapped_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
+void test_direct_mapped_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
                                  const sc_signal<bool> &miss, const sc_signal<bool> &ready, const sc_signal<uint32_t> &data)
 {
     // Address: 0x00010008 -> Tag=0x00010, Index=0, Offset=0x8 | Offset-Bits = 4, Index-Bits = 2
@@ -105,7 +105,7 @@ void test_direct_mapped_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &
     assert_bool_layer("DirectMappedHit_Ready", true, ready.read());
 }
 
-void test_direct_mapped_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
+void test_direct_mapped_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
                                   const sc_signal<bool> &miss, const sc_signal<bool> &ready, sc_signal<uint32_t> &data)
 {
     // Address: 0x00010008, false Tag
@@ -124,7 +124,7 @@ void test_direct_mapped_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t>
     assert_bool_layer("DirectMappedMiss_Ready", true, ready.read());
 }
 
-void test_direct_mapped_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
+void test_direct_mapped_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
 {
     // Address: 0x0001000E, Offset=0xE
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -139,7 +139,7 @@ void test_direct_mapped_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint3
     assert_bool_layer("DirectMappedInvalidOffset", true, cache_layer.error);
 }
 
-void test_fully_associative_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
+void test_fully_associative_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
                                      const sc_signal<bool> &miss, const sc_signal<bool> &ready, const sc_signal<uint32_t> &data)
 {
     cache_layer.mapping_strategy = 1; // Fully associative
@@ -154,7 +154,7 @@ void test_fully_associative_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_
     memory[1].data[11] = 0x87; // MSB
 
     std::list<uint32_t> lru = {1};
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
     lru_map[0x1000000] = lru.begin();
 
     cache_layer.set_memory(memory, lru, lru_map);
@@ -171,13 +171,13 @@ void test_fully_associative_read_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_
     assert_equal_layer("FullyAssociativeHit_LRU", 1, cache_layer.lru_list.front());
 }
 
-void test_fully_associative_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
+void test_fully_associative_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w,
                                       const sc_signal<bool> &miss, const sc_signal<bool> &ready)
 {
     cache_layer.mapping_strategy = 1; // Fully associative
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
     std::list<uint32_t> lru;
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
 
     cache_layer.set_memory(memory, lru, lru_map);
     addr.write(0x10000008);
@@ -190,7 +190,7 @@ void test_fully_associative_read_miss(CACHE_LAYER &cache_layer, sc_signal<uint32
     assert_bool_layer("FullyAssociativeMiss_Ready", true, ready.read());
 }
 
-void test_fully_associative_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
+void test_fully_associative_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
 {
     cache_layer.mapping_strategy = 1; // Fully associative
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -203,7 +203,7 @@ void test_fully_associative_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<u
     assert_bool_layer("FullyAssociativeInvalidOffset", true, cache_layer.error);
 }
 
-void test_direct_mapped_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
+void test_direct_mapped_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
 {
     cache_layer.mapping_strategy = 0; // Direct-Mapped
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -235,7 +235,7 @@ void test_direct_mapped_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t>
     assert_data("DirectMappedWriteHit_Data", expected_data, cache_layer.cache_memory[0].data);
 }
 
-void test_direct_mapped_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
+void test_direct_mapped_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
 {
     cache_layer.mapping_strategy = 0; // Direct-Mapped
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -258,7 +258,7 @@ void test_direct_mapped_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t>
     assert_data("DirectMappedWriteMiss_Data", expected_data, cache_layer.cache_memory[0].data);
 }
 
-void test_direct_mapped_write_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
+void test_direct_mapped_write_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
 {
     cache_layer.mapping_strategy = 0; // Direct-Mapped
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -272,7 +272,7 @@ void test_direct_mapped_write_invalid_offset(CACHE_LAYER &cache_layer, sc_signal
     assert_bool_layer("DirectMappedWriteInvalidOffset", true, cache_layer.error);
 }
 
-void test_fully_associative_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
+void test_fully_associative_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
 {
     cache_layer.mapping_strategy = 1; // Fully-Associative
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -284,7 +284,7 @@ void test_fully_associative_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint32
     memory[1].data[11] = 0x12;
 
     std::list<uint32_t> lru = {1};
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
     lru_map[0x1000000] = lru.begin();
 
     cache_layer.set_memory(memory, lru, lru_map);
@@ -308,12 +308,12 @@ void test_fully_associative_write_hit(CACHE_LAYER &cache_layer, sc_signal<uint32
     assert_data("FullyAssociativeWriteHit_Data", expected_data, cache_layer.cache_memory[1].data);
 }
 
-void test_fully_associative_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
+void test_fully_associative_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<uint32_t> &wdata, sc_signal<bool> &r, sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready)
 {
     cache_layer.mapping_strategy = 1; // Fully-Associative
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
     std::list<uint32_t> lru;
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
 
     cache_layer.set_memory(memory, lru, lru_map);
     addr.write(0x10000008); // Tag=0x1000000, Offset=8
@@ -331,7 +331,7 @@ void test_fully_associative_write_miss(CACHE_LAYER &cache_layer, sc_signal<uint3
     assert_data("FullyAssociativeWriteMiss_Data", expected_data, cache_layer.cache_memory[0].data);
 }
 
-void test_fully_associative_write_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint32_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
+void test_fully_associative_write_invalid_offset(CACHE_LAYER &cache_layer, sc_signal<uint64_t> &addr, sc_signal<bool> &r, sc_signal<bool> &w)
 {
     cache_layer.mapping_strategy = 1; // Fully-Associative
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
@@ -367,7 +367,7 @@ void test_write_cacheline_fully_associative_not_full(CACHE_LAYER &cache_layer)
     cache_layer.mapping_strategy = 1;
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
     std::list<uint32_t> lru = {0};
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
     lru_map[0x2000000] = lru.begin();
     memory[0].tag = 0x2000000;
     memory[0].valid = true;
@@ -395,7 +395,7 @@ void test_write_data_from_main_memory_fully_associative_full(CACHE_LAYER &cache_
     cache_layer.mapping_strategy = 1;
     std::vector<CacheLine> memory(4, {0, false, std::vector<uint8_t>(16)});
     std::list<uint32_t> lru = {0, 1, 2, 3}; // LRU: 3
-    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> lru_map;
+    std::unordered_map<uint64_t, std::list<uint32_t>::iterator> lru_map;
     for (uint32_t i = 0; i < 4; ++i)
     {
         memory[i].tag = 0x1000000 + i;
@@ -433,7 +433,8 @@ void test_write_cacheline_invalid_strategy(CACHE_LAYER &cache_layer)
 void sc_main()
 {
     sc_clock clk("clk1", 10, SC_NS);
-    sc_signal<uint32_t> addr, wdata;
+    sc_signal<uint64_t> addr;
+    sc_signal<uint32_t> wdata;
     sc_signal<bool> r, w, miss, ready;
     sc_signal<uint32_t> data;
     CACHE_LAYER cache_layer("cache_layer", 0, 4, 16, 0, 0); // Default: direct-mapped
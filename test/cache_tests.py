@@ -1,12 +1,14 @@
 import unittest
 import subprocess
 import os
+import struct
 
 class CacheProgramTests(unittest.TestCase):
     def setUp(self):
         self.binary = "./project"
 
         self.valid_file = "test/inputs/valid_data.csv"
+        self.valid_64bit_file = "test/inputs/valid_data_64bit.csv"
         self.expected_values_file = "test/inputs/expected_values.csv"
         self.invalid_files = [
             "test/inputs/invalid_data1.csv",
@@ -25,9 +27,17 @@ class CacheProgramTests(unittest.TestCase):
             "test/inputs/invalid_data14.csv",
             "test/inputs/invalid_data15.csv",
             "test/inputs/invalid_data16.csv",
+            "test/inputs/invalid_data19.csv",
+            "test/inputs/invalid_data20.csv",
             "test/inputs/restricted.csv"
         ]
         self.nonexistent_file = "test/inputs/does_not_exist.csv"
+        self.unaligned_file = "test/inputs/unaligned_data.lackey"
+        self.capture_files = [
+            "test/inputs/valid_data.jsonl",
+            "test/inputs/valid_data.lackey",
+            "test/inputs/valid_data.memtrace"
+        ]
 
         self.flags = [
             "-c",
@@ -160,6 +170,408 @@ class CacheProgramTests(unittest.TestCase):
         ])
         self.assertEqual(result.returncode,0)
 
+    def test_64bit_addresses(self):
+        # Addresses differ only above bit 32, truncating them would return the wrong value
+        result = self.run_cache([
+            "-t",
+            self.valid_64bit_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertNotIn("does not match", result.stderr)
+
+    def test_hex_prefix(self):
+        # 0X prefixes are hexadecimal too, and the largest value is data like any other
+        result = self.run_cache(["-t", "test/inputs/valid_data_prefix.csv"])
+        self.assertEqual(result.returncode, 0)
+        self.assertNotIn("does not match", result.stderr)
+
+    def test_address_overflow(self):
+        result = self.run_cache([
+            "test/inputs/invalid_data18.csv"
+        ])
+        self.assertNotEqual(result.returncode, 0)
+
+    def test_trace_window(self):
+        result = self.run_cache([
+            "-f", "tracefile",
+            "--trace-requests", "1:2",
+            "--trace-cycles", "0:",
+            "--trace-signals", "clk,addr,L1.miss,L1.ready,mem.ready",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+
+    def test_invalid_trace_window(self):
+        for window in ["2:1", "5", ":5", "a:5"]:
+            with self.subTest(window=window):
+                result = self.run_cache([
+                    "-f", "tracefile",
+                    "--trace-requests", window,
+                    self.valid_file
+                ])
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_event_log(self):
+        log_file = "test_event_log.bin"
+        result = self.run_cache([
+            "--event-log", log_file,
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+
+        with open(log_file, "rb") as f:
+            content = f.read()
+        os.remove(log_file)
+
+        magic, version, record_size = struct.unpack_from("<4sII", content)
+        self.assertEqual(magic, b"CSEL")
+        self.assertEqual(record_size, 24)
+
+        records = [struct.unpack_from("<QIIHBB", content, 12 + i * record_size)
+                   for i in range((len(content) - 12) // record_size)]
+        # valid_data.csv: W 0x10, R 0x10, W 123
+        self.assertEqual([r[1] for r in records], [0, 1, 2])
+        self.assertEqual([r[0] for r in records], [0x10, 0x10, 123])
+        self.assertEqual([r[4] for r in records], [1, 0, 1])
+
+    def test_event_log_not_created(self):
+        log_file = "test/inputs/missing_dir/event_log.bin"
+        result = self.run_cache(["--event-log", log_file, self.valid_file])
+        self.assertEqual(result.returncode, 73)  # EX_CANTCREAT
+        self.assertIn(log_file, result.stderr)
+
+    def test_event_log_not_written(self):
+        # /dev/full can be opened, but every write fails with ENOSPC
+        result = self.run_cache(["--event-log", "/dev/full", self.valid_file])
+        self.assertEqual(result.returncode, 73)  # EX_CANTCREAT
+        self.assertIn("/dev/full", result.stderr)
+
+    def test_dram_options(self):
+        for policy in ["0", "1"]:
+            with self.subTest(policy=policy):
+                result = self.run_cache([
+                    "--dram-channels", "2",
+                    "--dram-ranks", "2",
+                    "--dram-banks", "4",
+                    "--dram-row-size", "1024",
+                    "--dram-trcd", "10",
+                    "--dram-tcas", "12",
+                    "--dram-trp", "14",
+                    "--dram-page-policy", policy,
+                    self.valid_file
+                ])
+                self.assertEqual(result.returncode, 0)
+                self.assertIn("Row buffer hit rate", result.stdout)
+
+    def test_false_dram_options(self):
+        # Invalid options are errors of the command line (EINVAL), not of the trace
+        for args in [["--dram-page-policy", "2"], ["--dram-row-size", "1000"], ["--dram-banks", "0"],
+                     ["--dram-channels", "0"], ["--dram-ranks", "0"],
+                     ["--dram-channels", "65536", "--dram-ranks", "65536", "--dram-banks", "1"],
+                     ["--dram-channels", "2048", "--dram-ranks", "2048", "--dram-banks", "1024"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + [self.valid_file])
+                self.assertEqual(result.returncode, 22)
+
+    def test_bus_options(self):
+        result = self.run_cache([
+            "--bus-width", "32,16,8",
+            "--bus-frequency", "100,50",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("Link utilization", result.stdout)
+        self.assertIn("L3 <-> main memory (8 B @ 50 MHz)", result.stdout)
+
+    def test_false_bus_options(self):
+        for args in [["--bus-width", "0"], ["--bus-width", "32,,16"], ["--bus-frequency", "100,"],
+                     ["--bus-width", "1,2,3,4,5,6,7,8,9"], ["--bus-width", "32,0"], ["--bus-frequency", "0"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + [self.valid_file])
+                self.assertEqual(result.returncode, 22)  # EINVAL
+
+    def test_workloads(self):
+        for args in [["--workload", "matmul", "--workload-size", "4"],
+                     ["--workload", "matmul-blocked", "--workload-size", "4", "--workload-block", "2"],
+                     ["--workload", "stencil", "--workload-size", "4"],
+                     ["--workload", "zipf", "--workload-size", "256", "--workload-requests", "200", "--seed", "7"],
+                     ["--workload", "pointer-chase", "--workload-size", "64"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertEqual(result.returncode, 0)
+                self.assertIn("Simulation finished successfully", result.stdout)
+
+    def test_invalid_workloads(self):
+        for args in [["--workload", "unknown"], ["--workload", "copy", self.valid_file],
+                     ["--workload", "copy", "-t"], ["--workload", "random", "--seed", "0"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_profile(self):
+        result = self.run_cache([
+            "--profile",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("PROFILE", result.stdout)
+        self.assertIn("Delta cycles", result.stdout)
+        self.assertIn("Activations CACHE_LAYER", result.stdout)
+
+    def test_miss_classes(self):
+        result = self.run_cache([
+            "--miss-classes",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("MISS CLASSES", result.stdout)
+        self.assertIn("Compulsory", result.stdout)
+        self.assertIn("Conflict", result.stdout)
+
+    def test_hotspots(self):
+        result = self.run_cache([
+            "--hotspots", "5",
+            "--mapping-strategy", "0",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("CONFLICT HOT SPOTS L1", result.stdout)
+        self.assertIn("Set pressure", result.stdout)
+        self.assertIn("Top 4 KiB regions", result.stdout)
+
+    def test_invalid_hotspots(self):
+        for args in [["--hotspots", "0"], ["--hotspots", "-1"], ["--hotspots", "5", "--analyze"],
+                     ["--hotspots", "5", "--batch", "test/inputs/batch_configs.txt"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + [self.valid_file])
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_analyze(self):
+        result = self.run_cache([
+            "--analyze",
+            "--analyze-window", "2",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("TRACE ANALYSIS", result.stdout)
+        self.assertIn("Reuse distance", result.stdout)
+        self.assertIn("Working set", result.stdout)
+
+    def test_invalid_analyze(self):
+        for args in [["--analyze", "-t", self.valid_file], ["--analyze", "--analyze-window", "0", self.valid_file],
+                     ["--analyze", "--workload", "zipf", self.valid_file], ["--analyze"],
+                     ["--analyze", "test/inputs/invalid_data1.csv"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_input_formats(self):
+        # The captures hold the same accesses, a Lackey modify counts as a read and a write
+        for capture in self.capture_files:
+            with self.subTest(capture=capture):
+                result = self.run_cache(["--analyze", capture])
+                self.assertEqual(result.returncode, 0)
+                self.assertIn("Requests: 6", result.stdout)
+                self.assertIn("Writes: 2", result.stdout)
+                self.assertIn("Instruction fetches: 1", result.stdout)
+
+                result = self.run_cache([capture])
+                self.assertEqual(result.returncode, 0)
+
+        result = self.run_cache(["--input-format", "csv", self.valid_file])
+        self.assertEqual(result.returncode, 0)
+
+    def test_unaligned_accesses(self):
+        # Accesses at any byte become requests at words, one per 16 B line they touch
+        result = self.run_cache(["--analyze", "-C", "16", self.unaligned_file])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("Requests: 10", result.stdout)
+        self.assertIn("Writes: 3", result.stdout)
+        self.assertIn("Instruction fetches: 2", result.stdout)
+
+        for mapping in ["0", "1"]:
+            with self.subTest(mapping=mapping):
+                result = self.run_cache(["-C", "16", "-S", mapping, self.unaligned_file])
+                self.assertEqual(result.returncode, 0)
+
+    def test_invalid_input_formats(self):
+        for args in [["--input-format", "xml", self.valid_file], ["-t", "test/inputs/valid_data.jsonl"],
+                     ["--input-format", "jsonl", self.valid_file], ["--input-format", "lackey", self.valid_file],
+                     ["--analyze", "--input-format", "jsonl", self.valid_file]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_pipeline(self):
+        # Parsing on a separate thread doesn't change the result
+        plain = self.run_cache([self.valid_file])
+        result = self.run_cache(["--pipeline", self.valid_file])
+        self.assertEqual(result.returncode, 0)
+        self.assertEqual(result.stdout, plain.stdout)
+
+        result = self.run_cache(["--pipeline", "test/inputs/valid_data.jsonl"])
+        self.assertEqual(result.returncode, 0)
+
+    def test_invalid_pipeline(self):
+        for args in [["--pipeline", "test/inputs/invalid_data5.csv"], ["--pipeline", "--workload", "zipf"],
+                     ["--pipeline", "--analyze", self.valid_file], ["--pipeline", "--tune", "8192", self.valid_file]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+        # A streamed trace follows the rules of a trace read at once
+        for invalid_file in self.invalid_files:
+            with self.subTest(invalid_file=invalid_file):
+                result = self.run_cache(["--pipeline", invalid_file])
+                self.assertNotEqual(result.returncode, 0)
+
+        # An empty file and a final '\n' give the same errors either way
+        for invalid_file, returncode, message in [("test/inputs/invalid_data13.csv", 61, "File is empty"),
+                                                  ("test/inputs/invalid_data20.csv", 65, "The file contains empty lines")]:
+            for args in [[], ["--pipeline"]]:
+                with self.subTest(invalid_file=invalid_file, args=args):
+                    result = self.run_cache(args + [invalid_file])
+                    self.assertEqual(result.returncode, returncode)
+                    self.assertIn(message, result.stderr)
+
+    def test_progress(self):
+        read_end, write_end = os.pipe()
+        process = subprocess.Popen([self.binary, "--progress-fd", str(write_end), self.valid_file],
+                                   stdout=subprocess.DEVNULL, pass_fds=(write_end,))
+        os.close(write_end)
+        with os.fdopen(read_end, "rb") as pipe:
+            content = pipe.read()
+        self.assertEqual(process.wait(), 0)
+
+        # ProgressRecord of structs/progress.h, with room for MAX_CACHE_LEVELS levels
+        record_format = "<4Q17QdII"
+        record_size = struct.calcsize(record_format)
+        self.assertGreater(len(content), 0)
+        self.assertEqual(len(content) % record_size, 0)
+        last = struct.unpack_from(record_format, content, len(content) - record_size)
+        requests, total, served, finished = last[0], last[1], last[4:21], last[23]
+        self.assertEqual(finished, 1)
+        self.assertEqual(requests, 3)
+        self.assertEqual(total, 3)
+        self.assertEqual(sum(served), requests)
+
+    def test_invalid_progress(self):
+        for args in [["--progress-fd", "999", self.valid_file], ["--progress-fd", "x", self.valid_file],
+                     ["--progress-fd", "1", "--analyze", self.valid_file]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_tune(self):
+        result = self.run_cache([
+            "--tune", "8192",
+            "--tune-latency", "2,1",
+            "--threads", "2",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("AUTO-TUNING", result.stdout)
+        self.assertIn("Pareto front", result.stdout)
+
+    def test_invalid_tune(self):
+        for args in [["--tune", "256", self.valid_file], ["--tune", "8192", "--tune-latency", "2", self.valid_file],
+                     ["--tune", "8192", "--tune-latency", "2,1,1", self.valid_file],
+                     ["--tune", "8192", "-t", self.valid_file], ["--tune", "8192", "--analyze", self.valid_file]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args)
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_log_file(self):
+        log_file = "test_log_file.bin"
+        result = self.run_cache([
+            "--log-file", log_file,
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+
+        decoded = subprocess.run(
+            ["python3", "util/decode_log.py", log_file],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            text=True
+        )
+        with open(log_file, "rb") as f:
+            magic, version = struct.unpack_from("<4sI", f.read())
+        os.remove(log_file)
+
+        self.assertEqual(magic, b"CSTL")
+        self.assertEqual(version, 1)
+        self.assertEqual(decoded.returncode, 0)
+
+    def test_batch(self):
+        result = self.run_cache([
+            "--batch", "test/inputs/batch_configs.txt",
+            "--threads", "2",
+            self.valid_file
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("BATCH RESULTS", result.stdout)
+        self.assertIn("Configurations: 4", result.stdout)
+
+    def test_batch_workload(self):
+        result = self.run_cache([
+            "--batch", "test/inputs/batch_configs.txt",
+            "--workload", "zipf", "--workload-size", "256", "--workload-requests", "1000"
+        ])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("Requests per configuration: 1000", result.stdout)
+
+    def test_invalid_batch(self):
+        for args in [["--batch", "test/inputs/invalid_batch1.txt"], ["--batch", "test/inputs/invalid_batch2.txt"],
+                     ["--batch", "test/inputs/invalid_batch3.txt"], ["--batch", "test/inputs/batch_configs.txt", "-t"],
+                     ["--batch", "test/inputs/batch_configs.txt", "--threads", "0"],
+                     ["--batch", "test/inputs/batch_configs.txt", "--profile"],
+                     ["--batch", "test/inputs/batch_configs.txt", "--miss-classes"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + [self.valid_file])
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_hierarchy(self):
+        result = self.run_cache(["--hierarchy", "test/inputs/hierarchy.ini", "--miss-classes", self.valid_file])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("Number of cache levels: 4", result.stdout)
+        self.assertIn("eDRAM", result.stdout)
+        self.assertIn("Main memory line size: 64", result.stdout)
+
+    def test_hierarchy_expected_values(self):
+        # Reads back words after the 16 byte lines and then the 32 byte lines were evicted, so they
+        # are served by the L3 and the eDRAM with their longer lines
+        result = self.run_cache(["--hierarchy", "test/inputs/hierarchy.ini", "-t", "test/inputs/hierarchy_expected_values.csv"])
+        self.assertEqual(result.returncode, 0)
+        self.assertNotIn("does not match", result.stderr)
+
+    def test_invalid_hierarchy(self):
+        for args in [["--hierarchy", "test/inputs/invalid_hierarchy1.ini"], ["--hierarchy", "test/inputs/invalid_hierarchy2.ini"],
+                     ["--hierarchy", "test/inputs/invalid_hierarchy3.ini"], ["--hierarchy", "test/inputs/invalid_hierarchy4.ini"],
+                     ["--hierarchy", "test/inputs/missing.ini"],
+                     ["--hierarchy", "test/inputs/hierarchy.ini", "--batch", "test/inputs/batch_configs.txt"],
+                     ["--hierarchy", "test/inputs/hierarchy.ini", "--tune", "65536"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + [self.valid_file])
+                self.assertNotEqual(result.returncode, 0)
+
+    def test_split_l1(self):
+        result = self.run_cache(["--num-lines-l1i", "16", "--latency-cache-l1i", "2", "test/inputs/valid_fetch_data.csv"])
+        self.assertEqual(result.returncode, 0)
+        self.assertIn("SPLIT L1", result.stdout)
+        # Lines, latency, requests, hits and hit rate. The second fetch of 0x1000 and the one of 0x1004 in
+        # the same line hit the L1I, the write hits the line the read of 0x0010 filled into the L1D
+        self.assertRegex(result.stdout, r"L1I +16 +2 +3 +2 +0\.6667\n")
+        self.assertRegex(result.stdout, r"L1D +\d+ +\d+ +2 +1 +0\.5000\n")
+
+    def test_invalid_split_l1(self):
+        for args in [["--num-lines-l1i", "15"], ["--num-lines-l1i", "-16"], ["--latency-cache-l1i", "x"],
+                     ["--num-lines-l1i", "16", "--batch", "test/inputs/batch_configs.txt"],
+                     ["--num-lines-l1i", "16", "--tune", "65536"]]:
+            with self.subTest(args=args):
+                result = self.run_cache(args + ["test/inputs/valid_fetch_data.csv"])
+                self.assertNotEqual(result.returncode, 0)
+
     def test_no_input_file(self):
         result = self.run_cache([
             "-c", "100",
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/simulator.hpp"
+#include "simulator_checks.hpp"
+
+// Runs the SystemC model of a hierarchy with five levels
+
+// Reads one word and checks its data, whether it hit and the level that served it
+void check_read(Simulator &simulator, const std::string &test_name, uint64_t addr, uint32_t data, uint8_t served_level)
+{
+    Request request = Request();
+    request.addr = addr;
+    request.data = data;
+    RunOptions options;
+    options.check_reads = true;
+
+    ArrayRequestSource source(&request, 1);
+    RunResult run = simulator.run(source, options);
+    assert_equal_sim(test_name + "Finished", 1, run.status == RunStatus::FINISHED);
+    assert_equal_sim(test_name + "Hits", served_level > 0 ? 1 : 0, run.result.hits);
+    assert_equal_sim(test_name + "Misses", served_level > 0 ? 0 : 1, run.result.misses);
+    assert_equal_sim(test_name + "ServedLevel", served_level, simulator.cache.served_level);
+}
+
+// Every level holds twice the lines of the one above. After writing 16 lines once, level i holds
+// the last 2^(i-1) of them, so every older line is served by a deeper level
+void test_deep_levels(Simulator &simulator)
+{
+    const SimulatorConfig &config = simulator.get_config();
+    std::vector<Request> writes;
+    for (uint32_t line = 0; line < 16; line++)
+    {
+        Request request = Request();
+        request.addr = line * config.cacheline_size;
+        request.data = 100 + line;
+        request.w = 1;
+        writes.push_back(request);
+    }
+
+    simulator.reset();
+    ArrayRequestSource source(writes.data(), writes.size());
+    RunResult run = simulator.run(source, RunOptions());
+    assert_equal_sim("DeepWrites", writes.size(), run.requests);
+
+    // hits in deeper levels don't fill the levels above, so every read sees the same contents
+    check_read(simulator, "DeepHitL5", writes[0].addr, 100, 5);
+    check_read(simulator, "DeepHitL4", writes[8].addr, 108, 4);
+    check_read(simulator, "DeepHitL3", writes[12].addr, 112, 3);
+    check_read(simulator, "DeepHitL2", writes[14].addr, 114, 2);
+    check_read(simulator, "DeepHitL1", writes[15].addr, 115, 1);
+    check_read(simulator, "DeepHitL5Again", writes[0].addr, 100, 5);
+    check_read(simulator, "DeepMiss", 16 * config.cacheline_size, 0, 0);
+    check_read(simulator, "DeepHitL1AfterMiss", 16 * config.cacheline_size, 0, 1);
+}
+
+int sc_main(int, char *[])
+{
+    SimulatorConfig config;
+    config.num_cache_levels = 5;
+    config.cacheline_size = 16;
+    config.mapping_strategy = FULLY_ASSOCIATIVE;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        config.num_lines[i] = 1u << i;
+        config.latency[i] = 2u << i;
+    }
+
+    Simulator simulator(config);
+
+    std::cout << "Running Deep Hierarchy Tests...\n";
+    test_deep_levels(simulator);
+
+    return checks_status();
+}
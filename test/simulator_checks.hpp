@@ -0,0 +1,50 @@
+#ifndef SIMULATOR_CHECKS_HPP
+#define SIMULATOR_CHECKS_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Checks of the test executables that elaborate a Simulator. Every one of them has to be its own
+// executable, since SystemC can elaborate only once per process
+
+// Failed checks so far, the exit status of the executable
+inline int &check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+inline void assert_equal_sim(const std::string &test_name, uint64_t expected, uint64_t actual)
+{
+    if (expected == actual)
+        std::cout << test_name << ": PASSED\n";
+    else
+    {
+        std::cout << test_name << ": FAILED (Expected " << expected << ", got " << actual << ")\n";
+        check_failures()++;
+    }
+}
+
+inline void assert_bool_sim(const std::string &test_name, bool expected, bool actual)
+{
+    if (expected == actual)
+        std::cout << test_name << ": PASSED\n";
+    else
+    {
+        std::cout << test_name << ": FAILED (Expected " << (expected ? "true" : "false")
+                  << ", got " << (actual ? "true" : "false") << ")\n";
+        check_failures()++;
+    }
+}
+
+// Reports the failed checks and returns the exit status of the executable
+inline int checks_status()
+{
+    if (check_failures() > 0)
+        std::cout << check_failures() << " checks FAILED\n";
+    return check_failures() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+#endif // SIMULATOR_CHECKS_HPP
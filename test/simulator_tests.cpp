@@ -0,0 +1,436 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../include/auto_tuner.hpp"
+#include "../include/functional_model.hpp"
+#include "../include/pipelined_source.hpp"
+#include "../include/simulator.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/trace_analyzer.hpp"
+#include "simulator_checks.hpp"
+#include <list>
+
+// Reuses one elaborated Simulator for several runs
+
+RunResult run_matmul(Simulator &simulator)
+{
+    WorkloadOptions options = {"matmul", 0, 1, 4, 0, 0};
+    std::unique_ptr<RequestSource> source = make_workload(options);
+    return simulator.run(*source, RunOptions());
+}
+
+void test_reset_repeats_run(Simulator &simulator)
+{
+    simulator.reset();
+    RunResult first = run_matmul(simulator);
+    simulator.reset();
+    RunResult second = run_matmul(simulator);
+
+    assert_bool_sim("ResetRepeatsRunFinished", true, first.status == RunStatus::FINISHED && second.status == RunStatus::FINISHED);
+    assert_equal_sim("ResetRepeatsRunCycles", first.result.cycles, second.result.cycles);
+    assert_equal_sim("ResetRepeatsRunHits", first.result.hits, second.result.hits);
+    assert_equal_sim("ResetRepeatsRunMisses", first.result.misses, second.result.misses);
+}
+
+void test_warm_run_without_reset(Simulator &simulator)
+{
+    simulator.reset();
+    RunResult cold = run_matmul(simulator);
+    RunResult warm = run_matmul(simulator);
+
+    assert_bool_sim("WarmRunHasFewerMisses", true, warm.result.misses < cold.result.misses);
+}
+
+void test_reset_with_new_parameters(Simulator &simulator)
+{
+    SimulatorConfig config = simulator.get_config();
+    config.num_lines[0] = 1;
+    config.latency[0] = 20;
+    config.mapping_strategy = DIRECT_MAPPED;
+    simulator.reset(config);
+    assert_equal_sim("ResetAppliesNewParameters", 20, simulator.cache.L[0]->latency);
+    RunResult slow = run_matmul(simulator);
+
+    config.latency[0] = 1;
+    simulator.reset(config);
+    RunResult fast = run_matmul(simulator);
+    assert_bool_sim("LowerLatencyIsFaster", true, fast.result.cycles < slow.result.cycles);
+}
+
+void test_reset_rejects_new_structure(Simulator &simulator)
+{
+    SimulatorConfig config = simulator.get_config();
+    config.cacheline_size *= 2;
+    bool thrown = false;
+    try
+    {
+        simulator.reset(config);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert_bool_sim("ResetRejectsNewStructure", true, thrown);
+}
+
+void test_check_reads(Simulator &simulator)
+{
+    std::vector<Request> requests = {{0x40, 7, 1, 0}, {0x40, 7, 0, 0}, {0x80, 9, 1, 0}, {0x80, 9, 0, 0}};
+    RunOptions options;
+    options.check_reads = true;
+
+    simulator.reset();
+    ArrayRequestSource source(requests.data(), requests.size());
+    RunResult run = simulator.run(source, options);
+    assert_bool_sim("CheckReadsMatch", true, run.status == RunStatus::FINISHED);
+    assert_equal_sim("CheckReadsRequests", requests.size(), run.requests);
+
+    simulator.reset();
+    requests[3].data = 10;
+    ArrayRequestSource wrong(requests.data(), requests.size());
+    run = simulator.run(wrong, options);
+    assert_bool_sim("CheckReadsMismatch", true, run.status == RunStatus::READ_MISMATCH);
+}
+
+void test_cycle_limit(Simulator &simulator)
+{
+    WorkloadOptions workload = {"copy", 0, 1, 64, 0, 0};
+    std::unique_ptr<RequestSource> source = make_workload(workload);
+    RunOptions options;
+    options.cycle_limit = 50;
+
+    simulator.reset();
+    RunResult run = simulator.run(*source, options);
+    assert_bool_sim("CycleLimitReached", true, run.status == RunStatus::CYCLE_LIMIT);
+    assert_equal_sim("CycleLimitCycles", 50, run.result.cycles);
+}
+
+std::vector<Request> generate(const char *name, uint32_t size)
+{
+    WorkloadOptions options = {name, 0, 1, size, 0, 0};
+    std::unique_ptr<RequestSource> source = make_workload(options);
+    std::vector<Request> requests;
+    Request request;
+    while (source->next(request))
+        requests.push_back(request);
+    return requests;
+}
+
+// Requests of a workload with the writes turned into reads, so that a miss of the last level is a miss of the hierarchy
+std::vector<Request> generate_reads(const char *name, uint32_t size)
+{
+    std::vector<Request> requests = generate(name, size);
+    for (Request &request : requests)
+        request.w = 0;
+    return requests;
+}
+
+void test_functional_model_matches(Simulator &simulator)
+{
+    for (uint8_t mapping : {DIRECT_MAPPED, FULLY_ASSOCIATIVE})
+    {
+        SimulatorConfig config = simulator.get_config();
+        config.mapping_strategy = mapping;
+        simulator.reset(config);
+
+        std::vector<Request> requests = generate("matmul", 4);
+        ArrayRequestSource source(requests.data(), requests.size());
+        RunResult systemc = simulator.run(source, RunOptions());
+        FunctionalRun functional = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+
+        const std::string name = mapping == DIRECT_MAPPED ? "FunctionalModelDirectMapped" : "FunctionalModelFullyAssociative";
+        assert_equal_sim(name + "Hits", systemc.result.hits, functional.result.hits);
+        assert_equal_sim(name + "Misses", systemc.result.misses, functional.result.misses);
+        assert_equal_sim(name + "Evictions", simulator.cache.total_evictions(), functional.evictions);
+    }
+}
+
+void test_pipelined_source(Simulator &simulator)
+{
+    std::vector<Request> requests = generate("zipf", 4096);
+    simulator.reset();
+    ArrayRequestSource direct(requests.data(), requests.size());
+    RunResult expected = simulator.run(direct, RunOptions());
+
+    simulator.reset();
+    PipelinedSource pipelined(std::unique_ptr<RequestSource>(new ArrayRequestSource(requests.data(), requests.size())));
+    RunResult actual = simulator.run(pipelined, RunOptions());
+
+    assert_equal_sim("PipelinedSourceRequests", requests.size(), actual.requests);
+    assert_equal_sim("PipelinedSourceCycles", expected.result.cycles, actual.result.cycles);
+    assert_equal_sim("PipelinedSourceHits", expected.result.hits, actual.result.hits);
+}
+
+void test_deep_hierarchy(Simulator &simulator)
+{
+    std::vector<Request> requests = generate("zipf", 4096);
+    SimulatorConfig config = simulator.get_config();
+    FunctionalRun shallow = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+
+    // three more levels below the ones of the simulator, e.g. an L3, an L4 and an eDRAM cache
+    config.num_cache_levels = 5;
+    for (uint32_t i = 2; i < 5; i++)
+    {
+        config.num_lines[i] = config.num_lines[i - 1] * 4;
+        config.latency[i] = config.latency[i - 1] * 2;
+    }
+    config.names[4] = "eDRAM";
+    FunctionalRun deep = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+
+    assert_equal_sim("DeepHierarchyRequests", requests.size(), deep.result.hits + deep.result.misses);
+    assert_bool_sim("DeepHierarchyMoreHits", true, deep.result.hits >= shallow.result.hits);
+    assert_bool_sim("DeepHierarchyLevelName", true, config.level_name(4) == "eDRAM" && config.level_name(3) == "L4");
+}
+
+void test_per_level_lines(Simulator &simulator)
+{
+    std::vector<Request> requests = generate("copy", 4096);
+    SimulatorConfig config = simulator.get_config();
+    FunctionalRun uniform = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+
+    // the longer L2 lines are filled from main memory once for several L1 lines
+    config.line_sizes[1] = 4 * config.cacheline_size;
+    config.mappings[1] = FULLY_ASSOCIATIVE;
+    FunctionalHierarchy hierarchy(config);
+    FunctionalRun mixed = hierarchy.run(requests.data(), requests.size(), CYCLES);
+
+    assert_equal_sim("PerLevelLinesRequests", requests.size(), mixed.result.hits + mixed.result.misses);
+    assert_bool_sim("PerLevelLinesMoreHits", true, mixed.result.hits > uniform.result.hits);
+    assert_equal_sim("PerLevelLinesMemoryLine", 4 * config.cacheline_size, config.memory_line_size());
+    assert_bool_sim("PerLevelLinesMapping", true, config.mapping(0) == config.mapping_strategy && config.mapping(1) == FULLY_ASSOCIATIVE);
+}
+
+void test_split_l1(Simulator &simulator)
+{
+    // a small loop of fetches beside a stream of data that sweeps both levels
+    std::vector<Request> data = generate("copy", 1024);
+    std::vector<Request> requests;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        Request fetch = Request();
+        fetch.addr = 0x100000 + 4 * (i % 8);
+        fetch.fetch = 1;
+        requests.push_back(fetch);
+        requests.push_back(data[i]);
+    }
+
+    // direct mapped, so the stream conflicts with the loop in a unified L1
+    SimulatorConfig config = simulator.get_config();
+    config.mapping_strategy = DIRECT_MAPPED;
+    simulator.reset(config);
+    ArrayRequestSource source(requests.data(), requests.size());
+    RunResult run = simulator.run(source, RunOptions());
+    FunctionalRun unified = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+    assert_equal_sim("SplitL1UnifiedFetches", data.size(), run.fetches);
+    assert_equal_sim("SplitL1UnifiedMatchesModel", unified.result.hits, run.result.hits);
+
+    // the stream can't evict the loop from L1I
+    config.split_l1 = true;
+    config.l1i_lines = 4;
+    FunctionalRun split = FunctionalHierarchy(config).run(requests.data(), requests.size(), CYCLES);
+    assert_equal_sim("SplitL1Requests", requests.size(), split.result.hits + split.result.misses);
+    assert_bool_sim("SplitL1MoreHits", true, split.result.hits > unified.result.hits);
+    assert_equal_sim("SplitL1DataName", 0, config.level_name(0).compare("L1D"));
+
+    bool thrown = false;
+    try
+    {
+        simulator.reset(config);
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert_bool_sim("SplitL1FixedAfterElaboration", true, thrown);
+}
+
+void test_miss_classes(Simulator &simulator)
+{
+    std::vector<Request> requests = generate_reads("random", 1024);
+    std::vector<MissClasses> classes[2];
+    uint32_t misses[2];
+
+    for (uint8_t mapping : {DIRECT_MAPPED, FULLY_ASSOCIATIVE})
+    {
+        SimulatorConfig config = simulator.get_config();
+        config.num_lines[0] = 4;
+        config.mapping_strategy = mapping;
+        config.classify_misses = true;
+        simulator.reset(config);
+
+        ArrayRequestSource source(requests.data(), requests.size());
+        misses[mapping] = simulator.run(source, RunOptions()).result.misses;
+        classes[mapping] = simulator.miss_classes();
+    }
+
+    // A request misses the hierarchy only if it misses every level
+    assert_bool_sim("MissClassesCoverHierarchyMisses", true, classes[DIRECT_MAPPED][0].total() >= misses[DIRECT_MAPPED]);
+    assert_equal_sim("MissClassesSameCompulsory", classes[DIRECT_MAPPED][0].compulsory, classes[FULLY_ASSOCIATIVE][0].compulsory);
+    assert_bool_sim("MissClassesDirectMappedConflicts", true, classes[DIRECT_MAPPED][0].conflict > 0);
+    assert_equal_sim("MissClassesFullyAssociativeNoConflicts", 0, classes[FULLY_ASSOCIATIVE][0].conflict);
+
+    // Only the reads that missed L1 reach L2, and they miss the hierarchy if they miss L2
+    assert_equal_sim("MissClassesL2DirectMapped", misses[DIRECT_MAPPED], classes[DIRECT_MAPPED][1].total());
+    assert_equal_sim("MissClassesL2FullyAssociative", misses[FULLY_ASSOCIATIVE], classes[FULLY_ASSOCIATIVE][1].total());
+    assert_equal_sim("MissClassesL2FullyAssociativeNoConflicts", 0, classes[FULLY_ASSOCIATIVE][1].conflict);
+
+    SimulatorConfig config = simulator.get_config();
+    config.classify_misses = false;
+    simulator.reset(config);
+}
+
+void test_conflict_profile(Simulator &simulator)
+{
+    SimulatorConfig config = simulator.get_config();
+    config.num_lines[0] = 4;
+    config.mapping_strategy = DIRECT_MAPPED;
+    config.profile_conflicts = true;
+    simulator.reset(config);
+
+    std::vector<Request> requests = generate_reads("random", 1024);
+    ArrayRequestSource source(requests.data(), requests.size());
+    RunResult run = simulator.run(source, RunOptions());
+
+    const ConflictProfile &profile = simulator.cache.L[0]->conflict_profile;
+    uint64_t misses = 0, evictions = 0, line_misses = 0;
+    for (size_t i = 0; i < profile.set_misses.size(); i++)
+    {
+        misses += profile.set_misses[i];
+        evictions += profile.set_evictions[i];
+    }
+    for (const auto &line : profile.line_misses)
+        line_misses += line.second;
+
+    assert_equal_sim("ConflictProfileSets", 4, profile.set_misses.size());
+    assert_equal_sim("ConflictProfileEvictions", simulator.cache.L[0]->evictions, evictions);
+    assert_equal_sim("ConflictProfileLineMisses", misses, line_misses);
+
+    // Only the reads that missed L1 reach L2, and they miss the hierarchy if they miss L2
+    const ConflictProfile &lower = simulator.cache.L[1]->conflict_profile;
+    uint64_t lower_misses = 0, region_misses = 0;
+    for (uint64_t set : lower.set_misses)
+        lower_misses += set;
+    for (const auto &region : lower.region_misses)
+        region_misses += region.second;
+    assert_equal_sim("ConflictProfileL2Misses", run.result.misses, lower_misses);
+    assert_equal_sim("ConflictProfileL2RegionMisses", run.result.misses, region_misses);
+
+    config.profile_conflicts = false;
+    simulator.reset(config);
+}
+
+void test_batch_on_thread_pool(Simulator &simulator)
+{
+    std::vector<Request> requests = generate("random", 1024);
+    std::vector<SimulatorConfig> configs;
+    for (uint32_t lines = 1; lines <= 64; lines *= 2)
+    {
+        SimulatorConfig config = simulator.get_config();
+        config.num_lines[0] = lines;
+        configs.push_back(config);
+    }
+
+    std::vector<FunctionalRun> parallel(configs.size());
+    WorkStealingPool pool(4);
+    pool.run(configs.size(), [&](size_t i) {
+        parallel[i] = FunctionalHierarchy(configs[i]).run(requests.data(), requests.size(), CYCLES);
+    });
+
+    bool same = true;
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        FunctionalRun sequential = FunctionalHierarchy(configs[i]).run(requests.data(), requests.size(), CYCLES);
+        same = same && sequential.result.hits == parallel[i].result.hits && sequential.result.cycles == parallel[i].result.cycles;
+    }
+    assert_bool_sim("BatchMatchesSequentialRuns", true, same);
+    assert_bool_sim("BatchLargerL1HasMoreHits", true, parallel.back().result.hits > parallel.front().result.hits);
+}
+
+void test_trace_analyzer()
+{
+    std::vector<Request> requests = generate("zipf", 4096);
+    TraceAnalyzer analyzer(64, 1000);
+    std::vector<uint64_t> histogram(TraceAnalyzer::NUM_DISTANCE_BINS, 0);
+    std::list<uint64_t> stack; // naive LRU stack of lines, most recent first
+    for (const Request &request : requests)
+    {
+        analyzer.add(request);
+
+        const uint64_t line = request.addr >> 6;
+        uint64_t distance = 0;
+        auto it = stack.begin();
+        while (it != stack.end() && *it != line) { ++it; distance++; }
+        if (it != stack.end())
+        {
+            histogram[TraceAnalyzer::distance_bin(distance)]++;
+            stack.erase(it);
+        }
+        stack.push_front(line);
+    }
+    analyzer.finish();
+
+    bool same = analyzer.histogram == histogram;
+    assert_bool_sim("TraceAnalyzerMatchesLruStack", true, same);
+    assert_equal_sim("TraceAnalyzerColdMisses", stack.size(), analyzer.cold);
+    assert_equal_sim("TraceAnalyzerFootprint", stack.size(), analyzer.unique_lines(2));
+    assert_equal_sim("TraceAnalyzerWindows", (requests.size() + 999) / 1000, analyzer.windows.size());
+}
+
+void test_auto_tuner(Simulator &simulator)
+{
+    std::vector<Request> requests = generate("zipf", 8192);
+    TuneOptions options;
+    options.budget = 16384;
+    options.latencyBase = 1;
+    options.latencyPerDoubling = 2;
+
+    AutoTuner tuner(simulator.get_config(), options);
+    WorkStealingPool pool(4);
+    tuner.run(requests.data(), requests.size(), pool);
+    const std::vector<TuneCandidate> front = tuner.pareto_front();
+
+    bool fits = true, improves = true;
+    for (size_t i = 0; i < front.size(); i++)
+    {
+        fits = fits && front[i].capacity <= options.budget;
+        improves = improves && (i == 0 || (front[i].capacity > front[i - 1].capacity && front[i].amat < front[i - 1].amat));
+    }
+    assert_bool_sim("AutoTunerHasFront", true, !front.empty());
+    assert_bool_sim("AutoTunerFitsBudget", true, fits);
+    assert_bool_sim("AutoTunerFrontImproves", true, improves);
+    assert_equal_sim("AutoTunerLastRoundFullTrace", requests.size(), tuner.rounds.back().prefix);
+    assert_equal_sim("AutoTunerLatencyOf1KiB", 1, tuner.latency(1024));
+}
+
+int sc_main(int, char *[])
+{
+    SimulatorConfig config;
+    config.num_cache_levels = 2;
+    config.cacheline_size = 16;
+    config.num_lines[0] = 4;
+    config.num_lines[1] = 16;
+    config.latency[0] = 2;
+    config.latency[1] = 6;
+
+    Simulator simulator(config);
+
+    std::cout << "Running Simulator Reuse Tests...\n";
+    test_reset_repeats_run(simulator);
+    test_warm_run_without_reset(simulator);
+    test_reset_with_new_parameters(simulator);
+    test_reset_rejects_new_structure(simulator);
+    test_check_reads(simulator);
+    test_cycle_limit(simulator);
+    test_functional_model_matches(simulator);
+    test_pipelined_source(simulator);
+    test_deep_hierarchy(simulator);
+    test_per_level_lines(simulator);
+    test_split_l1(simulator);
+    test_miss_classes(simulator);
+    test_conflict_profile(simulator);
+    test_batch_on_thread_pool(simulator);
+    test_trace_analyzer();
+    test_auto_tuner(simulator);
+
+    return checks_status();
+}
@@ -44,7 +44,7 @@ void assert_throws(const std::string& test_name, const std::function<void()>& fu
     }
 }
 
-void cacheReadMiss(CACHE &cache,  sc_signal<uint32_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
+void cacheReadMiss(CACHE &cache,  sc_signal<uint64_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
     sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready,uint32_t rdata_expected){
         w.write(false);
         r.write(true);
@@ -57,7 +57,7 @@ void cacheReadMiss(CACHE &cache,  sc_signal<uint32_t> &addr,sc_signal<uint32_t>
         assert_bool("cacheReadMiss ready",true,ready.read());
 }
 
-void cacheReadHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
+void cacheReadHit(CACHE &cache, sc_signal<uint64_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
     sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready,uint32_t rdata_expected){
         w.write(false);
         r.write(true);
@@ -71,7 +71,7 @@ void cacheReadHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &r
 }
 
 
-void cacheReadSpatialLocalityHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
+void cacheReadSpatialLocalityHit(CACHE &cache, sc_signal<uint64_t> &addr,sc_signal<uint32_t> &rdata,  sc_signal<bool> &r, 
     sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready){
         addr.write(0x4);
         w.write(false);
@@ -86,7 +86,7 @@ void cacheReadSpatialLocalityHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_sign
         assert_bool("cacheReadSpatialLocalityHit ready",true,ready.read());
 }
 
-void cacheWriteHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &wdata,  sc_signal<bool> &r, 
+void cacheWriteHit(CACHE &cache, sc_signal<uint64_t> &addr,sc_signal<uint32_t> &wdata,  sc_signal<bool> &r, 
     sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready){
         // addr.write(0);
         w.write(true);
@@ -104,7 +104,7 @@ void cacheWriteHit(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &
         assert_equal("cacheReadAfterWriteHit L1[3]",0xd1,cache.get_cache_line_content(1,0,3));
 }
 
-void cacheWriteMiss(CACHE &cache, sc_signal<uint32_t> &addr,sc_signal<uint32_t> &wdata,  sc_signal<bool> &r, 
+void cacheWriteMiss(CACHE &cache, sc_signal<uint64_t> &addr,sc_signal<uint32_t> &wdata,  sc_signal<bool> &r, 
     sc_signal<bool> &w, sc_signal<bool> &miss, sc_signal<bool> &ready){
         // addr.write(0x8);
         w.write(true);
@@ -130,9 +130,13 @@ int sc_main(int argc, char *argv[])
     // sc_signal<uint32_t> addr, wdata;
     // sc_signal<bool> r, w, miss, ready;
     // sc_signal<uint32_t> rdata;
-    //name,numCahceLevels,cachelineSize,numLinesL1,2,3,latencyCacheL1,2,3, mappingStrategy
+    //name,numCahceLevels,cachelineSize,numLines,latency,mappingStrategy per level
  
-    CACHE cache("cache",3,8,2,4,8,8,8,8,1);
+    const uint32_t line_sizes[] = {8, 8, 8};
+    const uint32_t num_lines[] = {2, 4, 8};
+    const uint32_t latency[] = {8, 8, 8};
+    const uint8_t mappings[] = {1, 1, 1};
+    CACHE cache("cache",3,line_sizes,num_lines,latency,mappings);
     MAIN_MEMORY main_memory("main_memory",8);
 
     // cache.L[0]->test_mode=true;cache.L[1]->test_mode=true;cache.L[2]->test_mode=true;
@@ -146,8 +150,9 @@ int sc_main(int argc, char *argv[])
     // cache.miss(miss);
     // cache.ready(ready);////
     // cache.rdata(rdata);
-    sc_signal<uint32_t> addr, wdata;
-    sc_signal<bool> r, w;
+    sc_signal<uint64_t> addr;
+    sc_signal<uint32_t> wdata;
+    sc_signal<bool> r, w, fetch;
 
     sc_signal<uint32_t> rdata;
     sc_signal<bool> ready, miss,stop;
@@ -157,6 +162,7 @@ int sc_main(int argc, char *argv[])
     cache.wdata(wdata);
     cache.r(r);
     cache.w(w);
+    cache.fetch(fetch);
 
     cache.rdata(rdata);
     cache.ready(ready);
@@ -166,7 +172,8 @@ int sc_main(int argc, char *argv[])
     main_memory.clk(clk);
    
 
-    sc_signal<uint32_t> mem_addr_sig, mem_wdata_sig,mem_rdata;
+    sc_signal<uint64_t> mem_addr_sig;
+    sc_signal<uint32_t> mem_wdata_sig,mem_rdata;
     std::vector<sc_signal<uint8_t>> mem_cacheline_sig(8);
     sc_signal<bool> mem_r_sig, mem_w_sig, mem_ready_sig;
 
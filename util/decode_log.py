@@ -0,0 +1,116 @@
+# Decodes a binary log written with --log-file into text
+#
+# The rings of all threads are merged by the global sequence number of their events, so the output is in the order
+# the events were recorded. Usage: python3 util/decode_log.py <log file> [--level N]
+
+import re
+import struct
+import sys
+
+LEVEL_NAMES = {1: "ERROR", 2: "WARN", 3: "INFO", 4: "DEBUG", 5: "TRACE"}
+
+# Flags, width, precision, length modifier and conversion of a printf conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGaAp%])")
+
+LENGTH_BITS = {"hh": 8, "h": 16, None: 32, "l": 64, "ll": 64, "z": 64, "j": 64, "t": 64}
+
+
+def read(data, offset, fmt):
+    values = struct.unpack_from("<" + fmt, data, offset)
+    return values, offset + struct.calcsize("<" + fmt)
+
+
+def parse(data):
+    if data[:4] != b"CSTL":
+        raise ValueError("not a cache simulation log")
+    (version,), offset = read(data, 4, "I")
+    if version != 1:
+        raise ValueError(f"unsupported log version {version}")
+
+    strings, events, dropped = {}, [], {}
+    while offset < len(data):
+        block = data[offset:offset + 1]
+        offset += 1
+        if block == b"S":
+            (string_id, length), offset = read(data, offset, "QI")
+            strings[string_id] = data[offset:offset + length].decode("utf-8", "replace")
+            offset += length
+        elif block == b"R":
+            (thread, ring_dropped, count), offset = read(data, offset, "IQI")
+            dropped[thread] = ring_dropped
+            for _ in range(count):
+                (sequence, format_id, level, num_args), offset = read(data, offset, "QQBB")
+                args, offset = read(data, offset, "Q" * num_args)
+                events.append((sequence, thread, level, format_id, args))
+        else:
+            raise ValueError(f"unknown block at offset {offset - 1}")
+
+    events.sort()
+    return strings, events, dropped
+
+
+def format_event(fmt, args, strings):
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, length, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if width == "*":
+            width = str(struct.unpack("<q", struct.pack("<Q", args.pop(0)))[0]) if args else ""
+        if precision == "*":
+            precision = str(struct.unpack("<q", struct.pack("<Q", args.pop(0)))[0]) if args else ""
+        if not args:
+            return match.group(0)
+        value = args.pop(0)
+
+        if conversion in "di":
+            bits = LENGTH_BITS[length]
+            value &= (1 << bits) - 1
+            if value >> (bits - 1):
+                value -= 1 << bits
+        elif conversion in "ouxXc":
+            value &= (1 << LENGTH_BITS[length]) - 1
+        elif conversion in "fFeEgGaA":
+            value = struct.unpack("<d", struct.pack("<Q", value))[0]
+            conversion = "e" if conversion in "aA" else conversion
+        elif conversion == "s":
+            value = strings.get(value, f"<string 0x{value:x}>")
+        elif conversion == "p":
+            return hex(value)
+
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "") + conversion
+        return spec % (chr(value) if conversion == "c" else value)
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: python3 util/decode_log.py <log file> [--level N]", file=sys.stderr)
+        sys.exit(1)
+
+    max_level = 5
+    if "--level" in sys.argv:
+        max_level = int(sys.argv[sys.argv.index("--level") + 1])
+
+    with open(sys.argv[1], "rb") as file:
+        strings, events, dropped = parse(file.read())
+
+    for thread, count in sorted(dropped.items()):
+        if count:
+            print(f"# thread {thread}: {count} oldest events were overwritten", file=sys.stderr)
+
+    out = sys.stdout
+    for sequence, thread, level, format_id, args in events:
+        if level > max_level:
+            continue
+        fmt = strings.get(format_id, f"<format 0x{format_id:x}>")
+        text = format_event(fmt, args, strings)
+        out.write(f"{sequence:>10} T{thread} {LEVEL_NAMES.get(level, level):<5} {text}")
+        if not text.endswith("\n"):
+            out.write("\n")
+
+
+if __name__ == "__main__":
+    main()
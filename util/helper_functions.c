@@ -12,7 +12,7 @@ void print_help()
         "\n"
         "Simulate a cache system based on memory access requests from a CSV file.\n\n"
         "Required:\n"
-        "  requests.csv                 CSV file with memory requests.\n\n"
+        "  requests.csv                 CSV file with memory requests, or a capture in one of the input formats.\n\n"
         "Standard options:\n"
         "  -c, --cycles NUM          Number of simulation cycles [default: %u]\n"
         "  -f, --tf FILE             Output trace file (optional)\n"
@@ -27,10 +27,92 @@ void print_help()
         "  -n, --latency-cache-l3   |  Latency of L3 cache in cycles (default: %u)\n"
         "  -e, --num-cache-levels   |  Number of cache levels (1–3) (default: %u)\n"
         "  -S, --mapping-strategy   |  Cache mapping strategy (0=Direct-mapped, 1=Fully associative.) (default: %u)\n"
-        "  -d, --debug              |  Debug mode for detailed output by simulation\n"
+        "  --hierarchy FILE         |  Read up to 16 cache levels from an INI file instead of -e, -L, -M, -N, -l, -m, -n.\n"
+        "                           |  One [name] section per level, L1 first, with lines and latency keys. Names such as\n"
+        "                           |  eDRAM replace Lx in the reports and trace signals. cacheline-size and\n"
+        "                           |  mapping-strategy apply to all levels before the first section, to one level in it\n"
+        "  --num-lines-l1i NUM      |  Split the L1 into L1I and L1D: number of lines of the instruction cache L1I, which\n"
+        "                           |  serves the I requests with the line size and mapping of L1 (default: unified L1)\n"
+        "  --latency-cache-l1i NUM  |  Latency of L1I in cycles (default: %u)\n"
+        "  -d, --debug              |  Print the requests and the cache contents\n"
         "  -t, --test               |  Test mode for expected values in requests, to validate the correctness of simulation\n\n"
+        "Trace options (require --tf):\n"
+        "  --trace-requests N:M     |  Trace only requests in [N;M). M may be omitted to trace till the end\n"
+        "  --trace-cycles N:M       |  Trace only cycles in [N;M). M may be omitted to trace till the end\n"
+        "  --trace-signals LIST     |  Comma separated signals to trace, e.g. clk,addr,L1.miss,L2.ready,mem.ready\n"
+        "                           |  Top level: clk, addr, wdata, r, w, rdata, ready, miss (default set)\n"
+        "                           |  Per level: Lx.addr, Lx.wdata, Lx.r, Lx.w, Lx.miss, Lx.ready, Lx.data\n"
+        "                           |  Split L1: L1I.addr, L1I.r, L1I.miss, L1I.ready, L1I.data, the first level is L1D\n"
+        "                           |  Main memory: mem.addr, mem.wdata, mem.r, mem.w, mem.ready, mem.stop, mem.rdata\n"
+        "                           |  all: every signal above\n\n"
+        "Main memory options:\n"
+        "  --dram-channels NUM      |  Number of channels (default: %u)\n"
+        "  --dram-ranks NUM         |  Number of ranks per channel (default: %u)\n"
+        "  --dram-banks NUM         |  Number of banks per rank (default: %u)\n"
+        "  --dram-row-size NUM      |  Row size in bytes, power of 2 (default: %u)\n"
+        "  --dram-trcd NUM          |  Row activation delay tRCD in cycles (default: %u)\n"
+        "  --dram-tcas NUM          |  Column access delay tCAS in cycles (default: %u)\n"
+        "  --dram-trp NUM           |  Row precharge delay tRP in cycles (default: %u)\n"
+        "  --dram-page-policy NUM   |  0=open page, 1=closed page (default: %u)\n\n"
+        "Bus options (links from L1<->L2 towards main memory, the last value applies to the remaining links):\n"
+        "  --bus-width LIST         |  Comma separated bus widths in bytes per beat (default: %u)\n"
+        "  --bus-frequency LIST     |  Comma separated bus clocks in MHz, the core runs at %u MHz (default: %u)\n\n"
+        "Input options:\n"
+        "  --input-format NAME      |  Format of requests.csv, detected from its first line by default (default: auto)\n"
+        "                           |  csv: TYPE,ADDRESS,DATA per line, parsed up front\n"
+        "                           |  jsonl: {\"type\": \"W\", \"address\": \"0x10\", \"data\": 1} per line\n"
+        "                           |  lackey: valgrind --tool=lackey --trace-mem=yes output, M is a read and a write\n"
+        "                           |  memtrace: type (R/W) and hex address per line in any order, extra decimal sizes\n"
+        "                           |  Formats other than csv are streamed by the simulation and can't be used with -t\n"
+        "  --pipeline               |  Parse the input on a separate thread while simulating it. Parsed requests wait in a\n"
+        "                           |  bounded ring, so memory doesn't grow with the trace. Single simulations only\n\n"
+        "Workload options (instead of requests.csv):\n"
+        "  --workload NAME          |  Generate requests in-process: matmul, matmul-blocked, stencil, copy, strided,\n"
+        "                           |  random, zipf or pointer-chase\n"
+        "  --workload-requests N    |  Number of requests (default: one pass over the data)\n"
+        "  --workload-size N        |  Matrix/grid dimension, or number of words/nodes (default: per workload)\n"
+        "  --workload-stride BYTES  |  Stride of strided, node size of pointer-chase (default: 64)\n"
+        "  --workload-block N       |  Tile dimension of matmul-blocked, has to divide the size (default: 8)\n"
+        "  --seed N                 |  Seed of random, zipf and pointer-chase (default: %u)\n\n"
+        "Batch options:\n"
+        "  --batch FILE             |  Simulate every configuration of FILE against the same requests on a thread pool.\n"
+        "                           |  One configuration per line as key=value pairs named like the long options above,\n"
+        "                           |  e.g. num-cache-levels=2 num-lines-l1=64 latency-cache-l1=2. Missing keys are taken\n"
+        "                           |  from the command line. Uses a functional model: hits and misses are exact, cycles estimated\n"
+        "  --threads N              |  Number of threads of --batch and --tune (default: one per hardware thread)\n\n"
+        "Logging options:\n"
+        "  --event-log FILE         |  Write a binary record per request (index, address, type, serving level, latency, evictions)\n"
+        "  --progress-fd FD         |  Write a ProgressRecord (structs/progress.h) to the open descriptor FD several times a\n"
+        "                           |  second while simulating, e.g. to a pipe of cache_application's live view\n"
+        "  --profile                |  Print wall time per phase, sc_start calls, delta cycles and process activations per request,\n"
+        "                           |  host time per request and memory per cache level\n"
+        "  --log-file FILE          |  Record the log events compiled in (make LOG_LEVEL=0..5, default 2) in per-thread\n"
+        "                           |  binary rings, written to FILE at exit. Decode with python3 util/decode_log.py FILE\n\n"
+        "Analysis options:\n"
+        "  --miss-classes           |  Sort the misses of every level into compulsory (first reference to the line),\n"
+        "                           |  capacity (also a miss in a fully associative LRU cache of the same size) and conflict\n"
+        "  --hotspots N             |  Report misses and evictions per set with a set pressure histogram, and the top N\n"
+        "                           |  sets, lines and 4 KiB regions by misses of every level\n"
+        "  --analyze                |  Don't simulate, stream the trace (or workload) once and print the read/write mix,\n"
+        "                           |  distinct lines per line size, the reuse distance histogram in lines of -C and the\n"
+        "                           |  working set per window\n"
+        "  --analyze-window N       |  Requests per working set window of --analyze (default: %u)\n\n"
+        "Tuning options:\n"
+        "  --tune BYTES             |  Don't simulate the given hierarchy, search 1 to 3 levels with line sizes of 32 to 128 B\n"
+        "                           |  and both mappings whose capacity fits in BYTES, by successive halving on prefixes of\n"
+        "                           |  the requests. Prints the Pareto front of AMAT against capacity. Memory and buses are\n"
+        "                           |  taken from the command line, the functional model of --batch estimates the cycles\n"
+        "  --tune-latency BASE,STEP |  Latency model of --tune: a level of S bytes takes BASE + STEP * log2(S / 1 KiB)\n"
+        "                           |  cycles, at least one (default: %u,%u)\n\n"
         "Examples:\n"
-        "  ./project -c 1000 -f tracefile --num-lines-l1 64 --mapping-strategy 1 requests.csv\n",
+        "  ./project -c 1000 -f tracefile --num-lines-l1 64 --mapping-strategy 1 requests.csv\n"
+        "  ./project --workload zipf --workload-requests 1000000 --seed 7\n"
+        "  ./project --batch configs.txt --threads 8 requests.csv\n"
+        "  ./project --analyze -C 64 --analyze-window 100000 requests.csv\n"
+        "  ./project --input-format lackey -L 64 lackey.out\n"
+        "  ./project --tune 65536 --tune-latency 2,2 --threads 8 requests.csv\n"
+        "  ./project --hierarchy hierarchy.ini requests.csv\n"
+        "  ./project --num-lines-l1i 64 --input-format lackey lackey.out\n",
         CYCLES,
         CACHE_LINE_SIZE,
         NUM_LINES_L1,
@@ -40,7 +122,23 @@ void print_help()
         LATENCY_CACHE_L2,
         LATENCY_CACHE_L3,
         NUM_CACHE_LEVELS,
-        MAPPING_STRATEGY
+        MAPPING_STRATEGY,
+        LATENCY_CACHE_L1,
+        DRAM_CHANNELS,
+        DRAM_RANKS,
+        DRAM_BANKS,
+        DRAM_ROW_SIZE,
+        DRAM_T_RCD,
+        DRAM_T_CAS,
+        DRAM_T_RP,
+        DRAM_PAGE_POLICY,
+        BUS_WIDTH,
+        CORE_FREQUENCY,
+        BUS_FREQUENCY,
+        WORKLOAD_SEED,
+        ANALYZE_WINDOW,
+        TUNE_LATENCY_BASE,
+        TUNE_LATENCY_PER_DOUBLING
     );
 }
 
@@ -67,8 +165,8 @@ bool is_power_of_two(uint32_t number)
 */
 void print_requests(Request* requests, size_t size){
     for (size_t i = 0; i < size; i++) {
-        DEBUG_PRINT("Request %zu: type=%s, addr = 0x%08X, data=0x%08X\n", i,
-            requests[i].w ? "W" : "R",
+        fprintf(stderr, "Request %zu: type=%s, addr = 0x%08" PRIX64 ", data=0x%08X\n", i,
+            requests[i].w ? "W" : requests[i].fetch ? "I" : "R",
             requests[i].addr,
             requests[i].data);
     }
@@ -92,15 +190,50 @@ bool is_valid_filename(const char *filename) {
 }
 
 /*
-   * @brief              
+   * @brief               Validates the main memory and bus options, which the individual options can't check on their own
    *
-   * @param filename    The path to the file to read.  
-   * 
-   * @return            A pointer to a null-terminated buffer containing the file contents,
-   *                    or NULL if an error occurs (file not accessible, not a regular file,
-   *                    I/O error, or memory allocation failure).
+   * @param dram          DRAM organization to check
+   * @param bus           Bus widths and frequencies to check
+   *
+   * @return              true if the options can be simulated, false otherwise
 */
-char* read_file_to_buffer(const char *filename)
+bool validate_memory_options(const DramOptions* dram, const BusOptions* bus)
+{
+    if (dram->channels == 0 || dram->ranks == 0 || dram->banks == 0) {
+        fprintf(stderr, "DRAM channels, ranks and banks must be positive.\n");
+        return false;
+    }
+
+    /* Computed in 64 bits, the product of three 32-bit values overflows */
+    uint64_t banks = (uint64_t)dram->channels * dram->ranks * dram->banks;
+    if (banks > MAX_DRAM_BANKS) {
+        fprintf(stderr, "DRAM has too many banks (at most %u): %" PRIu64 "\n", MAX_DRAM_BANKS, banks);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < bus->numWidths; i++) {
+        if (bus->width[i] == 0) {
+            fprintf(stderr, "Bus width must be positive.\n");
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < bus->numFrequencies; i++) {
+        if (bus->frequency[i] == 0) {
+            fprintf(stderr, "Bus frequency must be positive.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+   * @brief               Checks that the file exists and is a regular file
+   *
+   * @param filename      The path to the file to check
+   *
+   * @return              true if the file can be read, false with errno set otherwise
+*/
+static bool check_regular_file(const char *filename)
 {
     struct stat sb;
 
@@ -112,7 +245,7 @@ char* read_file_to_buffer(const char *filename)
             fprintf(stderr, "File does not exist: %s\n", filename);
             errno = ENOENT;
         }
-        return NULL;
+        return false;
     }
     
     /* Check if is a regular file */
@@ -120,9 +253,58 @@ char* read_file_to_buffer(const char *filename)
     {
         fprintf(stderr,"Not a regular file\n");
         errno = EISDIR;
-        return NULL;
+        return false;
+    }
+    return true;
+}
+
+/*
+   * @brief               Checks a trace file, that is read request by request later, the way read_file_to_buffer does
+   *
+   * @param filename      The path to the file to check
+   *
+   * @return              true if the file is a readable, non-empty regular file, false with errno set otherwise
+*/
+bool check_trace_file(const char *filename)
+{
+    if (!check_regular_file(filename)) return false;
+
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error while opening file\n");
+        return false;
     }
 
+    bool empty = fgetc(file) == EOF;
+    if (empty && ferror(file)) {
+        fclose(file);
+        fprintf(stderr, "Error reading file %s\n", filename);
+        errno = EIO;
+        return false;
+    }
+    fclose(file);
+
+    if (empty) {
+        fprintf(stderr, "File is empty\n");
+        errno = ENODATA;
+        return false;
+    }
+    return true;
+}
+
+/*
+   * @brief              
+   *
+   * @param filename    The path to the file to read.  
+   * 
+   * @return            A pointer to a null-terminated buffer containing the file contents,
+   *                    or NULL if an error occurs (file not accessible, not a regular file,
+   *                    I/O error, or memory allocation failure).
+*/
+char* read_file_to_buffer(const char *filename)
+{
+    if (!check_regular_file(filename)) return NULL;
+
     /* Try to open a file for reading */
     FILE *csv_file = fopen(filename, "r");
     if (!csv_file) {
@@ -170,4 +352,94 @@ char* read_file_to_buffer(const char *filename)
     }
 
     return content;
-}
\ No newline at end of file
+}
+
+/*
+   * @brief               Fills simulation options with their default values
+   *
+   * @param options       Pointer to options to initialize
+   *
+   * @return              void
+*/
+void init_simulation_options(SimulationOptions* options)
+{
+    /* Trace the whole run with the default signal set */
+    options->trace.firstRequest = 0;
+    options->trace.lastRequest  = UINT32_MAX;
+    options->trace.firstCycle   = 0;
+    options->trace.lastCycle    = UINT32_MAX;
+    options->trace.signals      = NULL;
+
+    /* The format of the trace file is detected */
+    options->input.fileName     = NULL;
+    options->input.format       = TRACE_FORMAT_AUTO;
+    options->input.pipeline     = false;
+
+    /* No per-request log */
+    options->eventLog           = NULL;
+    options->progressFd         = -1;
+    options->missClasses        = false;
+    options->hotspots           = 0;
+
+    /* Main memory timing */
+    options->dram.channels      = DRAM_CHANNELS;
+    options->dram.ranks         = DRAM_RANKS;
+    options->dram.banks         = DRAM_BANKS;
+    options->dram.rowSize       = DRAM_ROW_SIZE;
+    options->dram.tRCD          = DRAM_T_RCD;
+    options->dram.tCAS          = DRAM_T_CAS;
+    options->dram.tRP           = DRAM_T_RP;
+    options->dram.pagePolicy    = DRAM_PAGE_POLICY;
+
+    /* Same bus on every link */
+    options->bus.numWidths      = 1;
+    options->bus.width[0]       = BUS_WIDTH;
+    options->bus.numFrequencies = 1;
+    options->bus.frequency[0]   = BUS_FREQUENCY;
+
+    /* Requests are read from the trace file */
+    options->workload.name      = NULL;
+    options->workload.requests  = 0;
+    options->workload.seed      = WORKLOAD_SEED;
+    options->workload.size      = 0;
+    options->workload.stride    = 0;
+    options->workload.block     = 0;
+
+    /* Single simulation */
+    options->batch.configs      = NULL;
+    options->batch.numConfigs   = 0;
+    options->batch.threads      = 0;
+
+    /* No profiling */
+    options->profile.enabled      = false;
+    options->profile.parseSeconds = 0.0;
+
+    /* Simulate instead of analyzing the trace */
+    options->analyze.enabled      = false;
+    options->analyze.window       = ANALYZE_WINDOW;
+
+    /* Simulate the given hierarchy instead of searching one */
+    options->tune.budget             = 0;
+    options->tune.latencyBase        = TUNE_LATENCY_BASE;
+    options->tune.latencyPerDoubling = TUNE_LATENCY_PER_DOUBLING;
+
+    /* Levels are taken from the command line */
+    options->hierarchy.numLevels     = 0;
+
+    /* Unified L1 */
+    options->l1i.numLines            = 0;
+    options->l1i.latency             = LATENCY_CACHE_L1;
+}
+
+/*
+    * @brief            Reads a clock that is not affected by changes of the system time, for measuring durations
+    *
+    * @return           Seconds since an arbitrary fixed point
+    *
+*/
+double monotonic_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
@@ -5,9 +5,12 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <inttypes.h>
+#include <time.h>
 #include "../include/structs/request.h"
 #include "../include/structs/default.h"
 #include "../include/structs/debug.h"
+#include "../include/structs/options.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +21,10 @@ void print_help();
 bool is_power_of_two(uint32_t number);
 void print_requests(Request* requests, size_t size);
 char* read_file_to_buffer(const char *filename);
+bool check_trace_file(const char *filename);
+bool validate_memory_options(const DramOptions* dram, const BusOptions* bus);
+void init_simulation_options(SimulationOptions* options);
+double monotonic_seconds(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,306 @@
+#include "../include/structs/debug.h"
+#include <pthread.h>
+#include <sys/types.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Events a ring of a single thread holds before the oldest are overwritten */
+#define LOG_RING_RECORDS (1u << 15)
+
+#define LOG_FILE_VERSION 1
+
+typedef struct {
+    uint64_t sequence;              /* Global order of the event across all threads */
+    const char* format;
+    uint64_t args[LOG_MAX_ARGS];
+    uint8_t level;
+    uint8_t numArgs;
+} LogRecord;
+
+typedef struct LogRing {
+    LogRecord* records;
+    uint64_t written;               /* Events ever recorded, the ring holds the last LOG_RING_RECORDS of them */
+    uint32_t thread;
+    struct LogRing* next;
+} LogRing;
+
+bool logEnabled = false;
+
+static FILE* logFile = NULL;
+static atomic_uint_fast64_t nextSequence;
+
+/* Rings of all threads that ever recorded an event. They outlive their threads, so that they can be dumped at exit */
+static pthread_mutex_t ringsMutex = PTHREAD_MUTEX_INITIALIZER;
+static LogRing* rings = NULL;
+static uint32_t numRings = 0;
+
+static _Thread_local LogRing* threadRing = NULL;
+
+/*
+   * @brief               Allocates the ring of the calling thread and registers it for the dump
+   *
+   * @return              The ring, or NULL if the allocation failed
+*/
+static LogRing* create_ring(void)
+{
+    LogRing* ring = (LogRing*) calloc(1, sizeof(LogRing));
+    if (!ring) return NULL;
+
+    ring->records = (LogRecord*) malloc(LOG_RING_RECORDS * sizeof(LogRecord));
+    if (!ring->records) {
+        free(ring);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ringsMutex);
+    ring->thread = numRings++;
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&ringsMutex);
+
+    return ring;
+}
+
+/*
+   * @brief               Stores an event in the ring of the calling thread. Nothing is formatted
+   *
+   * @param level         Level of the event
+   * @param format        printf format string of the event, must stay valid until the program exits
+   * @param numArgs       Number of arguments, at most LOG_MAX_ARGS
+   * @param args          Arguments widened to 64 bits: integers extended, doubles bit-cast, pointers as addresses
+   *
+   * @return              void
+*/
+void log_record(uint8_t level, const char* format, uint8_t numArgs, const uint64_t* args)
+{
+    if (!logEnabled) return;
+
+    LogRing* ring = threadRing;
+    if (!ring) {
+        ring = threadRing = create_ring();
+        if (!ring) return;
+    }
+
+    LogRecord* record = &ring->records[ring->written++ & (LOG_RING_RECORDS - 1)];
+    record->sequence = atomic_fetch_add_explicit(&nextSequence, 1, memory_order_relaxed);
+    record->format = format;
+    record->level = level;
+    record->numArgs = numArgs > LOG_MAX_ARGS ? LOG_MAX_ARGS : numArgs;
+    memcpy(record->args, args, record->numArgs * sizeof(uint64_t));
+}
+
+/*
+   * @brief               Finds the next conversion of a printf format string
+   *
+   * @param format        Position in the format string
+   * @param length        Set to the length modifier of the conversion: 0, 'h', 'H' (hh), 'l', 'L' (ll), 'z' or 'j'
+   * @param stars         Set to the number of '*' widths and precisions, which take an int argument each
+   *
+   * @return              Pointer to the conversion character, or NULL if there is no further conversion
+*/
+static const char* next_conversion(const char* format, char* length, int* stars)
+{
+    for (const char* c = format; *c; c++) {
+        if (*c != '%') continue;
+        if (*(c + 1) == '%') {
+            c++;
+            continue;
+        }
+
+        *stars = 0;
+        *length = 0;
+        c++;
+        while (*c && strchr("-+ #0", *c)) c++;
+        while (*c && (strchr("0123456789.", *c) || *c == '*')) {
+            if (*c == '*') (*stars)++;
+            c++;
+        }
+        if (*c == 'h' || *c == 'l') {
+            *length = *c;
+            if (*(c + 1) == *c) {
+                *length = (*c == 'h') ? 'H' : 'L';
+                c++;
+            }
+            c++;
+        } else if (*c == 'z' || *c == 'j' || *c == 't') {
+            *length = (*c == 't') ? 'z' : *c;
+            c++;
+        }
+        return *c ? c : NULL;
+    }
+    return NULL;
+}
+
+/*
+   * @brief               Records an event of C code, where the argument types are only known from the format string
+   *
+   * @param level         Level of the event
+   * @param format        printf format string of the event
+   *
+   * @return              void
+*/
+void log_printf(uint8_t level, const char* format, ...)
+{
+    uint64_t args[LOG_MAX_ARGS];
+    uint8_t numArgs = 0;
+    char length;
+    int stars;
+
+    va_list list;
+    va_start(list, format);
+    for (const char* c = next_conversion(format, &length, &stars); c && numArgs < LOG_MAX_ARGS; c = next_conversion(c + 1, &length, &stars)) {
+        while (stars-- > 0 && numArgs < LOG_MAX_ARGS)
+            args[numArgs++] = (uint64_t)(int64_t) va_arg(list, int);
+        if (numArgs == LOG_MAX_ARGS) break;
+
+        switch (*c) {
+            case 'd': case 'i':
+                if (length == 'l') args[numArgs++] = (uint64_t)(int64_t) va_arg(list, long);
+                else if (length == 'L' || length == 'j') args[numArgs++] = (uint64_t)(int64_t) va_arg(list, long long);
+                else if (length == 'z') args[numArgs++] = (uint64_t)(int64_t) va_arg(list, ssize_t);
+                else args[numArgs++] = (uint64_t)(int64_t) va_arg(list, int);
+                break;
+            case 'u': case 'x': case 'X': case 'o': case 'c':
+                if (length == 'l') args[numArgs++] = va_arg(list, unsigned long);
+                else if (length == 'L' || length == 'j') args[numArgs++] = va_arg(list, unsigned long long);
+                else if (length == 'z') args[numArgs++] = va_arg(list, size_t);
+                else args[numArgs++] = va_arg(list, unsigned int);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                double value = va_arg(list, double);
+                memcpy(&args[numArgs++], &value, sizeof(uint64_t));
+                break;
+            }
+            case 's': case 'p':
+                args[numArgs++] = (uint64_t)(uintptr_t) va_arg(list, const void*);
+                break;
+            default:
+                break;
+        }
+    }
+    va_end(list);
+
+    log_record(level, format, numArgs, args);
+}
+
+/*
+   * @brief               Writes a string block, unless the string was written before
+   *
+   * @param file          Log file
+   * @param string        Format string or %s argument
+   * @param written       Open addressing set of strings already written
+   * @param capacity      Capacity of written, a power of 2
+   *
+   * @return              void
+*/
+static void write_string(FILE* file, const char* string, const char** written, size_t capacity)
+{
+    if (!string) return;
+
+    size_t slot = ((uintptr_t) string >> 3) & (capacity - 1);
+    while (written[slot]) {
+        if (written[slot] == string) return;
+        slot = (slot + 1) & (capacity - 1);
+    }
+    written[slot] = string;
+
+    const uint64_t id = (uintptr_t) string;
+    const uint32_t length = (uint32_t) strlen(string);
+    fputc('S', file);
+    fwrite(&id, sizeof(id), 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(string, 1, length, file);
+}
+
+/*
+   * @brief               Writes all rings to the log file. Registered with atexit by log_open
+   *
+   * The file starts with the magic "CSTL" and the format version. It is followed by 'S' blocks, which map the
+   * address of a format string or a %s argument to its content, and an 'R' block per ring with the events
+   * oldest first. All numbers are in host byte order.
+   *
+   * @return              void
+*/
+static void log_dump(void)
+{
+    logEnabled = false;
+    if (!logFile) return;
+
+    uint64_t totalRecords = 0;
+    for (LogRing* ring = rings; ring; ring = ring->next)
+        totalRecords += ring->written < LOG_RING_RECORDS ? ring->written : LOG_RING_RECORDS;
+
+    /* Every event adds at most one format string and LOG_MAX_ARGS %s arguments */
+    size_t capacity = 64;
+    while (capacity < 2 * totalRecords * (LOG_MAX_ARGS + 1)) capacity <<= 1;
+    const char** written = (const char**) calloc(capacity, sizeof(const char*));
+
+    const uint32_t version = LOG_FILE_VERSION;
+    fwrite("CSTL", 1, 4, logFile);
+    fwrite(&version, sizeof(version), 1, logFile);
+
+    char length;
+    int stars;
+    for (LogRing* ring = rings; ring && written; ring = ring->next) {
+        const uint64_t count = ring->written < LOG_RING_RECORDS ? ring->written : LOG_RING_RECORDS;
+        for (uint64_t i = ring->written - count; i < ring->written; i++) {
+            const LogRecord* record = &ring->records[i & (LOG_RING_RECORDS - 1)];
+            write_string(logFile, record->format, written, capacity);
+
+            uint8_t arg = 0;
+            for (const char* c = next_conversion(record->format, &length, &stars); c && arg < record->numArgs; c = next_conversion(c + 1, &length, &stars)) {
+                arg += stars;
+                if (*c == 's' && arg < record->numArgs)
+                    write_string(logFile, (const char*)(uintptr_t) record->args[arg], written, capacity);
+                arg++;
+            }
+        }
+    }
+    free(written);
+
+    for (LogRing* ring = rings; ring; ring = ring->next) {
+        const uint64_t dropped = ring->written > LOG_RING_RECORDS ? ring->written - LOG_RING_RECORDS : 0;
+        const uint32_t count = (uint32_t)(ring->written - dropped);
+
+        fputc('R', logFile);
+        fwrite(&ring->thread, sizeof(ring->thread), 1, logFile);
+        fwrite(&dropped, sizeof(dropped), 1, logFile);
+        fwrite(&count, sizeof(count), 1, logFile);
+
+        for (uint64_t i = dropped; i < ring->written; i++) {
+            const LogRecord* record = &ring->records[i & (LOG_RING_RECORDS - 1)];
+            const uint64_t format = (uintptr_t) record->format;
+            fwrite(&record->sequence, sizeof(record->sequence), 1, logFile);
+            fwrite(&format, sizeof(format), 1, logFile);
+            fputc(record->level, logFile);
+            fputc(record->numArgs, logFile);
+            fwrite(record->args, sizeof(uint64_t), record->numArgs, logFile);
+        }
+    }
+
+    fclose(logFile);
+    logFile = NULL;
+}
+
+/*
+   * @brief               Opens the log file and starts recording events. The rings are written to it at exit
+   *
+   * @param filename      Name of the log file
+   *
+   * @return              true if the file could be opened, false otherwise
+*/
+bool log_open(const char* filename)
+{
+    if (logFile) return true;
+
+    if (!(logFile = fopen(filename, "wb"))) {
+        fprintf(stderr, "Invalid log file name: %s\n", filename);
+        return false;
+    }
+
+    atexit(log_dump);
+    logEnabled = true;
+    return true;
+}